@@ -0,0 +1,11 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+
+// Number of heap allocations made through operator new so far in this
+// process. Benchmarks read it before and after a piece of work to check
+// that the work allocates nothing.
+size_t allocationCount();
+
+#endif
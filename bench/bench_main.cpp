@@ -0,0 +1,141 @@
+// Benchmarks for bible_cli, kept in their own program so the allocation
+// counter and the scripted viewer runs never ship in the viewer itself
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "benchmarks.h"
+#include "../include/command_options.h"
+
+void printUsage()
+{
+    std::cout << "Bible Viewer benchmarks" << std::endl;
+    std::cout << "Usage:" << std::endl;
+    std::cout << "  bible_bench viewer <database.db> [runs]" << std::endl;
+    std::cout << "  bible_bench store <database.db> [runs]" << std::endl;
+    std::cout << "  bible_bench parse <database.db> <bible.csv> [--runs <n>] [--baseline <file> [--record]]" << std::endl;
+}
+
+// Optional run count after the database, 1 to 10000
+static bool parseRuns(int argc, char *argv[], int &runs)
+{
+    CommandOptions parser;
+    parser.acceptPositional();
+    if (!parser.parse(argc, argv, 3))
+        return false;
+
+    const std::vector<std::string> &extra = parser.arguments();
+    size_t count = 5;
+    if (extra.size() > 1 || (extra.size() == 1 && (!parseCount(extra[0], count) || count < 1 || count > 10000)))
+    {
+        std::cout << "Error: Unexpected argument: " << extra.back() << std::endl;
+        return false;
+    }
+
+    runs = static_cast<int>(count);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::string command = argv[1];
+    std::string dbPath = argv[2];
+    int runs = 5;
+
+    if (command == "viewer")
+    {
+        if (!parseRuns(argc, argv, runs))
+        {
+            printUsage();
+            return 1;
+        }
+
+        if (!benchViewerCommand(dbPath, runs))
+        {
+            return 1;
+        }
+    }
+    else if (command == "store")
+    {
+        if (!parseRuns(argc, argv, runs))
+        {
+            printUsage();
+            return 1;
+        }
+
+        if (!benchStoreCommand(dbPath, runs))
+        {
+            return 1;
+        }
+    }
+    else if (command == "parse")
+    {
+        if (argc < 4)
+        {
+            printUsage();
+            return 1;
+        }
+
+        size_t parseRuns = 5;
+        std::string baselinePath;
+        bool record = false;
+
+        CommandOptions parser;
+        parser.value("--runs", [&](const std::string &value)
+                     { return parseCount(value, parseRuns) && parseRuns > 0 && parseRuns <= 10000; });
+        parser.value("--baseline", [&](const std::string &value)
+                     { baselinePath = value; return true; });
+        parser.flag("--record", [&]
+                    { record = true; });
+        if (!parser.parse(argc, argv, 4))
+        {
+            printUsage();
+            return 1;
+        }
+
+        if (!benchParseCommand(dbPath, argv[3], static_cast<int>(parseRuns), baselinePath, record))
+        {
+            return 1;
+        }
+    }
+    // Run by the viewer bench in a fresh process, not meant to be typed
+    else if (command == "probe-startup")
+    {
+        bool restore = true;
+        size_t launched = 0;
+        CommandOptions parser;
+        parser.flag("--no-restore", [&]
+                    { restore = false; });
+        parser.value("--launched", [&](const std::string &value)
+                     { return parseCount(value, launched); });
+        if (!parser.parse(argc, argv, 3) || !startupProbe(dbPath, restore, static_cast<long long>(launched)))
+        {
+            return 1;
+        }
+    }
+    else if (command == "probe-navigation")
+    {
+        // The launch time is only used by the startup probe
+        CommandOptions parser;
+        parser.value("--launched", [](const std::string &)
+                     { return true; });
+        if (!parser.parse(argc, argv, 3) || !navigationProbe(dbPath))
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << "Unknown command: " << command << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <string>
+
+// Measure viewer startup and steady-state navigation against a database.
+// Each measurement runs the viewer in a fresh process of this program.
+bool benchViewerCommand(const std::string &dbPath, int runs);
+
+// The viewer runs themselves, in the child process: report the time from
+// launchedNs (a steady clock reading taken before the exec) to the first
+// painted frame, or replay a fixed walk of verse and chapter steps and count
+// the heap allocations made once it is cached
+bool startupProbe(const std::string &dbPath, bool restore, long long launchedNs);
+bool navigationProbe(const std::string &dbPath);
+
+// Run the same queries against every corpus store backend, check that each
+// answers exactly as SQLite does and compare their speed
+bool benchStoreCommand(const std::string &dbPath, int runs);
+
+// Check that exported CSV reads back verbatim and that every reference in
+// the database parses back to its verse, then measure how fast the CSV
+// reader and reference parser run; tests/csv_reader_test.cpp covers
+// generated and damaged CSV input. With a baseline file, fails when either falls below 80% of the recorded speed;
+// record writes the current speeds as the new baseline.
+bool benchParseCommand(const std::string &dbPath, const std::string &csvPath, int runs, const std::string &baselinePath, bool record);
+
+#endif
@@ -0,0 +1,65 @@
+#include "navigation_walk.h"
+#include "alloc_counter.h"
+#include "../include/verse_index.h"
+#include <sqlite3.h>
+#include <iostream>
+#include <ncurses.h>
+
+NavigationWalk::NavigationWalk()
+{
+    std::vector<int> pass;
+    pass.insert(pass.end(), 60, KEY_DOWN);
+    pass.insert(pass.end(), 4, KEY_UP);
+    pass.insert(pass.end(), 4, KEY_DOWN);
+    pass.insert(pass.end(), 60, KEY_UP);
+    pass.insert(pass.end(), 4, KEY_RIGHT);
+    pass.insert(pass.end(), 4, KEY_LEFT);
+
+    passLength = pass.size();
+    keys = pass;
+    keys.insert(keys.end(), pass.begin(), pass.end());
+}
+
+bool NavigationWalk::prepare(const std::string &dbPath, ViewerOptions &options)
+{
+    sqlite3 *db;
+    if (sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    VerseIndex index;
+    bool loaded = index.load(db) && index.totalVerses() > 0;
+    sqlite3_close(db);
+    if (!loaded)
+        return false;
+
+    next = 0;
+    options.restoreSession = false;
+    options.startReference = index.reference(index.position(0));
+    options.keySource = [this]()
+    {
+        return nextKey();
+    };
+    return true;
+}
+
+int NavigationWalk::nextKey()
+{
+    if (next == passLength)
+    {
+        startAllocations = allocationCount();
+        clock = std::chrono::steady_clock::now();
+    }
+
+    if (next == keys.size())
+    {
+        allocations = allocationCount() - startAllocations;
+        milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - clock).count();
+        return 'q';
+    }
+
+    return keys[next++];
+}
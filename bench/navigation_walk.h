@@ -0,0 +1,39 @@
+#ifndef NAVIGATION_WALK_H
+#define NAVIGATION_WALK_H
+
+#include "../include/viewer.h"
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// The scripted keys of the navigation probe, used as a viewer key source.
+// The walk opens at the first verse of the first book, and one pass of verse
+// and chapter steps ends where it began, so on any database both passes
+// visit the same chapters. The first pass warms the caches; the heap
+// allocations and time of the second are counted, then the viewer is quit.
+class NavigationWalk
+{
+private:
+    std::vector<int> keys;
+    size_t passLength = 0;
+    size_t next = 0;
+    size_t startAllocations = 0;
+    size_t allocations = 0;
+    std::chrono::steady_clock::time_point clock;
+    double milliseconds = 0.0;
+
+public:
+    NavigationWalk();
+
+    // Viewer options that replay the walk on a database; false if it has no verses
+    bool prepare(const std::string &dbPath, ViewerOptions &options);
+
+    int nextKey();
+
+    size_t passKeys() const { return passLength; }
+    size_t countedAllocations() const { return allocations; }
+    double countedMs() const { return milliseconds; }
+};
+
+#endif
@@ -0,0 +1,224 @@
+#include "benchmarks.h"
+#include "../include/csv_reader.h"
+#include "../include/text_export.h"
+#include "../include/verse_index.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <random>
+#include <vector>
+
+// Read every record of an in-memory CSV with a reader of the given buffer
+// size, as tests/csv_reader_test.cpp does for its correctness checks
+static bool readCsvFully(const std::string &input, size_t bufferBytes, std::vector<std::vector<std::string>> *records)
+{
+    FILE *stream = fmemopen(const_cast<char *>(input.data()), input.size(), "rb");
+    if (!stream)
+        return input.empty();
+
+    CsvReader csv(bufferBytes);
+    csv.attach(stream);
+
+    bool sane = true;
+    while (csv.next())
+    {
+        std::vector<std::string> record;
+        for (size_t i = 0; i < csv.fieldCount(); i++)
+        {
+            sane = sane && csv.field(i).size() <= input.size();
+            if (records)
+                record.push_back(csv.field(i));
+        }
+        if (records)
+            records->push_back(std::move(record));
+    }
+
+    sane = sane && csv.bytesRead() == input.size();
+    csv.close();
+    fclose(stream);
+    return sane;
+}
+
+bool benchParseCommand(const std::string &dbPath, const std::string &csvPath, int runs, const std::string &baselinePath, bool record)
+{
+    sqlite3 *db;
+    if (sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    VerseIndex index;
+    if (!index.load(db) || index.totalVerses() == 0)
+    {
+        std::cerr << "No verses found in the database." << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    std::ifstream source(csvPath, std::ios::binary);
+    std::string input((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+    if (!source.good() && !source.eof())
+    {
+        std::cerr << "Error reading CSV file: " << csvPath << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    // Fixed seed so a failure can be reproduced
+    std::mt19937 random(20240611);
+    bool passed = true;
+    auto check = [&passed](const char *name, size_t cases, size_t failures)
+    {
+        std::cout << name << ": " << cases << " cases, " << failures << " failures" << std::endl;
+        passed = passed && failures == 0;
+    };
+
+    // What the exporter writes, the reader must read back verbatim
+    {
+        size_t failures = 0, cases = 0;
+        FILE *exported = tmpfile();
+        OutputBuffer out(exported ? fileno(exported) : -1);
+        if (!exported || exportVerses(db, 1, std::numeric_limits<int>::max(), ExportFormat::Csv, out) < 0 || !out.flush())
+            failures++;
+
+        sqlite3_stmt *stmt = nullptr;
+        if (exported && failures == 0 &&
+            sqlite3_prepare_v2(db, "SELECT book, chapter, verse, text FROM bible ORDER BY id", -1, &stmt, nullptr) == SQLITE_OK)
+        {
+            rewind(exported);
+            CsvReader csv;
+            csv.attach(exported);
+            csv.next(); // Header
+
+            while (sqlite3_step(stmt) == SQLITE_ROW)
+            {
+                int chapter = 0, verse = 0;
+                cases++;
+                if (!csv.next() || csv.fieldCount() != 4 || !csv.integer(1, chapter) || !csv.integer(2, verse) ||
+                    csv.field(0) != reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0)) ||
+                    chapter != sqlite3_column_int(stmt, 1) || verse != sqlite3_column_int(stmt, 2) ||
+                    csv.field(3) != reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)))
+                    failures++;
+            }
+            if (csv.next())
+                failures++;
+        }
+        sqlite3_finalize(stmt);
+        if (exported)
+            fclose(exported);
+        check("csv export round trip", cases, failures);
+    }
+
+    // Every verse's reference must parse back to the same verse, and random
+    // text must either fail or land on a real verse
+    std::vector<std::string> references;
+    {
+        size_t failures = 0;
+        for (int verse = 0; verse < index.totalVerses(); verse++)
+        {
+            VersePosition position = index.position(verse);
+            references.push_back(index.reference(position));
+
+            VersePosition parsed;
+            if (!index.parseReference(references.back(), parsed) || index.absolute(parsed) != verse)
+                failures++;
+        }
+        check("reference round trip", references.size(), failures);
+
+        const char alphabet[] = "0123456789 ::--,.abcdefghijklmnopqrstuvwxyzGJRP\xC3\xA9\t";
+        size_t cases = 50000;
+        failures = 0;
+        for (size_t c = 0; c < cases; c++)
+        {
+            std::string text;
+            if (random() % 2)
+                text = references[random() % references.size()].substr(0, random() % 24);
+            for (size_t length = random() % 12; length > 0; length--)
+                text.insert(text.empty() ? 0 : random() % text.size(), 1, alphabet[random() % (sizeof(alphabet) - 1)]);
+
+            VersePosition first, last;
+            if (index.parseReference(text, first) && index.absolute(first) < 0)
+                failures++;
+            if (index.parseRange(text, first, last) && (index.absolute(first) < 0 || index.absolute(last) < index.absolute(first)))
+                failures++;
+        }
+        check("reference random input", cases, failures);
+    }
+
+    sqlite3_close(db);
+
+    // Speeds: the median of the runs, parsing from memory so the disk is not measured
+    typedef std::chrono::steady_clock Clock;
+    std::vector<double> csvRates, referenceRates;
+    for (int run = 0; run < runs; run++)
+    {
+        Clock::time_point start = Clock::now();
+        readCsvFully(input, 1 << 20, nullptr);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        csvRates.push_back(input.size() / std::max(seconds, 1e-9) / 1048576.0);
+
+        start = Clock::now();
+        VersePosition parsed;
+        for (const auto &reference : references)
+            index.parseReference(reference, parsed);
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        referenceRates.push_back(references.size() / std::max(seconds, 1e-9));
+    }
+    std::sort(csvRates.begin(), csvRates.end());
+    std::sort(referenceRates.begin(), referenceRates.end());
+    double csvRate = csvRates[csvRates.size() / 2];
+    double referenceRate = referenceRates[referenceRates.size() / 2];
+
+    std::cout << std::fixed << std::setprecision(1) << "csv: " << csvRate << " MiB/s over " << input.size() / 1048576.0
+              << " MiB; references: " << std::setprecision(0) << referenceRate << " per second (median of " << runs << " runs)" << std::endl;
+
+    if (baselinePath.empty())
+        return passed;
+
+    if (record)
+    {
+        std::ofstream baseline(baselinePath);
+        baseline << "csv-mib-per-s " << csvRate << "\nreferences-per-s " << referenceRate << "\n";
+        if (!baseline)
+        {
+            std::cerr << "Error writing baseline: " << baselinePath << std::endl;
+            return false;
+        }
+        std::cout << "Recorded baseline in " << baselinePath << "." << std::endl;
+        return passed;
+    }
+
+    std::ifstream baseline(baselinePath);
+    std::string key;
+    double value;
+    std::map<std::string, double> recorded;
+    while (baseline >> key >> value)
+        recorded[key] = value;
+
+    if (!recorded.count("csv-mib-per-s") || !recorded.count("references-per-s"))
+    {
+        std::cerr << "Baseline missing or unreadable: " << baselinePath << " (create it with --record)" << std::endl;
+        return false;
+    }
+
+    // Allow for noise; anything slower than this is a regression
+    const double tolerance = 0.8;
+    for (auto measured : {std::make_pair("csv-mib-per-s", csvRate), std::make_pair("references-per-s", referenceRate)})
+    {
+        bool fast = measured.second >= recorded[measured.first] * tolerance;
+        std::cout << measured.first << ": " << measured.second << " against baseline " << recorded[measured.first]
+                  << (fast ? " - ok" : " - REGRESSION") << std::endl;
+        passed = passed && fast;
+    }
+
+    return passed;
+}
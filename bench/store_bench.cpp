@@ -0,0 +1,179 @@
+#include "benchmarks.h"
+#include "../include/corpus_store.h"
+#include "../include/memory_budget.h"
+#include "../include/schema.h"
+#include "../include/text_fold.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Answers of one backend to the store bench query set
+struct StoreAnswers
+{
+    std::vector<std::string> books;
+    std::vector<int> chapterCounts;
+    std::vector<std::vector<Verse>> chapters;
+    std::vector<Verse> verses; // id 0 when the lookup found nothing
+    std::vector<std::vector<int>> searches;
+};
+
+static bool sameVerse(const Verse &a, const Verse &b)
+{
+    return a.id == b.id && a.book == b.book && a.chapter == b.chapter && a.verse == b.verse &&
+           a.text == b.text && a.folded == b.folded && encodeFoldMap(a.foldMap) == encodeFoldMap(b.foldMap);
+}
+
+// Report the first difference between a backend's answers and the reference
+static bool sameAnswers(const StoreAnswers &expected, const StoreAnswers &actual, std::string &difference)
+{
+    if (actual.books != expected.books)
+        difference = "book list";
+    else if (actual.chapterCounts != expected.chapterCounts)
+        difference = "chapter counts";
+
+    for (size_t i = 0; difference.empty() && i < expected.chapters.size(); i++)
+    {
+        const auto &a = expected.chapters[i];
+        const auto &b = actual.chapters[i];
+        if (a.size() != b.size() || !std::equal(a.begin(), a.end(), b.begin(), sameVerse))
+            difference = "chapter " + std::to_string(i + 1) + " of the walk";
+    }
+
+    for (size_t i = 0; difference.empty() && i < expected.verses.size(); i++)
+    {
+        if (!sameVerse(expected.verses[i], actual.verses[i]))
+            difference = "verse id " + std::to_string(expected.verses[i].id ? expected.verses[i].id : actual.verses[i].id);
+    }
+
+    for (size_t i = 0; difference.empty() && i < expected.searches.size(); i++)
+    {
+        if (expected.searches[i] != actual.searches[i])
+            difference = "search " + std::to_string(i + 1);
+    }
+
+    return difference.empty();
+}
+
+bool benchStoreCommand(const std::string &dbPath, int runs)
+{
+    sqlite3 *db;
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK)
+    {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    if (!ensureSchema(db))
+    {
+        sqlite3_close(db);
+        return false;
+    }
+
+    FoldOptions foldOptions = loadFoldOptions(db);
+    int maxId = 0;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT MAX(id) FROM bible", -1, &stmt, nullptr) == SQLITE_OK)
+    {
+        if (sqlite3_step(stmt) == SQLITE_ROW)
+            maxId = sqlite3_column_int(stmt, 0);
+        sqlite3_finalize(stmt);
+    }
+
+    // Ids on either side of the table's range must miss on every backend
+    std::vector<int> ids = {0, -1, maxId + 1};
+    for (int id = 1; id <= maxId; id += 37)
+        ids.push_back(id);
+
+    std::vector<std::string> terms;
+    for (const char *term : {"the", "lord", "love", "light", "In the beginning", "qqq", "e", "Jesus wept", "ÉGLISE"})
+        terms.push_back(foldText(term, foldOptions));
+
+    typedef std::chrono::steady_clock Clock;
+    auto milliseconds = [](Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    const StoreBackend backends[] = {StoreBackend::Sqlite, StoreBackend::Arena, StoreBackend::Mapped};
+    StoreAnswers reference;
+    bool identical = true;
+
+    std::cout << std::left << std::setw(8) << "store" << std::right << std::setw(12) << "open ms" << std::setw(12) << "chapters ms"
+              << std::setw(12) << "verses ms" << std::setw(12) << "search ms" << std::setw(12) << "memory" << "  result" << std::endl;
+
+    for (StoreBackend backend : backends)
+    {
+        // Median of each phase over the runs; the mmap file is rebuilt only on the first
+        std::vector<double> phases[4];
+        StoreAnswers answers;
+        std::unique_ptr<CorpusStore> store;
+
+        for (int run = 0; run < runs; run++)
+        {
+            answers = StoreAnswers();
+            store.reset();
+
+            Clock::time_point start = Clock::now();
+            store = openCorpusStore(backend, db, dbPath);
+            if (!store)
+            {
+                sqlite3_close(db);
+                return false;
+            }
+            phases[0].push_back(milliseconds(start));
+
+            start = Clock::now();
+            answers.books = store->books();
+            for (const auto &book : answers.books)
+            {
+                int chapters = store->chapterCount(book);
+                answers.chapterCounts.push_back(chapters);
+                for (int chapter = 1; chapter <= chapters; chapter++)
+                    answers.chapters.push_back(store->chapter(book, chapter));
+            }
+            phases[1].push_back(milliseconds(start));
+
+            start = Clock::now();
+            for (int id : ids)
+            {
+                Verse verse = Verse();
+                store->verse(id, verse);
+                answers.verses.push_back(std::move(verse));
+            }
+            phases[2].push_back(milliseconds(start));
+
+            start = Clock::now();
+            for (const auto &term : terms)
+                answers.searches.push_back(store->search(term));
+            phases[3].push_back(milliseconds(start));
+        }
+
+        std::string difference;
+        bool same = backend == StoreBackend::Sqlite || sameAnswers(reference, answers, difference);
+        identical = identical && same;
+
+        std::cout << std::left << std::setw(8) << store->backendName() << std::right << std::fixed << std::setprecision(2);
+        for (auto &times : phases)
+        {
+            std::sort(times.begin(), times.end());
+            std::cout << std::setw(12) << times[times.size() / 2];
+        }
+        std::cout << std::setw(12) << formatBytes(store->memoryBytes())
+                  << "  " << (same ? "ok" : "MISMATCH in " + difference) << std::endl;
+
+        if (backend == StoreBackend::Sqlite)
+            reference = std::move(answers);
+    }
+
+    sqlite3_close(db);
+
+    std::cout << reference.chapters.size() << " chapters, " << ids.size() << " verse lookups and "
+              << terms.size() << " searches per run over " << runs << " runs; "
+              << (identical ? "all stores agree." : "stores disagree.") << std::endl;
+    return identical;
+}
@@ -0,0 +1,182 @@
+#include "benchmarks.h"
+#include "navigation_walk.h"
+#include "../include/viewer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// Launch this program as a viewer probe and read back the report it writes
+// to stderr on exit. Output goes to /dev/null at a fixed terminal size.
+static bool runViewerProbe(const std::string &probe, const std::string &dbPath, const std::vector<std::string> &options, std::string &report)
+{
+    int output[2];
+    if (pipe(output) != 0)
+        return false;
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, output[1], 2);
+    posix_spawn_file_actions_addclose(&actions, output[0]);
+    posix_spawn_file_actions_addclose(&actions, output[1]);
+
+    // The child measures from this clock reading, so the exec is counted too
+    long long launched = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::vector<std::string> args = {"bible_bench", probe, dbPath, "--launched", std::to_string(launched)};
+    args.insert(args.end(), options.begin(), options.end());
+    std::vector<std::string> env = {"TERM=xterm", "LINES=40", "COLUMNS=120"};
+
+    std::vector<char *> argvPointers;
+    for (auto &arg : args)
+        argvPointers.push_back(&arg[0]);
+    argvPointers.push_back(nullptr);
+
+    std::vector<char *> envPointers;
+    for (auto &var : env)
+        envPointers.push_back(&var[0]);
+    envPointers.push_back(nullptr);
+
+    pid_t child;
+    int rc = posix_spawn(&child, "/proc/self/exe", &actions, nullptr, argvPointers.data(), envPointers.data());
+    posix_spawn_file_actions_destroy(&actions);
+    close(output[1]);
+
+    if (rc != 0)
+    {
+        close(output[0]);
+        std::cerr << "Error launching viewer probe: " << strerror(rc) << std::endl;
+        return false;
+    }
+
+    char buffer[256];
+    ssize_t length;
+    while ((length = read(output[0], buffer, sizeof(buffer))) > 0)
+        report.append(buffer, length);
+    close(output[0]);
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    return true;
+}
+
+// Launch a startup probe and report the time from exec to its first painted frame
+static bool measureStartup(const std::string &dbPath, bool warm, double &milliseconds)
+{
+    std::vector<std::string> options;
+    if (!warm)
+        options.push_back("--no-restore");
+
+    std::string report;
+    if (!runViewerProbe("probe-startup", dbPath, options, report))
+        return false;
+
+    size_t found = report.find("first-paint-ms ");
+    if (found == std::string::npos)
+    {
+        std::cerr << "Startup probe failed: " << report << std::endl;
+        return false;
+    }
+
+    milliseconds = std::strtod(report.c_str() + found + 15, nullptr);
+    return milliseconds >= 0.0;
+}
+
+// Launch a navigation probe and report the heap allocations and time taken
+// by verse and chapter steps once the chapters involved are cached
+static bool measureNavigation(const std::string &dbPath, size_t &allocations, size_t &keys, double &milliseconds)
+{
+    std::string report;
+    if (!runViewerProbe("probe-navigation", dbPath, {}, report))
+        return false;
+
+    unsigned long long counted = 0, pressed = 0;
+    size_t found = report.find("navigation-allocations ");
+    if (found == std::string::npos ||
+        sscanf(report.c_str() + found, "navigation-allocations %llu %llu %lf", &counted, &pressed, &milliseconds) != 3)
+    {
+        std::cerr << "Navigation probe failed: " << report << std::endl;
+        return false;
+    }
+
+    allocations = counted;
+    keys = pressed;
+    return true;
+}
+
+bool benchViewerCommand(const std::string &dbPath, int runs)
+{
+    // The first launch also writes the session state warm starts rely on
+    double ignored;
+    if (!measureStartup(dbPath, false, ignored))
+        return false;
+
+    for (bool warm : {false, true})
+    {
+        std::vector<double> times;
+        for (int i = 0; i < runs; i++)
+        {
+            double milliseconds;
+            if (!measureStartup(dbPath, warm, milliseconds))
+                return false;
+            times.push_back(milliseconds);
+        }
+
+        std::sort(times.begin(), times.end());
+        std::cout << "startup (" << (warm ? "warm" : "cold") << ", exec to first paint): median "
+                  << std::fixed << std::setprecision(2) << times[times.size() / 2] << " ms, best "
+                  << times.front() << " ms over " << runs << " runs" << std::endl;
+    }
+
+    size_t allocations, keys;
+    double milliseconds;
+    if (!measureNavigation(dbPath, allocations, keys, milliseconds))
+        return false;
+
+    std::cout << "navigation (steady state): " << allocations << " heap allocations, "
+              << milliseconds * 1000.0 / std::max<size_t>(1, keys) << " us per key over " << keys << " keys" << std::endl;
+    return true;
+}
+
+bool startupProbe(const std::string &dbPath, bool restore, long long launchedNs)
+{
+    std::chrono::steady_clock::time_point launched{std::chrono::nanoseconds(launchedNs)};
+    double milliseconds = -1.0;
+
+    // Time the first frame, then quit at the first key the viewer asks for
+    ViewerOptions options;
+    options.restoreSession = restore;
+    options.firstPaint = [&]()
+    {
+        milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launched).count();
+    };
+    options.keySource = []()
+    {
+        return static_cast<int>('q');
+    };
+
+    if (!runViewer(dbPath, options))
+        return false;
+
+    std::cerr << "first-paint-ms " << milliseconds << std::endl;
+    return true;
+}
+
+bool navigationProbe(const std::string &dbPath)
+{
+    NavigationWalk walk;
+    ViewerOptions options;
+    if (!walk.prepare(dbPath, options) || !runViewer(dbPath, options))
+        return false;
+
+    std::cerr << "navigation-allocations " << walk.countedAllocations() << " " << walk.passKeys() << " " << walk.countedMs() << std::endl;
+    return true;
+}
@@ -0,0 +1,43 @@
+// libFuzzer target for CsvReader: any input must parse to the end without
+// reading outside it, whatever the buffer size
+#include "../include/csv_reader.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < 1)
+        return 0;
+
+    // The first byte picks the buffer size, so refills split records anywhere
+    size_t bufferBytes = 1 + data[0] % 64;
+    std::string input(reinterpret_cast<const char *>(data + 1), size - 1);
+
+    FILE *stream = fmemopen(input.empty() ? nullptr : &input[0], input.size(), "rb");
+    if (!stream)
+        return 0;
+
+    CsvReader csv(bufferBytes);
+    csv.attach(stream);
+
+    size_t fieldBytes = 0;
+    while (csv.next())
+    {
+        for (size_t i = 0; i < csv.fieldCount(); i++)
+        {
+            fieldBytes += csv.field(i).size();
+            int value;
+            csv.integer(i, value);
+        }
+
+        // Unquoting only ever shortens the text, and the reader never runs past the input
+        if (fieldBytes > input.size() || csv.bytesRead() > input.size())
+            abort();
+    }
+
+    csv.close();
+    fclose(stream);
+    return 0;
+}
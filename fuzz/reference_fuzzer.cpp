@@ -0,0 +1,61 @@
+// libFuzzer target for VerseIndex::parseReference and parseRange: any text
+// must either be rejected or resolve to verses inside the index
+#include "../include/schema.h"
+#include "../include/verse_index.h"
+#include <sqlite3.h>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+// A small index with one- and many-chapter books and numbered book names
+static const VerseIndex &fuzzIndex()
+{
+    static VerseIndex index;
+    static bool loaded = false;
+    if (loaded)
+        return index;
+
+    sqlite3 *db;
+    sqlite3_open(":memory:", &db);
+    ensureSchema(db);
+    sqlite3_exec(db,
+                 "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 40),"
+                 "books(ord, book, chapters, verses) AS (VALUES (1, 'Genesis', 3, 31), (2, 'Ruth', 4, 22), (3, 'Psalms', 3, 40),"
+                 "    (4, 'John', 3, 36), (5, '1 Corinthians', 2, 16), (6, 'Jude', 1, 25), (7, 'Revelation', 2, 29))"
+                 "INSERT INTO bible (book, chapter, verse, text) "
+                 "SELECT book, c.i, v.i, 'text' FROM books, n AS c, n AS v WHERE c.i <= chapters AND v.i <= verses "
+                 "ORDER BY ord, c.i, v.i",
+                 nullptr, nullptr, nullptr);
+    index.load(db);
+    sqlite3_close(db);
+
+    loaded = true;
+    return index;
+}
+
+static void checkPosition(const VerseIndex &index, const VersePosition &position)
+{
+    if (index.absolute(position) < 0)
+        abort();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    const VerseIndex &index = fuzzIndex();
+    std::string text(reinterpret_cast<const char *>(data), size);
+
+    VersePosition position;
+    if (index.parseReference(text, position))
+        checkPosition(index, position);
+
+    VersePosition first, last;
+    if (index.parseRange(text, first, last))
+    {
+        checkPosition(index, first);
+        checkPosition(index, last);
+        if (index.absolute(first) > index.absolute(last))
+            abort();
+    }
+
+    return 0;
+}
@@ -0,0 +1,43 @@
+#ifndef AHO_CORASICK_H
+#define AHO_CORASICK_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Half-open byte range [begin, end) of a match inside a verse
+struct HitSpan
+{
+    size_t begin;
+    size_t end;
+};
+
+// Multi-term matcher used to highlight query terms. All terms are compiled
+// into a single automaton with a full transition table, so a verse is scanned
+// in one pass regardless of how many terms there are. Matching is byte-exact;
+// callers pass folded terms and scan folded text.
+class AhoCorasick
+{
+private:
+    std::vector<int> transitions; // 256 entries per state
+    std::vector<size_t> longest;  // Longest term ending in each state, 0 if none
+
+public:
+    AhoCorasick();
+
+    // Build the automaton from a list of terms; empty terms are ignored
+    void build(const std::vector<std::string> &terms);
+
+    bool empty() const { return longest.size() <= 1; }
+
+    // Return merged, non-overlapping spans of every term occurrence in text
+    std::vector<HitSpan> scan(const std::string &text) const;
+
+    // Append the spans to an existing vector, so its capacity can be reused
+    void scan(const std::string &text, std::vector<HitSpan> &spans) const;
+};
+
+// Split a search query into the individual terms to highlight
+std::vector<std::string> splitQueryTerms(const std::string &query);
+
+#endif
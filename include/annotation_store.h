@@ -0,0 +1,106 @@
+#ifndef ANNOTATION_STORE_H
+#define ANNOTATION_STORE_H
+
+#include <sqlite3.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class AnnotationKind
+{
+    Bookmark,
+    Highlight,
+    Note
+};
+
+const int annotationKindCount = 3;
+
+// One bit per verse id, growing as higher ids are set
+class VerseBitmap
+{
+private:
+    std::vector<uint64_t> words;
+    size_t bitCount = 0;
+
+public:
+    bool test(int id) const
+    {
+        size_t word = static_cast<size_t>(id) / 64;
+        return id >= 0 && word < words.size() && (words[word] >> (id % 64) & 1);
+    }
+
+    // Returns whether the bit changed
+    bool set(int id, bool value);
+
+    size_t count() const { return bitCount; }
+    const std::vector<uint64_t> &data() const { return words; }
+    size_t memoryBytes() const { return words.capacity() * sizeof(uint64_t); }
+};
+
+// Bookmarks, highlights and notes attached to canonical verse ids. Lookups
+// are a bit test per kind, so drawing markers costs nothing per verse; the
+// database copy in the 'annotations' table is written by a background
+// thread in batches, so annotating never waits on the disk.
+class AnnotationStore
+{
+private:
+    struct Change
+    {
+        int verseId;
+        AnnotationKind kind;
+        bool present;
+        std::string note;
+    };
+
+    VerseBitmap bitmaps[annotationKindCount];
+    std::map<int, std::string> notes;
+
+    std::string dbPath;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Change> pending; // Changes not yet handed to the writer
+    bool stopping = false;
+    std::thread writer;
+    std::string writeError; // First failure, reported once the writer stops
+
+    void queue(Change change);
+    void writerLoop();
+    bool writeBatch(sqlite3 *db, const std::vector<Change> &batch, std::string &error);
+
+public:
+    AnnotationStore() = default;
+
+    // Writes out everything still queued before returning
+    ~AnnotationStore();
+
+    AnnotationStore(const AnnotationStore &) = delete;
+    AnnotationStore &operator=(const AnnotationStore &) = delete;
+
+    // Read every annotation and start the writer on its own connection to dbPath
+    bool open(sqlite3 *db, const std::string &path);
+
+    bool has(AnnotationKind kind, int verseId) const { return bitmaps[static_cast<int>(kind)].test(verseId); }
+
+    // Flip a bookmark or highlight, returning whether it is now set
+    bool toggle(AnnotationKind kind, int verseId);
+
+    // Attach a note to a verse; empty text removes it
+    void setNote(int verseId, const std::string &text);
+
+    // Note of a verse, empty if it has none
+    const std::string &note(int verseId) const;
+
+    size_t count(AnnotationKind kind) const { return bitmaps[static_cast<int>(kind)].count(); }
+
+    // Ids of verses with any annotation, ascending
+    std::vector<int> annotatedVerses() const;
+
+    size_t memoryBytes() const;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Monotonic bump allocator. Memory is handed out from large blocks and only
+// released all at once by reset() or destruction, which makes it cheap to
+// store many small keys or per-frame results.
+class Arena
+{
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<size_t> blockSizes;
+    size_t blockSize;
+    size_t currentBlock = 0;
+    size_t offset = 0;
+    size_t used = 0;
+
+public:
+    explicit Arena(size_t blockSize = 64 * 1024);
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    // Copy bytes into the arena and return the copy
+    const char *copy(const char *data, size_t length);
+
+    // Forget every allocation but keep the blocks for reuse
+    void reset();
+
+    size_t bytesUsed() const { return used; }
+
+    size_t bytesReserved() const;
+};
+
+#endif
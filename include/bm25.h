@@ -0,0 +1,52 @@
+#ifndef BM25_H
+#define BM25_H
+
+#include "stemmer.h"
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+
+// One entry of a term's posting list
+struct Posting
+{
+    int verseId;
+    int tf; // Occurrences of the term in the verse
+};
+
+struct ScoredVerse
+{
+    int verseId;
+    double score;
+};
+
+// BM25 ranking over the stem index. Document lengths (bible.word_count)
+// are loaded once; term postings with their frequencies are read per query.
+// Scoring runs document-at-a-time with WAND pruning on a bounded top-k heap,
+// with the verse id space split across threads.
+class Bm25Ranker
+{
+private:
+    std::vector<int> docLengths; // Indexed by verse id
+    double averageLength = 0.0;
+    size_t docCount = 0;
+    double k1 = 1.2;
+    double b = 0.75;
+
+public:
+    // Load document lengths from the database
+    bool load(sqlite3 *db);
+
+    // Bytes held by the document length table
+    size_t memoryBytes() const { return sizeof(*this) + docLengths.capacity() * sizeof(int); }
+
+    // Read the posting list of one stem, sorted by verse id
+    static std::vector<Posting> readPostings(sqlite3 *db, const std::string &stem);
+
+    // Best k verses for the given per-term posting lists, highest score first
+    std::vector<ScoredVerse> topK(const std::vector<std::vector<Posting>> &terms, size_t k) const;
+
+    // Convenience wrapper: fold, tokenize and stem a query, then rank
+    std::vector<ScoredVerse> search(sqlite3 *db, const Stemmer &stemmer, const std::string &foldedQuery, size_t k) const;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef BULK_IMPORT_H
+#define BULK_IMPORT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// One translation CSV to import, and what happened to it
+struct TranslationImport
+{
+    std::string code;
+    std::string csvPath;
+    bool ok = false;
+    size_t verses = 0;
+    size_t unmatched = 0;    // Rows with no counterpart in the base text
+    size_t csvBytes = 0;
+    size_t rawBytes = 0;     // Text of the whole translation after the import
+    size_t compressedBytes = 0;
+    size_t chapters = 0;
+    size_t changedChapters = 0; // Chapters whose content hash differed from the last import
+    size_t changedVerses = 0;
+    bool incremental = false;   // Only the changed chapters were rewritten
+    double buildMs = 0.0;    // Parsing, resolving and compressing on a worker
+};
+
+// Translation code for a CSV path: "web.csv" imports as "web"
+std::string translationCodeFor(const std::string &csvPath);
+
+// Import translation CSVs concurrently. Worker threads (at most workers of
+// them, one file each at a time) parse, resolve canonical ids and compress
+// on their own read-only connections; a single writer connection commits
+// the finished translations in large transactions. The database is switched
+// to WAL mode first so viewers keep reading consistent snapshots throughout.
+// Returns false if any file failed; each entry records its own outcome.
+bool importTranslations(const std::string &dbPath, std::vector<TranslationImport> &imports, size_t workers);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef COMMAND_OPTIONS_H
+#define COMMAND_OPTIONS_H
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Option parser shared by the subcommands. Each command declares its flags
+// and the options that take a value; anything else starting with "--" is an
+// error, so a mistyped option is reported instead of silently ignored.
+class CommandOptions
+{
+private:
+    struct Option
+    {
+        std::string name;
+        bool takesValue;
+        std::function<bool(const std::string &)> apply; // False if the value is invalid
+    };
+
+    std::vector<Option> options;
+    bool allowPositional = false;
+    std::vector<std::string> positional;
+
+public:
+    // A flag without a value
+    void flag(const std::string &name, std::function<void()> apply);
+
+    // An option followed by a value; apply returns false to reject the value
+    void value(const std::string &name, std::function<bool(const std::string &)> apply);
+
+    // Accept arguments that aren't options, collected in order
+    void acceptPositional() { allowPositional = true; }
+    const std::vector<std::string> &arguments() const { return positional; }
+
+    // Parse argv[first..argc). On an unknown option, a missing or invalid
+    // value, or an unexpected argument prints the error and returns false.
+    bool parse(int argc, char *argv[], int first);
+};
+
+// Parse a whole non-negative decimal number; false for anything else
+bool parseCount(const std::string &text, size_t &count);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef CONCORDANCE_H
+#define CONCORDANCE_H
+
+#include "corpus.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct ConcordanceOptions
+{
+    int window = 1;         // Consecutive verses (within a chapter) that count as co-occurring
+    size_t topPairs = 1000; // Most frequent co-occurring pairs to keep
+};
+
+struct WordStats
+{
+    std::string word;    // Folded form, which is what is counted
+    std::string surface; // Its most frequent spelling in the text, such as "LORD" for "lord"
+    uint32_t total = 0;
+    uint32_t oldTestament = 0;
+    uint32_t newTestament = 0;
+    std::vector<uint32_t> perBook; // Indexed like Concordance::books
+};
+
+struct PairStats
+{
+    std::string first;
+    std::string second;
+    uint32_t count; // Windows containing both words
+};
+
+struct Concordance
+{
+    std::vector<std::string> books;       // In canonical order
+    std::vector<size_t> bookVocabulary;   // Distinct words per book
+    std::vector<WordStats> words;         // Most frequent first
+    std::vector<PairStats> pairs;         // Most frequent first
+    size_t tokenCount = 0;
+};
+
+// Compute word frequencies, vocabulary sizes and co-occurrences over the
+// folded text of a corpus. Shards of the corpus are counted on separate
+// threads into private hash tables whose keys live in per-thread arenas;
+// the tables are merged once every shard is done. Words are counted by
+// folded form; each also records its most frequent spelling in the text.
+Concordance buildConcordance(const std::vector<Verse> &verses, const ConcordanceOptions &options);
+
+// Write word_frequency.csv, hapax.csv, book_vocabulary.csv and cooccurrence.csv into a directory
+bool writeConcordanceCsv(const Concordance &concordance, const std::string &directory);
+
+// Write everything as a single JSON document
+void writeConcordanceJson(const Concordance &concordance, std::ostream &out);
+
+#endif
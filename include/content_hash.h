@@ -0,0 +1,17 @@
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 64-bit XXH64 of a byte range. Used to fingerprint chapters so a re-import
+// can tell which ones changed without comparing the text itself.
+uint64_t contentHash(const void *data, size_t length, uint64_t seed = 0);
+
+inline uint64_t contentHash(const std::string &text, uint64_t seed = 0)
+{
+    return contentHash(text.data(), text.length(), seed);
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include "text_fold.h"
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+
+// Structure to hold Bible verses
+struct Verse
+{
+    int id;
+    std::string book;
+    int chapter;
+    int verse;
+    std::string text;
+    std::string folded; // Case-folded shadow of text that searches match against
+    FoldMap foldMap;    // Maps offsets in folded back into text
+};
+
+// Columns readVerse expects, in order, for use in SELECT statements
+extern const char *const VERSE_COLUMNS;
+
+// Fill a verse from the current row of a statement selecting VERSE_COLUMNS
+void readVerse(sqlite3_stmt *stmt, Verse &verse);
+
+// Load every verse of the 'bible' table into memory, ordered by id
+bool loadCorpus(sqlite3 *db, std::vector<Verse> &verses);
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef CORPUS_STORE_H
+#define CORPUS_STORE_H
+
+#include "arena.h"
+#include "corpus.h"
+#include <sqlite3.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Read access to the base text (books, chapters, verses and substring
+// search) independent of where it lives. Backends are interchangeable:
+// tests/corpus_store_test.cpp checks that they answer identically, and the
+// store benchmark (bible_bench store) times them.
+class CorpusStore
+{
+public:
+    virtual ~CorpusStore() = default;
+
+    virtual const char *backendName() const = 0;
+
+    // Book names in canonical order
+    virtual std::vector<std::string> books() = 0;
+
+    virtual int chapterCount(const std::string &book) = 0;
+
+    // Verses of a chapter in verse order
+    virtual std::vector<Verse> chapter(const std::string &book, int chapter) = 0;
+
+    virtual bool verse(int id, Verse &verse) = 0;
+
+    // Every verse, ordered by id
+    virtual bool allVerses(std::vector<Verse> &verses) = 0;
+
+    // Ids of verses whose folded text contains an already folded term, ascending
+    virtual std::vector<int> search(const std::string &foldedTerm) = 0;
+
+    // Memory held by the backend itself
+    virtual size_t memoryBytes() const { return 0; }
+};
+
+// Queries the 'bible' table directly, with statements prepared once
+class SqliteCorpusStore : public CorpusStore
+{
+private:
+    sqlite3 *db;
+    bool ownsConnection;
+    sqlite3_stmt *selectBooks = nullptr;
+    sqlite3_stmt *selectChapterCount = nullptr;
+    sqlite3_stmt *selectChapter = nullptr;
+    sqlite3_stmt *selectVerse = nullptr;
+    sqlite3_stmt *selectMatches = nullptr;
+
+    sqlite3_stmt *prepare(sqlite3_stmt *&stmt, const std::string &sql);
+
+public:
+    // Closes the connection on destruction only if it owns it
+    explicit SqliteCorpusStore(sqlite3 *database, bool owned = false) : db(database), ownsConnection(owned) {}
+    ~SqliteCorpusStore() override;
+
+    SqliteCorpusStore(const SqliteCorpusStore &) = delete;
+    SqliteCorpusStore &operator=(const SqliteCorpusStore &) = delete;
+
+    const char *backendName() const override { return "sqlite"; }
+    std::vector<std::string> books() override;
+    int chapterCount(const std::string &book) override;
+    std::vector<Verse> chapter(const std::string &book, int chapter) override;
+    bool verse(int id, Verse &verse) override;
+    bool allVerses(std::vector<Verse> &verses) override;
+    std::vector<int> search(const std::string &foldedTerm) override;
+};
+
+// Fixed-size record of one verse in a flat store; strings are offsets into
+// a single pool so the same layout works in memory and in a mapped file
+struct FlatVerse
+{
+    int32_t id;
+    int32_t book; // Index into the book list
+    int32_t chapter;
+    int32_t verse;
+    uint32_t textOffset;
+    uint32_t textLength;
+    uint32_t foldedOffset;
+    uint32_t foldedLength;
+    uint32_t mapOffset;
+    uint32_t mapLength;
+};
+
+// Verses as one array of records ordered by id plus a string pool, with a
+// chapter index built on open. Search scans the pooled folded text in place.
+class FlatCorpusStore : public CorpusStore
+{
+protected:
+    const FlatVerse *records = nullptr;
+    size_t recordCount = 0;
+    const char *pool = nullptr;
+    std::vector<std::string> bookNames;
+    std::vector<std::vector<uint32_t>> chapterStarts; // Per book, first record of each chapter, plus an end marker
+
+    // Fill bookNames and the chapter index once records and pool are set
+    void buildIndex(std::vector<std::string> names);
+
+    void toVerse(const FlatVerse &record, Verse &verse) const;
+    int bookIndex(const std::string &book) const;
+
+public:
+    std::vector<std::string> books() override { return bookNames; }
+    int chapterCount(const std::string &book) override;
+    std::vector<Verse> chapter(const std::string &book, int chapter) override;
+    bool verse(int id, Verse &verse) override;
+    bool allVerses(std::vector<Verse> &verses) override;
+    std::vector<int> search(const std::string &foldedTerm) override;
+};
+
+// The whole text copied out of SQLite into an arena at load
+class ArenaCorpusStore : public FlatCorpusStore
+{
+private:
+    Arena arena;
+
+public:
+    ArenaCorpusStore() : arena(1 << 20) {}
+
+    bool load(sqlite3 *db);
+
+    const char *backendName() const override { return "arena"; }
+    size_t memoryBytes() const override;
+};
+
+// A corpus file written by writeCorpusFile, mapped read-only; the kernel
+// pages the text in on demand and shares it between processes
+class MappedCorpusStore : public FlatCorpusStore
+{
+private:
+    void *mapping = nullptr;
+    size_t mappedBytes = 0;
+
+public:
+    MappedCorpusStore() = default;
+    ~MappedCorpusStore() override;
+
+    MappedCorpusStore(const MappedCorpusStore &) = delete;
+    MappedCorpusStore &operator=(const MappedCorpusStore &) = delete;
+
+    bool open(const std::string &path);
+
+    const char *backendName() const override { return "mmap"; }
+    size_t memoryBytes() const override { return 0; } // Page cache, not heap
+};
+
+enum class StoreBackend
+{
+    Sqlite,
+    Arena,
+    Mapped
+};
+
+bool parseStoreBackend(const std::string &name, StoreBackend &backend);
+
+// Corpus file kept next to a database for the mmap backend
+std::string corpusFilePath(const std::string &dbPath);
+
+// Write the text of the 'bible' table as a corpus file (via a temporary file and rename)
+bool writeCorpusFile(sqlite3 *db, const std::string &path);
+
+// Open a backend over a database. The SQLite backend borrows db; the mmap
+// backend first rewrites the corpus file if it is missing, older than the database or damaged.
+std::unique_ptr<CorpusStore> openCorpusStore(StoreBackend backend, sqlite3 *db, const std::string &dbPath);
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef CSV_READER_H
+#define CSV_READER_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Streaming reader for the import CSV files: fields separated by commas,
+// optionally padded with spaces and optionally quoted, where a quoted field
+// may hold commas, newlines and "" for a quote. Records of any length are
+// read through one growing buffer, so no input can overrun a fixed array.
+// A field left unterminated at the end of the file ends its record there.
+class CsvReader
+{
+private:
+    FILE *file = nullptr;
+    bool ownsFile = false;
+    std::vector<char> buffer;
+    size_t position = 0; // Start of the next record in buffer
+    size_t end = 0;      // Bytes of buffer holding data
+    bool atEnd = false;  // Nothing more to read from the file
+    size_t consumed = 0; // Bytes of input behind position
+    size_t records = 0;
+    std::vector<std::string> fields; // Kept between records to reuse their capacity
+    size_t fieldsUsed = 0;
+
+    enum class Parse
+    {
+        Record,
+        NeedMore,
+        Finished
+    };
+
+    Parse parseRecord();
+    void refill();
+
+public:
+    explicit CsvReader(size_t bufferBytes = 1 << 20) : buffer(bufferBytes) {}
+    ~CsvReader() { close(); }
+
+    CsvReader(const CsvReader &) = delete;
+    CsvReader &operator=(const CsvReader &) = delete;
+
+    bool open(const std::string &path);
+
+    // Read from an already open stream, which the caller closes
+    void attach(FILE *stream);
+
+    void close();
+
+    // Parse the next record; false once the input is exhausted
+    bool next();
+
+    size_t fieldCount() const { return fieldsUsed; }
+    const std::string &field(size_t index) const { return fields[index]; }
+
+    // A field holding a decimal integer and nothing else
+    bool integer(size_t index, int &value) const;
+
+    // Input bytes up to the end of the last record, and records read so far
+    size_t bytesRead() const { return consumed; }
+    size_t recordCount() const { return records; }
+};
+
+#endif
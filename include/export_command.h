@@ -0,0 +1,11 @@
+#ifndef EXPORT_COMMAND_H
+#define EXPORT_COMMAND_H
+
+#include "text_export.h"
+#include <string>
+
+// Write a range of verses, or the whole text when range is empty, to a file
+// or to stdout when outPath is empty
+bool exportCommand(const std::string &dbPath, const std::string &range, ExportFormat format, const std::string &outPath);
+
+#endif
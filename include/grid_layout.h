@@ -0,0 +1,53 @@
+#ifndef GRID_LAYOUT_H
+#define GRID_LAYOUT_H
+
+#include "list_view.h"
+#include <functional>
+#include <map>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Column count and widths for a grid of labels at one terminal size
+struct GridShape
+{
+    int columns = 1;
+    int rows = 0;
+    std::vector<int> widths; // Per column, including the gap
+};
+
+// Sizes a column-major grid of labels to the terminal, the way ls lays out
+// file names: each column is as wide as its longest label, and the grid uses
+// the fewest columns that fit everything on screen, or as many as the width
+// allows when it cannot. Only label widths are kept, never the labels, and
+// shapes are cached per terminal size so resizing back and forth is free.
+class GridLayout
+{
+private:
+    std::vector<int> labelWidths;
+    int gap;
+    std::map<std::pair<int, int>, GridShape> shapes; // Keyed by (width, height)
+
+    // Column widths if the labels are split into rows of the given length
+    std::vector<int> columnWidths(size_t rows) const;
+
+    GridShape compute(int width, int height) const;
+
+public:
+    explicit GridLayout(int columnGap = 2) : gap(columnGap) {}
+
+    // Record the display width of each label; width(i) is called once per label
+    void measure(size_t count, const std::function<int(size_t)> &width);
+
+    size_t count() const { return labelWidths.size(); }
+
+    const GridShape &shape(int width, int height);
+
+    // Lay a list out as this grid for the given area
+    void apply(ListView &list, int width, int height);
+};
+
+// Columns a UTF-8 string occupies, counting one per code point
+int displayWidth(std::string_view text);
+
+#endif
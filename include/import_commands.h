@@ -0,0 +1,23 @@
+#ifndef IMPORT_COMMANDS_H
+#define IMPORT_COMMANDS_H
+
+#include "bulk_import.h"
+#include "text_fold.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Create an empty database with the schema, recording how text will be folded and stemmed
+bool createDatabase(const std::string &dbPath, const FoldOptions &options, const std::string &stemmerName);
+
+// Import the base text from a CSV file. Re-importing a revised text
+// rewrites only the chapters whose content changed.
+bool importBibleFromCSV(const std::string &dbPath, const std::string &csvPath);
+
+// Import parallel translations from CSV files, several at once
+bool importTranslationsFromCSV(const std::string &dbPath, std::vector<TranslationImport> &imports, size_t workers);
+
+// Load a translation's versification differences from a CSV file
+bool importVersificationFromCSV(const std::string &dbPath, const std::string &code, const std::string &csvPath);
+
+#endif
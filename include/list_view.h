@@ -0,0 +1,71 @@
+#ifndef LIST_VIEW_H
+#define LIST_VIEW_H
+
+#include <curses.h>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Scrolling list of items laid out in one or more columns, filled row by row
+// or (for grids sized by GridLayout) down each column in turn. Only
+// the rows on screen are drawn: each visible item is requested from a
+// callback by index, so a list of 100k search hits costs no more to show
+// than a list of ten. Selection can jump straight to any index.
+class ListView
+{
+public:
+    // Draw item index into a cell of the window; selected is the cursor item
+    typedef std::function<void(WINDOW *window, size_t index, int y, int x, int width, bool selected)> DrawItem;
+
+private:
+    WINDOW *window = nullptr;
+    int top = 0;
+    int left = 0;
+    int height = 1;
+    int width = 1;
+    int columns = 1;
+    std::vector<int> columnWidths; // Empty for equal-width columns
+    bool columnMajor = false;      // Items run down each column first
+    int itemHeight = 1;   // Lines per item
+    size_t itemCount = 0;
+    size_t selected = 0;
+    size_t firstRow = 0;  // First row of items on screen
+    DrawItem drawItem;
+
+    size_t rowCount() const;
+    size_t rowOf(size_t index) const;
+    size_t columnOf(size_t index) const;
+    size_t indexAt(size_t row, size_t column) const;
+    void scrollToSelection();
+
+public:
+    // Screen area the list occupies within a window
+    void setArea(WINDOW *target, int y, int x, int rows, int cols);
+
+    void setColumns(int count);
+
+    // Explicit column widths; also sets the column count
+    void setColumnWidths(const std::vector<int> &widths);
+
+    void setColumnMajor(bool enabled);
+    void setItemHeight(int lines);
+    void setItemCount(size_t count);
+    void setDrawItem(DrawItem draw) { drawItem = draw; }
+
+    size_t count() const { return itemCount; }
+    size_t selection() const { return selected; }
+
+    // Rows of items that fit on screen
+    int visibleRows() const;
+
+    // Move the cursor to an item, scrolling only as far as needed
+    void select(size_t index);
+
+    // Arrow keys, Page Up/Down, Home and End; returns false for other keys
+    bool handleKey(int key);
+
+    // Blank the list's area and draw the visible items
+    void draw() const;
+};
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include "corpus.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+class MemoryBudget;
+
+// Something whose memory is accounted for by a MemoryBudget. Caches that can
+// drop entries override oldestPriority/evictOldest; the rest are only counted.
+class BudgetedCache
+{
+public:
+    virtual ~BudgetedCache() = default;
+
+    virtual const char *cacheName() const = 0;
+
+    // Bytes held, including the heap buffers of contained strings and vectors
+    virtual size_t bytesUsed() const = 0;
+
+    virtual size_t entryCount() const { return 0; }
+
+    virtual bool evictable() const { return false; }
+
+    // Priority of the entry that would be evicted next; lowest goes first
+    virtual double oldestPriority() const { return std::numeric_limits<double>::infinity(); }
+
+    // Drop that entry, returning the bytes freed
+    virtual size_t evictOldest() { return 0; }
+};
+
+// Central byte budget shared by the viewer's caches. Entries are ranked
+// GreedyDual-style: priority is the current inflation value plus rebuild cost
+// per byte, refreshed on every use, so eviction is LRU among entries of equal
+// cost and keeps expensive small entries longer than cheap large ones.
+class MemoryBudget
+{
+private:
+    size_t limit = 0; // Zero means unlimited
+    double inflation = 0.0;
+    size_t evictions = 0;
+    std::vector<BudgetedCache *> caches;
+
+public:
+    void setLimit(size_t bytes) { limit = bytes; }
+    size_t getLimit() const { return limit; }
+    size_t evictionCount() const { return evictions; }
+
+    void attach(BudgetedCache *cache) { caches.push_back(cache); }
+    const std::vector<BudgetedCache *> &members() const { return caches; }
+
+    // Priority for an entry being inserted or used now
+    double priority(double cost, size_t bytes) const;
+
+    size_t bytesUsed() const;
+
+    // Evict the lowest-priority entries across all caches until usage fits
+    void enforce();
+};
+
+// Memory that cannot be evicted but still counts against the budget
+class MemoryGauge : public BudgetedCache
+{
+private:
+    const char *label;
+    std::function<size_t()> measure;
+
+public:
+    MemoryGauge(const char *name, std::function<size_t()> measureBytes) : label(name), measure(measureBytes) {}
+
+    const char *cacheName() const override { return label; }
+    size_t bytesUsed() const override { return measure(); }
+};
+
+// Parse sizes such as "32M", "512K", "1G" or a plain byte count
+bool parseByteSize(const std::string &text, size_t &bytes);
+
+// Format a byte count as B, KiB or MiB for display
+std::string formatBytes(size_t bytes);
+
+// Heap bytes owned by a string (zero while it fits the small-string buffer)
+size_t heapBytes(const std::string &text);
+
+// Bytes of a verse including its string and fold map buffers
+size_t verseBytes(const Verse &verse);
+
+size_t verseVectorBytes(const std::vector<Verse> &verses);
+
+// Key/value cache with LRU order that reports to a MemoryBudget. Each entry
+// counts its value as measured plus the map and list node overhead.
+template <typename Key, typename Value>
+class LruCache : public BudgetedCache
+{
+private:
+    struct Entry
+    {
+        Value value;
+        size_t bytes;
+        double priority;
+        typename std::list<Key>::iterator position;
+    };
+
+    // Red-black tree node header plus a doubly linked list node
+    static const size_t nodeOverhead = 4 * sizeof(void *) + 2 * sizeof(void *) + sizeof(Key);
+
+    const char *label;
+    double cost;
+    size_t (*measure)(const Value &);
+    size_t capacity;
+    MemoryBudget *budget = nullptr;
+    std::list<Key> recent; // Most recently used first
+    std::map<Key, Entry> entries;
+    size_t total = 0;
+
+public:
+    LruCache(const char *name, double rebuildCost, size_t (*measureValue)(const Value &),
+             size_t maxEntries = std::numeric_limits<size_t>::max())
+        : label(name), cost(rebuildCost), measure(measureValue), capacity(maxEntries)
+    {
+    }
+
+    void attach(MemoryBudget *memoryBudget)
+    {
+        budget = memoryBudget;
+        budget->attach(this);
+    }
+
+    // Cached value marked as just used, or null
+    Value *find(const Key &key)
+    {
+        auto found = entries.find(key);
+        if (found == entries.end())
+            return nullptr;
+
+        recent.splice(recent.begin(), recent, found->second.position);
+        if (budget)
+            found->second.priority = budget->priority(cost, found->second.bytes);
+        return &found->second.value;
+    }
+
+    Value &insert(const Key &key, Value value)
+    {
+        erase(key);
+        if (entries.size() >= capacity && !recent.empty())
+            evictOldest();
+
+        size_t bytes = measure(value) + sizeof(Entry) + nodeOverhead;
+        recent.push_front(key);
+
+        Entry &entry = entries[key];
+        entry.value = std::move(value);
+        entry.bytes = bytes;
+        entry.priority = budget ? budget->priority(cost, bytes) : 0.0;
+        entry.position = recent.begin();
+        total += bytes;
+        return entry.value;
+    }
+
+    void erase(const Key &key)
+    {
+        auto found = entries.find(key);
+        if (found == entries.end())
+            return;
+
+        total -= found->second.bytes;
+        recent.erase(found->second.position);
+        entries.erase(found);
+    }
+
+    void clear()
+    {
+        recent.clear();
+        entries.clear();
+        total = 0;
+    }
+
+    const char *cacheName() const override { return label; }
+    size_t bytesUsed() const override { return total; }
+    size_t entryCount() const override { return entries.size(); }
+    bool evictable() const override { return true; }
+
+    double oldestPriority() const override
+    {
+        if (recent.empty())
+            return std::numeric_limits<double>::infinity();
+        return entries.find(recent.back())->second.priority;
+    }
+
+    size_t evictOldest() override
+    {
+        if (recent.empty())
+            return 0;
+
+        Key key = recent.back();
+        size_t bytes = entries.find(key)->second.bytes;
+        erase(key);
+        return bytes;
+    }
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef MINHASH_H
+#define MINHASH_H
+
+#include <cstdint>
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+
+// MinHash signatures over word shingles, split into LSH bands. Verses that
+// agree on every row of at least one band land in the same bucket, so
+// similar verses are found with a handful of bucket lookups.
+const int MINHASH_HASHES = 32;
+const int MINHASH_BANDS = 8;
+const int MINHASH_ROWS = MINHASH_HASHES / MINHASH_BANDS;
+
+typedef std::vector<uint32_t> MinHashSignature;
+
+struct RelatedVerse
+{
+    int verseId;
+    double similarity; // Exact Jaccard similarity of the word shingles
+};
+
+// Hashes of the word bigrams of a verse (single words for one-word verses), sorted and unique
+std::vector<uint64_t> shingleHashes(const std::vector<std::string> &words);
+
+MinHashSignature minHashSignature(const std::vector<uint64_t> &shingles);
+
+// Bucket key of one band of a signature
+uint32_t bandBucket(const MinHashSignature &signature, int band);
+
+double jaccard(const std::vector<uint64_t> &a, const std::vector<uint64_t> &b);
+
+// Writes signatures (minhash) and band buckets (lsh_buckets) during import
+class MinHashIndexWriter
+{
+private:
+    sqlite3 *db = nullptr;
+    sqlite3_stmt *insertSignature = nullptr;
+    sqlite3_stmt *insertBucket = nullptr;
+    sqlite3_stmt *selectSignature = nullptr;
+    sqlite3_stmt *deleteSignature = nullptr;
+    sqlite3_stmt *deleteBucket = nullptr;
+
+public:
+    bool open(sqlite3 *database);
+
+    // Index one verse, given its words as returned by tokenize()
+    bool addVerse(int verseId, const std::vector<std::string> &words);
+
+    // Drop a verse's signature and the buckets its stored signature put it in
+    bool removeVerse(int verseId);
+
+    void close();
+
+    ~MinHashIndexWriter();
+};
+
+// Rebuild signatures and buckets from the folded text in the 'bible' table
+bool rebuildMinHashIndex(sqlite3 *db);
+
+// Up to count verses most similar to the given one, best first. Only the
+// base text is indexed, so parallel translations never contribute matches.
+std::vector<RelatedVerse> findRelatedVerses(sqlite3 *db, int verseId, size_t count);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+// Number of worker threads to use for corpus-wide jobs (at least 1)
+size_t workerCount();
+
+// Split [0, count) into contiguous shards and run fn(begin, end, shard) for
+// each shard on its own thread. The calling thread runs the last shard.
+// Returns once every shard has finished.
+void parallelFor(size_t count, const std::function<void(size_t, size_t, size_t)> &fn, size_t shards = 0);
+
+#endif
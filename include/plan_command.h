@@ -0,0 +1,16 @@
+#ifndef PLAN_COMMAND_H
+#define PLAN_COMMAND_H
+
+#include <string>
+#include <vector>
+
+// "30", "30,90,365" or a span such as "1-5000"
+bool parseDayCounts(const std::string &text, std::vector<int> &dayCounts);
+
+// Reading plans over a range for each requested number of days, written as
+// JSON. With opening set, stores where today's reading starts instead of
+// printing (unless an output file is given).
+bool planCommand(const std::string &dbPath, const std::vector<int> &dayCounts, const std::string &range, long startDate,
+                 const std::string &outPath, std::string *opening);
+
+#endif
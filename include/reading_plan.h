@@ -0,0 +1,54 @@
+#ifndef READING_PLAN_H
+#define READING_PLAN_H
+
+#include "verse_index.h"
+#include "text_export.h"
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+
+// Running total of bible.word_count over absolute verse numbers, so the
+// words in any range are one subtraction. Verses without a count, and
+// slots with no verse, count as no words.
+class WordPrefix
+{
+private:
+    std::vector<long long> sums; // Words in verses before each absolute number, plus the total
+
+public:
+    bool load(sqlite3 *db, const VerseIndex &index);
+
+    // Words in absolute verses first..last inclusive
+    long long words(int first, int last) const { return sums[last + 1] - sums[first]; }
+
+    long long before(int absolute) const { return sums[absolute]; }
+};
+
+// One day of a plan: absolute verses first..last inclusive
+struct PlanDay
+{
+    int first;
+    int last;
+    long long words;
+};
+
+// Split verses first..last into days of near-equal word counts. Each cut is
+// placed where the running total comes closest to its share of the words,
+// found by one sweep along the prefix sums, so a plan costs time linear in
+// the range whatever the number of days. Every day gets at least one verse;
+// fails if there are fewer verses than days.
+bool partitionPlan(const WordPrefix &prefix, int first, int last, int days, std::vector<PlanDay> &schedule);
+
+// Calendar dates as days since 1970-01-01
+long daysFromCivil(int year, int month, int day);
+std::string civilDate(long days);
+bool parseDate(const std::string &text, long &days);
+long today();
+
+// Day of the plan that falls on a date, kept within the plan
+int planDayOn(long date, long startDate, size_t dayCount);
+
+// {"from", "to", "start", "days", "words", "schedule": [{"day", "date", "from", "to", "verses", "words"}]}
+void writePlanJson(OutputBuffer &out, const VerseIndex &index, const std::vector<PlanDay> &schedule, long startDate);
+
+#endif
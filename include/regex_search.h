@@ -0,0 +1,44 @@
+#ifndef REGEX_SEARCH_H
+#define REGEX_SEARCH_H
+
+#include "aho_corasick.h"
+#include "corpus.h"
+#include "text_fold.h"
+#include <regex>
+#include <string>
+#include <vector>
+
+// Regex search over an in-memory corpus. The pattern is folded the same way
+// as the corpus shadow text and matched against it, so matching is
+// case- and accent-insensitive. The pattern is compiled once and
+// then matched against shards of the corpus in parallel. A literal that
+// every match must contain is pulled out of the pattern and used to skip
+// verses with a plain substring scan before the regex engine runs.
+class RegexSearch
+{
+private:
+    std::regex pattern;
+    std::string literal; // Required literal used as a prefilter, empty if none
+    bool compiled = false;
+
+public:
+    // Compile the pattern (ECMAScript syntax). On failure returns false and fills error.
+    bool compile(const std::string &source, const FoldOptions &options, std::string &error);
+
+    // The literal every match must contain, empty when none could be proven
+    const std::string &requiredLiteral() const { return literal; }
+
+    // Return the indices of all verses whose folded text matches, in corpus order
+    std::vector<size_t> search(const std::vector<Verse> &verses) const;
+
+    // Append the spans of every non-empty match in a folded text
+    void matchSpans(const std::string &text, std::vector<HitSpan> &spans) const;
+
+    // Longest literal run that every match of the pattern must contain
+    static std::string extractRequiredLiteral(const std::string &source);
+};
+
+// Detect the "/pattern/" query syntax and extract the pattern
+bool parseRegexQuery(const std::string &term, std::string &pattern);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include "text_fold.h"
+#include <sqlite3.h>
+#include <string>
+
+// Create the 'bible' table and supporting tables if they don't exist, and
+// bring databases created by older versions up to date (adding and
+// backfilling derived columns).
+bool ensureSchema(sqlite3 *db);
+
+// Read and write key/value settings stored in the 'meta' table
+std::string getMeta(sqlite3 *db, const std::string &key, const std::string &fallback = "");
+bool setMeta(sqlite3 *db, const std::string &key, const std::string &value);
+
+// Folding rules the database's shadow text was built with
+FoldOptions loadFoldOptions(sqlite3 *db);
+bool saveFoldOptions(sqlite3 *db, const FoldOptions &options);
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef SEARCH_COMMANDS_H
+#define SEARCH_COMMANDS_H
+
+#include <cstddef>
+#include <string>
+
+// Print every verse matching a regular expression
+bool regexSearchCommand(const std::string &dbPath, const std::string &pattern);
+
+// Print the verses most relevant to a query, with their BM25 scores
+bool rankedSearchCommand(const std::string &dbPath, const std::string &query, size_t count);
+
+#endif
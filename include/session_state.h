@@ -0,0 +1,32 @@
+#ifndef SESSION_STATE_H
+#define SESSION_STATE_H
+
+#include <curses.h>
+#include <string>
+
+// Where the viewer was when it last exited, kept in a small file next to the
+// database so the next launch can resume there
+struct SessionState
+{
+    std::string book;
+    int chapter = 1;
+    int verse = 1;
+    int parallelCount = 1;
+    bool showRelated = false;
+    int rows = 0; // Terminal size the saved frame was drawn for
+    int cols = 0;
+};
+
+// State file used for a database
+std::string sessionStatePath(const std::string &dbPath);
+
+// Write the state followed by the last frame (via putwin) so the next start
+// can paint it before touching the database
+bool saveSessionState(const std::string &path, const SessionState &state, WINDOW *frame);
+
+// Read the state; if frame is given and a frame was saved, it receives a new
+// window (to be freed with delwin) or null. Requires curses to be running
+// when a frame is requested.
+bool loadSessionState(const std::string &path, SessionState &state, WINDOW **frame);
+
+#endif
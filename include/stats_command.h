@@ -0,0 +1,11 @@
+#ifndef STATS_COMMAND_H
+#define STATS_COMMAND_H
+
+#include "concordance.h"
+#include <string>
+
+// Compute a concordance and word statistics for the whole corpus and write
+// them as CSV files or one JSON file into outDir
+bool statsCommand(const std::string &dbPath, const std::string &format, const std::string &outDir, const ConcordanceOptions &options);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef STEM_INDEX_H
+#define STEM_INDEX_H
+
+#include "stemmer.h"
+#include <memory>
+#include <set>
+#include <sqlite3.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Writes the stem -> verse id index (stem_postings, with per-verse term
+// frequencies) and the surface forms seen for each stem (stem_forms) while
+// verses are imported. Uses the stemmer named in the database's meta table.
+class StemIndexWriter
+{
+private:
+    sqlite3 *db = nullptr;
+    sqlite3_stmt *insertPosting = nullptr;
+    sqlite3_stmt *insertForm = nullptr;
+    sqlite3_stmt *deletePosting = nullptr;
+    std::unique_ptr<Stemmer> stemmer;
+    std::set<std::pair<std::string, std::string>> seenForms; // Avoids re-inserting known forms
+
+public:
+    bool open(sqlite3 *database);
+
+    // Index the words of one verse, as returned by tokenize()
+    bool addVerse(int verseId, const std::vector<std::string> &words);
+
+    // Drop a verse's postings, given the words it was indexed with
+    bool removeVerse(int verseId, const std::vector<std::string> &words);
+
+    void close();
+
+    ~StemIndexWriter();
+};
+
+// Rebuild the whole stem index, and each verse's word_count, from the
+// folded text in the 'bible' table
+bool rebuildStemIndex(sqlite3 *db);
+
+// Stemmer configured for a database (archaic-english unless set otherwise)
+std::unique_ptr<Stemmer> loadStemmer(sqlite3 *db);
+
+// Verse ids containing any form of the word's stem, in ascending order
+std::vector<int> lookupStem(sqlite3 *db, const Stemmer &stemmer, const std::string &foldedWord);
+
+// Every surface form indexed under the word's stem, e.g. love, loved, loveth
+std::vector<std::string> stemForms(sqlite3 *db, const Stemmer &stemmer, const std::string &foldedWord);
+
+#endif
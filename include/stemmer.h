@@ -0,0 +1,40 @@
+#ifndef STEMMER_H
+#define STEMMER_H
+
+#include <memory>
+#include <string>
+
+// Reduces a folded word to the stem its inflected forms share
+class Stemmer
+{
+public:
+    virtual ~Stemmer() {}
+
+    // Name stored in the database so queries use the same rules as import
+    virtual const char *name() const = 0;
+
+    virtual std::string stem(const std::string &word) const = 0;
+};
+
+// Leaves words untouched; the index then matches whole words only
+class IdentityStemmer : public Stemmer
+{
+public:
+    const char *name() const override { return "none"; }
+    std::string stem(const std::string &word) const override { return word; }
+};
+
+// Suffix-stripping rules for Early Modern English (KJV): handles -eth, -est,
+// -edst alongside the modern -s, -ed, -ing, plus common irregular verbs
+// ("hath", "saith", "spake").
+class ArchaicEnglishStemmer : public Stemmer
+{
+public:
+    const char *name() const override { return "archaic-english"; }
+    std::string stem(const std::string &word) const override;
+};
+
+// Create a stemmer by name; returns nullptr for unknown names
+std::unique_ptr<Stemmer> createStemmer(const std::string &name);
+
+#endif
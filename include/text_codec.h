@@ -0,0 +1,51 @@
+#ifndef TEXT_CODEC_H
+#define TEXT_CODEC_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Static symbol-table compressor in the style of FSST. Up to 255 symbols of
+// 1-8 bytes are trained on a sample of the text; each symbol is written as
+// a single code byte, and bytes not covered by any symbol are escaped.
+// Decoding is a table lookup and copy per code, so small blocks can be
+// decompressed independently in microseconds.
+class SymbolTable
+{
+private:
+    static const int maxSymbols = 255;
+    static const unsigned char escapeCode = 255;
+
+    struct Symbol
+    {
+        char bytes[8];
+        uint8_t length;
+    };
+
+    std::vector<Symbol> symbols;
+    std::vector<uint8_t> byFirstByte[256]; // Codes starting with each byte, longest first
+
+    void buildIndex();
+
+    // Longest symbol matching text at position; returns -1 if none
+    int match(const char *text, size_t remaining) const;
+
+public:
+    // Learn a symbol table from sample strings
+    void train(const std::vector<const std::string *> &samples);
+
+    std::string encode(const std::string &text) const;
+
+    // Decode bytes produced by encode(), appending to out
+    void decode(const char *data, size_t length, std::string &out) const;
+
+    std::string serialize() const;
+    bool deserialize(const std::string &data);
+
+    bool empty() const { return symbols.empty(); }
+
+    // Bytes held by the table and its lookup index
+    size_t memoryBytes() const;
+};
+
+#endif
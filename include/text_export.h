@@ -0,0 +1,61 @@
+#ifndef TEXT_EXPORT_H
+#define TEXT_EXPORT_H
+
+#include <sqlite3.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class ExportFormat
+{
+    Text, // "Genesis 1:1 In the beginning..."
+    Csv,  // Same columns as the import format
+    Json  // One object per verse inside an array
+};
+
+bool parseExportFormat(const std::string &name, ExportFormat &format);
+
+// Large reusable output buffer over a file descriptor. Small pieces are
+// copied in; a piece too big to be worth copying goes out in the same
+// writev as the buffered bytes. Write errors stick until checked with ok().
+class OutputBuffer
+{
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t used = 0;
+    size_t written = 0;
+    bool failed = false;
+
+    void writeAll(const char *head, size_t headLength, const char *tail, size_t tailLength);
+
+public:
+    explicit OutputBuffer(int descriptor, size_t capacity = 1 << 20) : fd(descriptor), buffer(capacity) {}
+    ~OutputBuffer() { flush(); }
+
+    OutputBuffer(const OutputBuffer &) = delete;
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    void append(const char *data, size_t length);
+    void append(char c)
+    {
+        if (used == buffer.size())
+            flush();
+        buffer[used++] = c;
+    }
+    void appendInt(long long value);
+
+    bool flush();
+    bool ok() const { return !failed; }
+    size_t bytesWritten() const { return written + used; }
+};
+
+// Append text as a quoted JSON string, escaping quotes, backslashes and control characters
+void appendJsonString(OutputBuffer &out, const char *text, size_t length);
+
+// Stream the verses with ids firstId..lastId from the database cursor into
+// out, formatting each row as it is stepped so nothing is held in memory.
+// Returns the number of verses written, or -1 on a database error.
+long exportVerses(sqlite3 *db, int firstId, int lastId, ExportFormat format, OutputBuffer &out);
+
+#endif
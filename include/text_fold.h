@@ -0,0 +1,45 @@
+#ifndef TEXT_FOLD_H
+#define TEXT_FOLD_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Records a character whose folded form has a different byte length than
+// the original (e.g. "ü" -> "u", "ß" -> "ss"). Between anchors folded and
+// original offsets differ by a constant, so only these need to be stored.
+struct FoldAnchor
+{
+    uint32_t folded;        // Offset of the character in the folded text
+    uint32_t original;      // Offset of the character in the original text
+    uint8_t foldedLength;   // Bytes the character occupies in the folded text
+    uint8_t originalLength; // Bytes the character occupies in the original text
+};
+
+typedef std::vector<FoldAnchor> FoldMap;
+
+struct FoldOptions
+{
+    bool stripDiacritics = true;
+};
+
+// Case-fold and normalize UTF-8 text for matching: lower-cases Latin, Greek
+// and Cyrillic, expands ligatures and sharp s, maps compatibility spaces and,
+// optionally, strips accents and combining marks. Fills map when given.
+std::string foldText(const std::string &text, const FoldOptions &options, FoldMap *map = nullptr);
+
+// Fold the literal characters of a regular expression, including those
+// written as \xHH or \uHHHH and the members of character classes, leaving
+// escape sequences such as \b and \W intact. Characters folding to several
+// bytes are grouped, so "ß?" becomes "(?:ss)?".
+std::string foldPattern(const std::string &pattern, const FoldOptions &options);
+
+// Map a [begin, end) range in folded text back to the original text.
+// Ranges that cut through a folded character are widened to cover it.
+void mapFoldedRange(const FoldMap &map, size_t &begin, size_t &end);
+
+// Compact byte encoding of a fold map, for storing next to the text
+std::string encodeFoldMap(const FoldMap &map);
+FoldMap decodeFoldMap(const void *data, size_t bytes);
+
+#endif
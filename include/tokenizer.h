@@ -0,0 +1,12 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <string>
+#include <vector>
+
+// Split folded text into words. Letters, digits and any non-ASCII byte are
+// word characters; an apostrophe is kept when it sits between two of them
+// ("lord's"). Everything else separates words.
+std::vector<std::string> tokenize(const std::string &folded);
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef TRANSLATION_STORE_H
+#define TRANSLATION_STORE_H
+
+#include "memory_budget.h"
+#include "text_codec.h"
+#include <sqlite3.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Translations held side by side. Every translation is one column of text
+// indexed by canonical verse id (the id of the verse in the base 'bible'
+// table), so aligned verses are found by direct lookup with no joins.
+//
+// Columns are kept compressed in chapter-sized blocks, each translation with
+// its own trained SymbolTable. Reading a verse decompresses only its block,
+// and recently used blocks are kept decoded in a small LRU cache. Both the
+// compressed columns and the decoded blocks report to a MemoryBudget; an
+// evicted column is reloaded the next time one of its verses is read.
+class TranslationStore : public BudgetedCache
+{
+private:
+    struct TextBlock
+    {
+        int firstId;     // Canonical id of the first verse in the block
+        int verseCount;  // Consecutive ids covered by the block
+        std::string data;
+    };
+
+    struct Column
+    {
+        std::string code;
+        bool loaded = false;
+        SymbolTable table;
+        std::vector<TextBlock> blocks; // Sorted by firstId
+        size_t rawBytes = 0;
+        size_t bytes = 0;      // Memory held while loaded
+        double priority = 0.0; // Eviction rank in the memory budget
+    };
+
+    typedef std::pair<size_t, size_t> BlockKey; // (column, block index)
+
+    sqlite3 *db = nullptr;
+    std::vector<Column> columns; // Column 0 is the base text
+    LruCache<BlockKey, std::vector<std::string>> decoded;
+    MemoryBudget *budget = nullptr;
+
+    const std::vector<std::string> &decodedBlock(size_t column, size_t block);
+
+public:
+    TranslationStore();
+
+    // Read the list of translations; the base text becomes column 0
+    bool open(sqlite3 *database);
+
+    // Account compressed columns and decoded blocks in a budget
+    void attach(MemoryBudget *memoryBudget);
+
+    size_t count() const { return columns.size(); }
+
+    const std::string &code(size_t column) const { return columns[column].code; }
+
+    // Make sure a column's blocks are in memory
+    bool load(size_t column);
+
+    // Drop a column's blocks; text() loads them again on demand
+    void unload(size_t column);
+
+    // Text of a verse in a translation, empty if that translation lacks it
+    std::string text(size_t column, int verseId);
+
+    // Uncompressed and compressed sizes of a loaded column
+    size_t rawBytes(size_t column) const { return columns[column].rawBytes; }
+    size_t compressedBytes(size_t column) const;
+
+    const char *cacheName() const override { return "compressed text"; }
+    size_t bytesUsed() const override;
+    size_t entryCount() const override;
+    bool evictable() const override { return true; }
+    double oldestPriority() const override;
+    size_t evictOldest() override;
+
+    // Split texts indexed by canonical id into compressed chapter blocks
+    static void buildBlocks(sqlite3 *db, const std::vector<std::string> &texts, SymbolTable &table,
+                            std::vector<std::pair<int, std::string>> &blocks);
+};
+
+// Replace a translation's raw rows with a trained dictionary and compressed
+// chapter blocks (codec_dictionaries, text_blocks). The raw rows replace the
+// blocks written earlier; with no raw rows the stored text is re-encoded.
+bool compactTranslation(sqlite3 *db, const std::string &code, size_t &rawBytes, size_t &compressedBytes);
+
+// A translation's dictionary and blocks, ready to be written
+struct CompactedTranslation
+{
+    std::string code;
+    std::string symbols;
+    std::vector<std::pair<int, std::string>> blocks; // (first canonical id, data)
+    std::vector<int> counts;                         // Verses per block
+    std::vector<std::pair<int, uint64_t>> hashes;    // (first canonical id, content hash) to store
+    bool incremental = false; // Blocks are only the changed chapters, under the stored dictionary
+    size_t rawBytes = 0;
+    size_t compressedBytes = 0;
+    size_t chapters = 0;
+    size_t changedChapters = 0;
+    size_t changedVerses = 0;
+};
+
+// The two halves of compactTranslation. Preparing only reads, so it can run
+// on any connection (a worker's own, during a bulk import). The new text is
+// the pending raw rows plus rows given as (canonical id, text), so verses
+// the import no longer has are dropped. Chapters are compared with their
+// stored content hashes, and when few changed only those are re-encoded. Writing belongs in the caller's transaction on the writer
+// connection.
+bool prepareCompaction(sqlite3 *db, const std::string &code, const std::vector<std::pair<int, std::string>> &rows,
+                       CompactedTranslation &compacted);
+bool writeCompaction(sqlite3 *db, const CompactedTranslation &compacted);
+
+// Maps a translation's own (book, chapter, verse) to a canonical verse id,
+// applying the translation's entries in the versification table first.
+class CanonicalResolver
+{
+private:
+    sqlite3_stmt *selectMapping = nullptr;
+    sqlite3_stmt *selectVerse = nullptr;
+    std::string translation;
+
+public:
+    bool open(sqlite3 *db, const std::string &translationCode);
+
+    // Canonical verse id, or -1 if the verse has no counterpart in the base text
+    int resolve(const std::string &book, int chapter, int verse);
+
+    void close();
+
+    ~CanonicalResolver();
+};
+
+#endif
@@ -6,8 +6,6 @@
 #include <iostream>
 #include <sstream>
 
-std::vector<std::string> reorderVector(const std::vector<std::string> &matrix, int rows, int cols);
-
 void printMultilineAscii(int start_y, int start_x, const std::string &asciiArt);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef VERSE_INDEX_H
+#define VERSE_INDEX_H
+
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+
+// A verse reference in canonical order; book is an index into the book list
+struct VersePosition
+{
+    int book = 0;
+    int chapter = 1;
+    int verse = 1;
+};
+
+// Index of the first New Testament book in a list of books in canonical
+// order. The New Testament is the last 27 books of a whole Bible whatever
+// the Old Testament canon (39 books, or more with the deuterocanon); a list
+// no longer than the 39-book Old Testament has no New Testament and the
+// result is bookCount.
+size_t firstNewTestamentBook(size_t bookCount);
+
+// Flat prefix-sum tables from (book, chapter, verse) to an absolute verse
+// number and back. Each book's chapters and each chapter's verses occupy a
+// contiguous range, so converting either way, stepping across chapter and
+// book boundaries and computing progress are array lookups, not queries.
+class VerseIndex
+{
+private:
+    std::vector<std::string> bookNames;
+    std::vector<int> bookChapterStart; // First chapter slot of each book, plus an end marker
+    std::vector<int> chapterStart;     // First absolute verse of each chapter slot, plus an end marker
+    std::vector<int> chapterBook;      // Book of each chapter slot
+    std::vector<int> verseChapter;     // Chapter slot of each absolute verse
+
+public:
+    // Build the tables from the 'bible' table in one pass
+    bool load(sqlite3 *db);
+
+    size_t bookCount() const { return bookNames.size(); }
+    const std::string &bookName(int book) const { return bookNames[book]; }
+    int chapterCount(int book) const { return bookChapterStart[book + 1] - bookChapterStart[book]; }
+    int verseCount(int book, int chapter) const;
+    int totalVerses() const { return chapterStart.empty() ? 0 : chapterStart.back(); }
+
+    // Heap bytes held by the tables
+    size_t memoryBytes() const;
+
+    // Absolute verse number (0-based), or -1 if the reference is out of range
+    int absolute(const VersePosition &position) const;
+
+    VersePosition position(int absolute) const;
+
+    // First verse of the next or previous chapter, crossing into other books;
+    // returns false at either end of the Bible
+    bool adjacentChapter(const VersePosition &from, int step, VersePosition &to) const;
+
+    // "Book chapter:verse"
+    std::string reference(const VersePosition &position) const;
+
+    // Share of the Bible before this verse, 0-100
+    double percent(const VersePosition &position) const;
+
+    // Book from a name or abbreviation such as "Rev", "Ps", "1 Cor" or "Jn"; -1 if unknown
+    int findBook(const std::string &name) const;
+
+    // Parse "Rev 22:3", "Ps 119:105", "John 3" or "Jude 5" into a position in range
+    bool parseReference(const std::string &text, VersePosition &position) const;
+
+    // Parse an inclusive range such as "Gen 1 - Deut 34", "John 3:16-18",
+    // "Ps 23" or "Ruth". An end given as a book or chapter runs to its last verse.
+    bool parseRange(const std::string &text, VersePosition &first, VersePosition &last) const;
+
+private:
+    // How much of a reference was given: book only, book and chapter, or a verse
+    enum Precision
+    {
+        BookOnly,
+        ChapterOnly,
+        FullVerse
+    };
+
+    // Split "<book> <chapter>[:<verse>]" into numbers; book may be empty when
+    // it is carried over from the start of a range
+    bool parseParts(const std::string &text, std::string &book, int &chapter, int &verse, Precision &precision) const;
+
+    // Position of a parsed reference; toEnd picks the last verse it covers
+    bool resolve(int book, int chapter, int verse, Precision precision, bool toEnd, VersePosition &position) const;
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef VIEWER_H
+#define VIEWER_H
+
+#include "corpus_store.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+
+// Settings of the view command
+struct ViewerOptions
+{
+    size_t memoryBudget = 0; // Byte cap over the caches; zero leaves them unbounded
+    StoreBackend storeBackend = StoreBackend::Sqlite;
+    bool restoreSession = true;
+    std::string startReference; // Opens here instead of the saved position
+    std::function<void()> firstPaint; // Called once the first frame is on screen
+    std::function<int()> keySource; // Keys for the main loop instead of the keyboard, as the bench scripts them
+};
+
+// Run the terminal viewer on a database until the user quits; false if the
+// database could not be opened
+bool runViewer(const std::string &dbPath, const ViewerOptions &options);
+
+#endif
@@ -0,0 +1,141 @@
+#include "../include/aho_corasick.h"
+#include <queue>
+#include <sstream>
+
+AhoCorasick::AhoCorasick()
+{
+    build({});
+}
+
+void AhoCorasick::build(const std::vector<std::string> &terms)
+{
+    // State 0 is the root; -1 marks a missing trie edge until failure links are resolved
+    transitions.assign(256, -1);
+    longest.assign(1, 0);
+
+    for (const auto &term : terms)
+    {
+        if (term.empty())
+            continue;
+
+        int state = 0;
+        for (char ch : term)
+        {
+            unsigned char c = static_cast<unsigned char>(ch);
+            int &next = transitions[state * 256 + c];
+            if (next == -1)
+            {
+                next = static_cast<int>(longest.size());
+                longest.push_back(0);
+                transitions.resize(transitions.size() + 256, -1);
+            }
+            state = transitions[state * 256 + c];
+        }
+
+        if (term.length() > longest[state])
+        {
+            longest[state] = term.length();
+        }
+    }
+
+    // Breadth-first pass turning the trie into a complete DFA
+    std::vector<int> failure(longest.size(), 0);
+    std::queue<int> pending;
+
+    for (int c = 0; c < 256; c++)
+    {
+        int &next = transitions[c];
+        if (next == -1)
+        {
+            next = 0;
+        }
+        else
+        {
+            failure[next] = 0;
+            pending.push(next);
+        }
+    }
+
+    while (!pending.empty())
+    {
+        int state = pending.front();
+        pending.pop();
+
+        // A state also reports whatever its failure state reports
+        if (longest[failure[state]] > longest[state])
+        {
+            longest[state] = longest[failure[state]];
+        }
+
+        for (int c = 0; c < 256; c++)
+        {
+            int &next = transitions[state * 256 + c];
+            int fallback = transitions[failure[state] * 256 + c];
+
+            if (next == -1)
+            {
+                next = fallback;
+            }
+            else
+            {
+                failure[next] = fallback;
+                pending.push(next);
+            }
+        }
+    }
+}
+
+std::vector<HitSpan> AhoCorasick::scan(const std::string &text) const
+{
+    std::vector<HitSpan> spans;
+    scan(text, spans);
+    return spans;
+}
+
+void AhoCorasick::scan(const std::string &text, std::vector<HitSpan> &spans) const
+{
+    if (empty())
+        return;
+
+    // Spans already in the vector belong to the caller and are never merged
+    size_t first = spans.size();
+
+    int state = 0;
+    for (size_t i = 0; i < text.length(); i++)
+    {
+        state = transitions[state * 256 + static_cast<unsigned char>(text[i])];
+
+        size_t length = longest[state];
+        if (length == 0)
+            continue;
+
+        size_t begin = i + 1 - length;
+        if (spans.size() > first && begin <= spans.back().end)
+        {
+            // Overlapping or touching the previous hit: extend it
+            spans.back().end = i + 1;
+            if (begin < spans.back().begin)
+            {
+                spans.back().begin = begin;
+            }
+        }
+        else
+        {
+            spans.push_back({begin, i + 1});
+        }
+    }
+}
+
+std::vector<std::string> splitQueryTerms(const std::string &query)
+{
+    std::vector<std::string> terms;
+    std::istringstream stream(query);
+    std::string term;
+
+    while (stream >> term)
+    {
+        terms.push_back(term);
+    }
+
+    return terms;
+}
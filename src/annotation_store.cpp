@@ -0,0 +1,220 @@
+#include "../include/annotation_store.h"
+#include "../include/memory_budget.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// Changes arriving this close together are written in one transaction
+static const std::chrono::milliseconds batchWindow(200);
+
+bool VerseBitmap::set(int id, bool value)
+{
+    if (id < 0 || test(id) == value)
+        return false;
+
+    size_t word = static_cast<size_t>(id) / 64;
+    if (word >= words.size())
+        words.resize(word + 1, 0);
+
+    words[word] ^= uint64_t(1) << (id % 64);
+    bitCount += value ? 1 : -1;
+    return true;
+}
+
+AnnotationStore::~AnnotationStore()
+{
+    if (writer.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        writer.join();
+    }
+
+    if (!writeError.empty())
+        std::cerr << "Error saving annotations: " << writeError << std::endl;
+}
+
+bool AnnotationStore::open(sqlite3 *db, const std::string &path)
+{
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT verse_id, kind, note FROM annotations", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        int verseId = sqlite3_column_int(stmt, 0);
+        int kind = sqlite3_column_int(stmt, 1);
+        if (kind < 0 || kind >= annotationKindCount)
+            continue;
+
+        bitmaps[kind].set(verseId, true);
+        if (kind == static_cast<int>(AnnotationKind::Note) && sqlite3_column_text(stmt, 2))
+            notes[verseId] = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
+    }
+
+    sqlite3_finalize(stmt);
+
+    dbPath = path;
+    writer = std::thread(&AnnotationStore::writerLoop, this);
+    return true;
+}
+
+bool AnnotationStore::toggle(AnnotationKind kind, int verseId)
+{
+    bool present = !has(kind, verseId);
+    bitmaps[static_cast<int>(kind)].set(verseId, present);
+    queue({verseId, kind, present, std::string()});
+    return present;
+}
+
+void AnnotationStore::setNote(int verseId, const std::string &text)
+{
+    bool present = !text.empty();
+    bitmaps[static_cast<int>(AnnotationKind::Note)].set(verseId, present);
+    if (present)
+        notes[verseId] = text;
+    else
+        notes.erase(verseId);
+
+    queue({verseId, AnnotationKind::Note, present, text});
+}
+
+const std::string &AnnotationStore::note(int verseId) const
+{
+    static const std::string none;
+    auto found = notes.find(verseId);
+    return found == notes.end() ? none : found->second;
+}
+
+std::vector<int> AnnotationStore::annotatedVerses() const
+{
+    std::vector<int> ids;
+
+    size_t wordCount = 0;
+    for (const auto &bitmap : bitmaps)
+        wordCount = std::max(wordCount, bitmap.data().size());
+
+    // Union the kinds a word at a time and walk the set bits
+    for (size_t word = 0; word < wordCount; word++)
+    {
+        uint64_t bits = 0;
+        for (const auto &bitmap : bitmaps)
+        {
+            if (word < bitmap.data().size())
+                bits |= bitmap.data()[word];
+        }
+
+        while (bits)
+        {
+            ids.push_back(static_cast<int>(word * 64 + __builtin_ctzll(bits)));
+            bits &= bits - 1;
+        }
+    }
+
+    return ids;
+}
+
+size_t AnnotationStore::memoryBytes() const
+{
+    size_t total = 0;
+    for (const auto &bitmap : bitmaps)
+        total += bitmap.memoryBytes();
+
+    // Map nodes: three pointers, a colour and the key/value pair
+    for (const auto &entry : notes)
+        total += 4 * sizeof(void *) + sizeof(entry) + heapBytes(entry.second);
+    return total;
+}
+
+void AnnotationStore::queue(Change change)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::move(change));
+    }
+    wake.notify_all();
+}
+
+void AnnotationStore::writerLoop()
+{
+    sqlite3 *db = nullptr;
+    std::vector<Change> batch;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this]()
+                  { return !pending.empty() || stopping; });
+        if (pending.empty())
+            break;
+
+        // Give a burst of keypresses time to arrive, unless shutting down
+        wake.wait_for(lock, batchWindow, [this]()
+                      { return stopping; });
+
+        batch.swap(pending);
+        lock.unlock();
+
+        if (!db && sqlite3_open(dbPath.c_str(), &db) == SQLITE_OK)
+            sqlite3_busy_timeout(db, 5000);
+
+        std::string error = db ? std::string() : "cannot open " + dbPath;
+        bool written = db && writeBatch(db, batch, error);
+        batch.clear();
+
+        lock.lock();
+        if (!written && writeError.empty())
+            writeError = error;
+    }
+
+    lock.unlock();
+    sqlite3_close(db);
+}
+
+bool AnnotationStore::writeBatch(sqlite3 *db, const std::vector<Change> &batch, std::string &error)
+{
+    sqlite3_stmt *insert = nullptr;
+    sqlite3_stmt *remove = nullptr;
+
+    bool ok = sqlite3_exec(db, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) == SQLITE_OK;
+    ok = ok && sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO annotations (verse_id, kind, note) VALUES (?, ?, ?)", -1, &insert, nullptr) == SQLITE_OK;
+    ok = ok && sqlite3_prepare_v2(db, "DELETE FROM annotations WHERE verse_id = ? AND kind = ?", -1, &remove, nullptr) == SQLITE_OK;
+
+    // Applied in order, so the last change to a verse wins
+    for (size_t i = 0; ok && i < batch.size(); i++)
+    {
+        const Change &change = batch[i];
+        sqlite3_stmt *stmt = change.present ? insert : remove;
+
+        sqlite3_bind_int(stmt, 1, change.verseId);
+        sqlite3_bind_int(stmt, 2, static_cast<int>(change.kind));
+        if (change.present)
+        {
+            if (change.note.empty())
+                sqlite3_bind_null(stmt, 3);
+            else
+                sqlite3_bind_text(stmt, 3, change.note.c_str(), -1, SQLITE_STATIC);
+        }
+
+        ok = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_reset(stmt);
+    }
+
+    sqlite3_finalize(insert);
+    sqlite3_finalize(remove);
+
+    if (ok)
+        ok = sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr) == SQLITE_OK;
+    if (!ok)
+    {
+        error = sqlite3_errmsg(db);
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+    }
+    return ok;
+}
@@ -0,0 +1,55 @@
+#include "../include/arena.h"
+#include <cstring>
+
+Arena::Arena(size_t blockSize) : blockSize(blockSize)
+{
+}
+
+void *Arena::allocate(size_t bytes, size_t alignment)
+{
+    while (currentBlock < blocks.size())
+    {
+        size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+        if (aligned + bytes <= blockSizes[currentBlock])
+        {
+            offset = aligned + bytes;
+            used += bytes;
+            return blocks[currentBlock].get() + aligned;
+        }
+
+        // Move on to the next block kept from before a reset, if any
+        currentBlock++;
+        offset = 0;
+    }
+
+    // Oversized requests get a block of their own
+    size_t size = bytes + alignment > blockSize ? bytes + alignment : blockSize;
+    blocks.emplace_back(new char[size]);
+    blockSizes.push_back(size);
+    currentBlock = blocks.size() - 1;
+    offset = 0;
+
+    return allocate(bytes, alignment);
+}
+
+const char *Arena::copy(const char *data, size_t length)
+{
+    char *destination = static_cast<char *>(allocate(length, 1));
+    std::memcpy(destination, data, length);
+    return destination;
+}
+
+void Arena::reset()
+{
+    currentBlock = 0;
+    offset = 0;
+    used = 0;
+}
+
+size_t Arena::bytesReserved() const
+{
+    size_t total = 0;
+    for (size_t size : blockSizes)
+        total += size;
+    return total;
+}
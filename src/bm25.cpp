@@ -0,0 +1,258 @@
+#include "../include/bm25.h"
+#include "../include/parallel.h"
+#include "../include/tokenizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <queue>
+#include <set>
+
+namespace
+{
+    // Position in one term's posting list plus what WAND needs to know about the term
+    struct Cursor
+    {
+        const std::vector<Posting> *postings;
+        size_t position;
+        size_t end;
+        double idf;
+        double upperBound; // No verse can get more than this from the term
+
+        int doc() const { return position < end ? (*postings)[position].verseId : INT32_MAX; }
+
+        // Move to the first posting with verseId >= target, galloping forward
+        void advanceTo(int target)
+        {
+            size_t step = 1;
+            size_t low = position;
+            while (position < end && (*postings)[position].verseId < target)
+            {
+                low = position;
+                position = std::min(end, position + step);
+                step *= 2;
+            }
+
+            auto it = std::lower_bound(postings->begin() + low, postings->begin() + position, target,
+                                       [](const Posting &p, int id)
+                                       { return p.verseId < id; });
+            position = it - postings->begin();
+        }
+    };
+
+    struct ByScore
+    {
+        bool operator()(const ScoredVerse &a, const ScoredVerse &c) const { return a.score > c.score; }
+    };
+
+    typedef std::priority_queue<ScoredVerse, std::vector<ScoredVerse>, ByScore> TopKHeap;
+}
+
+bool Bm25Ranker::load(sqlite3 *db)
+{
+    docLengths.clear();
+    docCount = 0;
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT id, word_count FROM bible ORDER BY id", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    long long total = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        int id = sqlite3_column_int(stmt, 0);
+        int length = sqlite3_column_int(stmt, 1);
+
+        if (id >= static_cast<int>(docLengths.size()))
+            docLengths.resize(id + 1, 0);
+
+        docLengths[id] = length;
+        total += length;
+        docCount++;
+    }
+
+    sqlite3_finalize(stmt);
+    averageLength = docCount ? static_cast<double>(total) / docCount : 0.0;
+    return true;
+}
+
+std::vector<Posting> Bm25Ranker::readPostings(sqlite3 *db, const std::string &stem)
+{
+    std::vector<Posting> postings;
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, "SELECT verse_id, tf FROM stem_postings WHERE stem = ? ORDER BY verse_id", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return postings;
+    }
+
+    sqlite3_bind_text(stmt, 1, stem.c_str(), stem.length(), SQLITE_STATIC);
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        postings.push_back({sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1)});
+    }
+
+    sqlite3_finalize(stmt);
+    return postings;
+}
+
+std::vector<ScoredVerse> Bm25Ranker::topK(const std::vector<std::vector<Posting>> &terms, size_t k) const
+{
+    std::vector<ScoredVerse> results;
+
+    if (k == 0 || docCount == 0 || terms.empty())
+        return results;
+
+    int shortest = INT32_MAX;
+    for (size_t id = 1; id < docLengths.size(); id++)
+    {
+        if (docLengths[id] > 0)
+            shortest = std::min(shortest, docLengths[id]);
+    }
+
+    // Per-term idf and an upper bound from its highest tf over the shortest verse
+    std::vector<double> idfs;
+    std::vector<double> bounds;
+    for (const auto &postings : terms)
+    {
+        double df = static_cast<double>(postings.size());
+        double idf = std::log(1.0 + (docCount - df + 0.5) / (df + 0.5));
+
+        int maxTf = 0;
+        for (const auto &posting : postings)
+            maxTf = std::max(maxTf, posting.tf);
+
+        double norm = k1 * (1.0 - b + b * shortest / averageLength);
+        idfs.push_back(idf);
+        bounds.push_back(idf * maxTf * (k1 + 1.0) / (maxTf + norm));
+    }
+
+    size_t shards = workerCount();
+    std::vector<std::vector<ScoredVerse>> shardResults(shards);
+    int maxId = static_cast<int>(docLengths.size());
+
+    parallelFor(static_cast<size_t>(maxId), [&](size_t begin, size_t end, size_t shard)
+                {
+                    std::vector<Cursor> cursors;
+                    for (size_t t = 0; t < terms.size(); t++)
+                    {
+                        const auto &postings = terms[t];
+                        auto first = std::lower_bound(postings.begin(), postings.end(), static_cast<int>(begin),
+                                                      [](const Posting &p, int id)
+                                                      { return p.verseId < id; });
+                        auto last = std::lower_bound(first, postings.end(), static_cast<int>(end),
+                                                     [](const Posting &p, int id)
+                                                     { return p.verseId < id; });
+
+                        if (first != last)
+                        {
+                            cursors.push_back({&postings, static_cast<size_t>(first - postings.begin()),
+                                               static_cast<size_t>(last - postings.begin()), idfs[t], bounds[t]});
+                        }
+                    }
+
+                    TopKHeap heap;
+
+                    while (true)
+                    {
+                        std::sort(cursors.begin(), cursors.end(), [](const Cursor &x, const Cursor &y)
+                                  { return x.doc() < y.doc(); });
+
+                        // Find the pivot: the first verse whose terms could beat the heap's minimum
+                        double threshold = heap.size() < k ? -1.0 : heap.top().score;
+                        double bound = 0.0;
+                        size_t pivot = cursors.size();
+                        for (size_t i = 0; i < cursors.size() && cursors[i].doc() != INT32_MAX; i++)
+                        {
+                            bound += cursors[i].upperBound;
+                            if (bound > threshold)
+                            {
+                                pivot = i;
+                                break;
+                            }
+                        }
+
+                        if (pivot == cursors.size())
+                            break;
+
+                        int pivotDoc = cursors[pivot].doc();
+
+                        if (cursors[0].doc() == pivotDoc)
+                        {
+                            // Every term up to the pivot sits on this verse: score it
+                            double length = docLengths[pivotDoc];
+                            double norm = k1 * (1.0 - b + b * length / averageLength);
+                            double score = 0.0;
+
+                            for (auto &cursor : cursors)
+                            {
+                                if (cursor.doc() != pivotDoc)
+                                    break;
+
+                                double tf = (*cursor.postings)[cursor.position].tf;
+                                score += cursor.idf * tf * (k1 + 1.0) / (tf + norm);
+                                cursor.position++;
+                            }
+
+                            if (heap.size() < k)
+                            {
+                                heap.push({pivotDoc, score});
+                            }
+                            else if (score > heap.top().score)
+                            {
+                                heap.pop();
+                                heap.push({pivotDoc, score});
+                            }
+                        }
+                        else
+                        {
+                            // Verses before the pivot can't make the cut; skip them
+                            for (size_t i = 0; i < pivot; i++)
+                            {
+                                cursors[i].advanceTo(pivotDoc);
+                            }
+                        }
+                    }
+
+                    std::vector<ScoredVerse> &local = shardResults[shard];
+                    while (!heap.empty())
+                    {
+                        local.push_back(heap.top());
+                        heap.pop();
+                    } },
+                shards);
+
+    for (const auto &local : shardResults)
+    {
+        results.insert(results.end(), local.begin(), local.end());
+    }
+
+    std::sort(results.begin(), results.end(), [](const ScoredVerse &x, const ScoredVerse &y)
+              { return x.score != y.score ? x.score > y.score : x.verseId < y.verseId; });
+
+    if (results.size() > k)
+        results.resize(k);
+
+    return results;
+}
+
+std::vector<ScoredVerse> Bm25Ranker::search(sqlite3 *db, const Stemmer &stemmer, const std::string &foldedQuery, size_t k) const
+{
+    std::set<std::string> stems;
+    for (const auto &word : tokenize(foldedQuery))
+    {
+        stems.insert(stemmer.stem(word));
+    }
+
+    std::vector<std::vector<Posting>> terms;
+    for (const auto &stem : stems)
+    {
+        terms.push_back(readPostings(db, stem));
+    }
+
+    return topK(terms, k);
+}
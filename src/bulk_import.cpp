@@ -0,0 +1,261 @@
+#include "../include/bulk_import.h"
+#include "../include/csv_reader.h"
+#include "../include/schema.h"
+#include "../include/translation_store.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+std::string translationCodeFor(const std::string &csvPath)
+{
+    size_t slash = csvPath.find_last_of('/');
+    std::string name = slash == std::string::npos ? csvPath : csvPath.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+// Finished work waiting for the writer, bounded so fast workers can't pile
+// up compressed translations faster than they are committed
+class CompactionQueue
+{
+private:
+    struct Item
+    {
+        size_t job;
+        CompactedTranslation compacted;
+    };
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Item> items;
+    size_t capacity;
+    size_t producers;
+
+public:
+    CompactionQueue(size_t maxItems, size_t producerCount) : capacity(std::max<size_t>(1, maxItems)), producers(producerCount) {}
+
+    void push(size_t job, CompactedTranslation compacted)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]()
+                     { return items.size() < capacity; });
+        items.push_back({job, std::move(compacted)});
+        changed.notify_all();
+    }
+
+    void producerDone()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        producers--;
+        changed.notify_all();
+    }
+
+    // Everything ready, waiting for at least one item; empty once all
+    // producers are done and the queue is drained
+    std::vector<Item> popAll()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]()
+                     { return !items.empty() || producers == 0; });
+
+        std::vector<Item> ready(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+        items.clear();
+        changed.notify_all();
+        return ready;
+    }
+};
+
+// Parse one CSV into (canonical id, text) rows using a worker's connection
+static bool parseTranslation(sqlite3 *db, TranslationImport &import, std::vector<std::pair<int, std::string>> &rows)
+{
+    CanonicalResolver resolver;
+    if (!resolver.open(db, import.code))
+        return false;
+
+    CsvReader csv;
+    if (!csv.open(import.csvPath))
+    {
+        std::cerr << "Error opening CSV file: " << import.csvPath << std::endl;
+        return false;
+    }
+
+    // Skip header line
+    if (!csv.next())
+    {
+        std::cerr << "Error reading CSV file or file is empty: " << import.csvPath << std::endl;
+        return false;
+    }
+
+    while (csv.next())
+    {
+        int chapter, verse;
+        if (csv.fieldCount() < 4 || !csv.integer(1, chapter) || !csv.integer(2, verse))
+            continue;
+
+        int verseId = resolver.resolve(csv.field(0), chapter, verse);
+        if (verseId < 0)
+        {
+            import.unmatched++;
+            continue;
+        }
+
+        rows.push_back({verseId, csv.field(3)});
+    }
+
+    import.csvBytes = csv.bytesRead();
+    import.verses = rows.size();
+    return true;
+}
+
+// Worker loop: take the next file, build its compressed form, hand it over
+static void importWorker(const std::string &dbPath, std::vector<TranslationImport> &imports,
+                         std::atomic<size_t> &next, CompactionQueue &queue)
+{
+    sqlite3 *db = nullptr;
+    bool opened = sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK;
+    if (!opened)
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+    else
+        sqlite3_busy_timeout(db, 5000);
+
+    for (size_t job = next++; opened && job < imports.size(); job = next++)
+    {
+        TranslationImport &import = imports[job];
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::pair<int, std::string>> rows;
+        CompactedTranslation compacted;
+        if (!parseTranslation(db, import, rows) || !prepareCompaction(db, import.code, rows, compacted))
+            continue;
+
+        import.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        queue.push(job, std::move(compacted));
+    }
+
+    sqlite3_close(db);
+    queue.producerDone();
+}
+
+// Commit a batch of finished translations in one transaction
+static bool writeBatch(sqlite3 *db, std::vector<TranslationImport> &imports, const std::vector<size_t> &jobs,
+                       const std::vector<const CompactedTranslation *> &batch)
+{
+    char *errMsg = nullptr;
+    if (sqlite3_exec(db, "BEGIN IMMEDIATE;", nullptr, nullptr, &errMsg) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+
+    sqlite3_stmt *registerStmt;
+    if (sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO translations (code, name) VALUES (?, ?)", -1, &registerStmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+
+    bool ok = true;
+    for (size_t i = 0; ok && i < batch.size(); i++)
+    {
+        const std::string &code = batch[i]->code;
+        sqlite3_bind_text(registerStmt, 1, code.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(registerStmt, 2, code.c_str(), -1, SQLITE_STATIC);
+        ok = sqlite3_step(registerStmt) == SQLITE_DONE && writeCompaction(db, *batch[i]);
+        sqlite3_reset(registerStmt);
+    }
+    sqlite3_finalize(registerStmt);
+
+    if (!ok || sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        TranslationImport &import = imports[jobs[i]];
+        import.rawBytes = batch[i]->rawBytes;
+        import.compressedBytes = batch[i]->compressedBytes;
+        import.chapters = batch[i]->chapters;
+        import.changedChapters = batch[i]->changedChapters;
+        import.changedVerses = batch[i]->changedVerses;
+        import.incremental = batch[i]->incremental;
+        import.ok = true;
+    }
+    return true;
+}
+
+bool importTranslations(const std::string &dbPath, std::vector<TranslationImport> &imports, size_t workers)
+{
+    // Two workers writing the same translation would overwrite each other
+    for (size_t i = 0; i < imports.size(); i++)
+    {
+        for (size_t j = 0; j < i; j++)
+        {
+            if (imports[i].code == imports[j].code)
+            {
+                std::cerr << "Translation " << imports[i].code << " is listed twice." << std::endl;
+                return false;
+            }
+        }
+    }
+
+    sqlite3 *db;
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK)
+    {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+    sqlite3_busy_timeout(db, 5000);
+
+    // WAL lets readers keep their snapshot while the writer commits;
+    // NORMAL sync is still durable at each checkpoint in WAL mode
+    if (!ensureSchema(db) ||
+        sqlite3_exec(db, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    workers = std::max<size_t>(1, std::min(workers, imports.size()));
+    CompactionQueue queue(workers, workers);
+    std::atomic<size_t> next(0);
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < workers; i++)
+        threads.emplace_back(importWorker, std::cref(dbPath), std::ref(imports), std::ref(next), std::ref(queue));
+
+    // Whatever has finished since the last commit goes into the next one
+    bool ok = true;
+    for (auto ready = queue.popAll(); !ready.empty(); ready = queue.popAll())
+    {
+        std::vector<size_t> jobs;
+        std::vector<const CompactedTranslation *> batch;
+        for (const auto &item : ready)
+        {
+            jobs.push_back(item.job);
+            batch.push_back(&item.compacted);
+        }
+        ok = writeBatch(db, imports, jobs, batch) && ok;
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    sqlite3_close(db);
+
+    for (const auto &import : imports)
+        ok = ok && import.ok;
+    return ok;
+}
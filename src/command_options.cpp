@@ -0,0 +1,77 @@
+#include "../include/command_options.h"
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+
+void CommandOptions::flag(const std::string &name, std::function<void()> apply)
+{
+    options.push_back({name, false, [apply](const std::string &)
+                       {
+                           apply();
+                           return true;
+                       }});
+}
+
+void CommandOptions::value(const std::string &name, std::function<bool(const std::string &)> apply)
+{
+    options.push_back({name, true, std::move(apply)});
+}
+
+bool CommandOptions::parse(int argc, char *argv[], int first)
+{
+    for (int i = first; i < argc; i++)
+    {
+        std::string argument = argv[i];
+
+        const Option *option = nullptr;
+        for (const Option &candidate : options)
+        {
+            if (candidate.name == argument)
+                option = &candidate;
+        }
+
+        if (!option)
+        {
+            if (allowPositional && argument.compare(0, 2, "--") != 0)
+            {
+                positional.push_back(argument);
+                continue;
+            }
+            std::cout << "Error: Unknown option: " << argument << std::endl;
+            return false;
+        }
+
+        // A value can't be another option, so '--out --format csv' is caught
+        std::string value;
+        if (option->takesValue)
+        {
+            if (i + 1 >= argc || std::string(argv[i + 1]).compare(0, 2, "--") == 0)
+            {
+                std::cout << "Error: Missing value for option: " << argument << std::endl;
+                return false;
+            }
+            value = argv[++i];
+        }
+
+        if (!option->apply(value))
+        {
+            std::cout << "Error: Invalid value for option " << argument << ": " << value << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool parseCount(const std::string &text, size_t &count)
+{
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+
+    errno = 0;
+    unsigned long long parsed = std::strtoull(text.c_str(), nullptr, 10);
+    if (errno == ERANGE)
+        return false;
+    count = static_cast<size_t>(parsed);
+    return true;
+}
@@ -0,0 +1,493 @@
+#include "../include/concordance.h"
+#include "../include/arena.h"
+#include "../include/parallel.h"
+#include "../include/text_fold.h"
+#include "../include/tokenizer.h"
+#include "../include/verse_index.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+    uint64_t hashBytes(const char *data, size_t length)
+    {
+        // FNV-1a
+        uint64_t hash = 1469598103934665603ULL;
+        for (size_t i = 0; i < length; i++)
+        {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    uint64_t hashKey(uint64_t key)
+    {
+        // splitmix64 finalizer
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebULL;
+        key ^= key >> 31;
+        return key;
+    }
+
+    // Open-addressing string -> dense id table. Keys are copied into an arena
+    // so the table itself only holds pointers.
+    class WordTable
+    {
+    private:
+        struct Slot
+        {
+            const char *key = nullptr;
+            uint32_t length = 0;
+            uint32_t id = 0;
+        };
+
+        std::vector<Slot> slots;
+        Arena arena;
+
+        void grow()
+        {
+            std::vector<Slot> old(slots.size() * 2);
+            old.swap(slots);
+            size_t mask = slots.size() - 1;
+
+            for (const auto &slot : old)
+            {
+                if (!slot.key)
+                    continue;
+
+                size_t index = hashBytes(slot.key, slot.length) & mask;
+                while (slots[index].key)
+                    index = (index + 1) & mask;
+                slots[index] = slot;
+            }
+        }
+
+    public:
+        std::vector<std::string_view> words; // Indexed by id
+
+        WordTable() : slots(1024) {}
+
+        uint32_t intern(std::string_view word)
+        {
+            if ((words.size() + 1) * 2 > slots.size())
+                grow();
+
+            size_t mask = slots.size() - 1;
+            size_t index = hashBytes(word.data(), word.length()) & mask;
+
+            while (slots[index].key)
+            {
+                const Slot &slot = slots[index];
+                if (slot.length == word.length() && std::memcmp(slot.key, word.data(), word.length()) == 0)
+                    return slot.id;
+                index = (index + 1) & mask;
+            }
+
+            Slot &slot = slots[index];
+            slot.key = arena.copy(word.data(), word.length());
+            slot.length = static_cast<uint32_t>(word.length());
+            slot.id = static_cast<uint32_t>(words.size());
+            words.emplace_back(slot.key, slot.length);
+            return slot.id;
+        }
+    };
+
+    // Open-addressing (word id, word id) -> count table; key 0 marks an empty slot
+    class PairTable
+    {
+    private:
+        struct Slot
+        {
+            uint64_t key = 0;
+            uint32_t count = 0;
+        };
+
+        std::vector<Slot> slots;
+        size_t size = 0;
+
+        void grow()
+        {
+            std::vector<Slot> old(slots.size() * 2);
+            old.swap(slots);
+            size_t mask = slots.size() - 1;
+
+            for (const auto &slot : old)
+            {
+                if (!slot.key)
+                    continue;
+
+                size_t index = hashKey(slot.key) & mask;
+                while (slots[index].key)
+                    index = (index + 1) & mask;
+                slots[index] = slot;
+            }
+        }
+
+    public:
+        PairTable() : slots(4096) {}
+
+        // first < second, so the packed key is never zero
+        void add(uint32_t first, uint32_t second, uint32_t count)
+        {
+            if ((size + 1) * 2 > slots.size())
+                grow();
+
+            uint64_t key = (static_cast<uint64_t>(first) << 32) | second;
+            size_t mask = slots.size() - 1;
+            size_t index = hashKey(key) & mask;
+
+            while (slots[index].key && slots[index].key != key)
+                index = (index + 1) & mask;
+
+            if (!slots[index].key)
+            {
+                slots[index].key = key;
+                size++;
+            }
+            slots[index].count += count;
+        }
+
+        template <typename Fn>
+        void forEach(Fn fn) const
+        {
+            for (const auto &slot : slots)
+            {
+                if (slot.key)
+                    fn(static_cast<uint32_t>(slot.key >> 32), static_cast<uint32_t>(slot.key & 0xFFFFFFFF), slot.count);
+            }
+        }
+    };
+
+    // Everything one thread counts over its shard of the corpus
+    struct ShardCounts
+    {
+        WordTable table;
+        std::vector<uint32_t> bookCounts; // bookCount entries per word id
+        PairTable pairs;
+        WordTable surfaceTable; // Spellings of the words in the original text
+        PairTable surfaces;     // (word id, surface id + 1) -> occurrences
+        size_t tokens = 0;
+    };
+
+    std::string csvField(const std::string &value)
+    {
+        std::string quoted = "\"";
+        for (char c : value)
+        {
+            if (c == '"')
+                quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    std::string jsonString(const std::string &value)
+    {
+        std::string escaped = "\"";
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                escaped += buffer;
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+        return escaped + "\"";
+    }
+}
+
+Concordance buildConcordance(const std::vector<Verse> &verses, const ConcordanceOptions &options)
+{
+    Concordance concordance;
+
+    // Books in order of first appearance, which is canonical order
+    std::vector<size_t> verseBook(verses.size());
+    for (size_t i = 0; i < verses.size(); i++)
+    {
+        if (concordance.books.empty() || concordance.books.back() != verses[i].book)
+            concordance.books.push_back(verses[i].book);
+        verseBook[i] = concordance.books.size() - 1;
+    }
+
+    size_t bookCount = concordance.books.size();
+    size_t newTestamentStart = firstNewTestamentBook(bookCount);
+    size_t window = static_cast<size_t>(std::max(1, options.window));
+    size_t shards = workerCount();
+    std::vector<ShardCounts> counts(shards);
+
+    parallelFor(verses.size(), [&](size_t begin, size_t end, size_t shard)
+                {
+                    ShardCounts &local = counts[shard];
+                    std::vector<std::vector<uint32_t>> verseWords; // Distinct ids of the last `window` verses
+                    size_t previous = SIZE_MAX;
+
+                    // Start a little before the shard so its first windows are complete;
+                    // those verses only fill the window and are counted by the previous shard
+                    size_t start = begin - std::min(window - 1, begin);
+
+                    for (size_t i = start; i < end; i++)
+                    {
+                        const Verse &verse = verses[i];
+                        bool counted = i >= begin;
+                        std::vector<uint32_t> ids;
+                        size_t offset = 0;
+
+                        for (const auto &word : tokenize(verse.folded))
+                        {
+                            uint32_t id = local.table.intern(word);
+                            if (id * bookCount >= local.bookCounts.size())
+                                local.bookCounts.resize((id + 1) * bookCount, 0);
+
+                            if (counted)
+                            {
+                                local.bookCounts[id * bookCount + verseBook[i]]++;
+                                local.tokens++;
+
+                                // Words are separated by non-word bytes, so the next match is this word
+                                size_t begin = verse.folded.find(word, offset);
+                                size_t end = begin + word.length();
+                                offset = end;
+                                mapFoldedRange(verse.foldMap, begin, end);
+                                uint32_t surface = local.surfaceTable.intern(std::string_view(verse.text).substr(begin, end - begin));
+                                local.surfaces.add(id, surface + 1, 1);
+                            }
+                            ids.push_back(id);
+                        }
+
+                        std::sort(ids.begin(), ids.end());
+                        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+                        // Windows don't span chapters
+                        bool sameChapter = previous != SIZE_MAX && verses[previous].book == verse.book &&
+                                           verses[previous].chapter == verse.chapter;
+                        if (!sameChapter)
+                            verseWords.clear();
+                        previous = i;
+
+                        verseWords.push_back(ids);
+                        if (verseWords.size() > window)
+                            verseWords.erase(verseWords.begin());
+
+                        if (!counted)
+                            continue;
+
+                        // Count each window once, at the verse that completes it
+                        std::vector<uint32_t> merged;
+                        for (const auto &words : verseWords)
+                            merged.insert(merged.end(), words.begin(), words.end());
+                        std::sort(merged.begin(), merged.end());
+                        merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+
+                        for (size_t a = 0; a < merged.size(); a++)
+                        {
+                            for (size_t c = a + 1; c < merged.size(); c++)
+                            {
+                                local.pairs.add(merged[a], merged[c], 1);
+                            }
+                        }
+                    } },
+                shards);
+
+    // Merge the per-thread tables into one
+    WordTable global;
+    std::vector<uint32_t> globalBookCounts;
+    PairTable globalPairs;
+    WordTable globalSurfaceTable;
+    PairTable globalSurfaces;
+
+    for (auto &local : counts)
+    {
+        std::vector<uint32_t> remap(local.table.words.size());
+        for (size_t id = 0; id < local.table.words.size(); id++)
+        {
+            uint32_t globalId = global.intern(local.table.words[id]);
+            remap[id] = globalId;
+
+            if ((globalId + 1) * bookCount > globalBookCounts.size())
+                globalBookCounts.resize((globalId + 1) * bookCount, 0);
+
+            for (size_t book = 0; book < bookCount; book++)
+            {
+                globalBookCounts[globalId * bookCount + book] += local.bookCounts[id * bookCount + book];
+            }
+        }
+
+        local.pairs.forEach([&](uint32_t first, uint32_t second, uint32_t count)
+                            {
+                                uint32_t a = remap[first];
+                                uint32_t c = remap[second];
+                                globalPairs.add(std::min(a, c), std::max(a, c), count); });
+
+        local.surfaces.forEach([&](uint32_t word, uint32_t surface, uint32_t count)
+                               { globalSurfaces.add(remap[word], globalSurfaceTable.intern(local.surfaceTable.words[surface - 1]) + 1, count); });
+
+        concordance.tokenCount += local.tokens;
+    }
+
+    // The most frequent spelling of each word, the first in byte order on a tie
+    std::vector<std::pair<uint32_t, uint32_t>> spellings(global.words.size(), {0, 0}); // (count, surface id)
+    globalSurfaces.forEach([&](uint32_t word, uint32_t surface, uint32_t count)
+                           {
+                               auto &best = spellings[word];
+                               const auto &words = globalSurfaceTable.words;
+                               if (count > best.first || (count == best.first && words[surface - 1] < words[best.second]))
+                                   best = {count, surface - 1}; });
+
+    concordance.bookVocabulary.assign(bookCount, 0);
+    concordance.words.resize(global.words.size());
+
+    for (size_t id = 0; id < global.words.size(); id++)
+    {
+        WordStats &stats = concordance.words[id];
+        stats.word = std::string(global.words[id]);
+        stats.surface = spellings[id].first ? std::string(globalSurfaceTable.words[spellings[id].second]) : stats.word;
+        stats.perBook.assign(globalBookCounts.begin() + id * bookCount, globalBookCounts.begin() + (id + 1) * bookCount);
+
+        for (size_t book = 0; book < bookCount; book++)
+        {
+            uint32_t count = stats.perBook[book];
+            if (count == 0)
+                continue;
+
+            stats.total += count;
+            if (book >= newTestamentStart)
+                stats.newTestament += count;
+            else
+                stats.oldTestament += count;
+            concordance.bookVocabulary[book]++;
+        }
+    }
+
+    std::sort(concordance.words.begin(), concordance.words.end(), [](const WordStats &x, const WordStats &y)
+              { return x.total != y.total ? x.total > y.total : x.word < y.word; });
+
+    // Keep only the most frequent pairs
+    std::vector<std::pair<uint64_t, uint32_t>> pairs;
+    globalPairs.forEach([&](uint32_t first, uint32_t second, uint32_t count)
+                        { pairs.push_back({(static_cast<uint64_t>(first) << 32) | second, count}); });
+
+    size_t keep = std::min(options.topPairs, pairs.size());
+    std::partial_sort(pairs.begin(), pairs.begin() + keep, pairs.end(), [](const auto &x, const auto &y)
+                      { return x.second != y.second ? x.second > y.second : x.first < y.first; });
+
+    for (size_t i = 0; i < keep; i++)
+    {
+        concordance.pairs.push_back({std::string(global.words[pairs[i].first >> 32]),
+                                     std::string(global.words[pairs[i].first & 0xFFFFFFFF]),
+                                     pairs[i].second});
+    }
+
+    return concordance;
+}
+
+bool writeConcordanceCsv(const Concordance &concordance, const std::string &directory)
+{
+    std::ofstream frequency(directory + "/word_frequency.csv");
+    std::ofstream hapax(directory + "/hapax.csv");
+    std::ofstream vocabulary(directory + "/book_vocabulary.csv");
+    std::ofstream cooccurrence(directory + "/cooccurrence.csv");
+
+    if (!frequency || !hapax || !vocabulary || !cooccurrence)
+    {
+        std::cerr << "Error writing CSV files to: " << directory << std::endl;
+        return false;
+    }
+
+    frequency << "word,surface,total,old_testament,new_testament,book,count\n";
+    hapax << "word,surface,book\n";
+
+    for (const auto &stats : concordance.words)
+    {
+        for (size_t book = 0; book < concordance.books.size(); book++)
+        {
+            if (stats.perBook[book] == 0)
+                continue;
+
+            frequency << csvField(stats.word) << "," << csvField(stats.surface) << "," << stats.total << "," << stats.oldTestament << ","
+                      << stats.newTestament << "," << csvField(concordance.books[book]) << "," << stats.perBook[book] << "\n";
+
+            if (stats.total == 1)
+                hapax << csvField(stats.word) << "," << csvField(stats.surface) << "," << csvField(concordance.books[book]) << "\n";
+        }
+    }
+
+    vocabulary << "book,vocabulary\n";
+    for (size_t book = 0; book < concordance.books.size(); book++)
+    {
+        vocabulary << csvField(concordance.books[book]) << "," << concordance.bookVocabulary[book] << "\n";
+    }
+
+    cooccurrence << "first,second,count\n";
+    for (const auto &pair : concordance.pairs)
+    {
+        cooccurrence << csvField(pair.first) << "," << csvField(pair.second) << "," << pair.count << "\n";
+    }
+
+    return true;
+}
+
+void writeConcordanceJson(const Concordance &concordance, std::ostream &out)
+{
+    out << "{\n  \"tokens\": " << concordance.tokenCount << ",\n  \"books\": [";
+    for (size_t book = 0; book < concordance.books.size(); book++)
+    {
+        out << (book ? ", " : "") << "{\"name\": " << jsonString(concordance.books[book])
+            << ", \"vocabulary\": " << concordance.bookVocabulary[book] << "}";
+    }
+
+    out << "],\n  \"words\": [";
+    for (size_t i = 0; i < concordance.words.size(); i++)
+    {
+        const WordStats &stats = concordance.words[i];
+        out << (i ? "," : "") << "\n    {\"word\": " << jsonString(stats.word) << ", \"surface\": " << jsonString(stats.surface)
+            << ", \"total\": " << stats.total
+            << ", \"old_testament\": " << stats.oldTestament << ", \"new_testament\": " << stats.newTestament
+            << ", \"books\": {";
+
+        bool first = true;
+        for (size_t book = 0; book < concordance.books.size(); book++)
+        {
+            if (stats.perBook[book] == 0)
+                continue;
+            out << (first ? "" : ", ") << jsonString(concordance.books[book]) << ": " << stats.perBook[book];
+            first = false;
+        }
+        out << "}}";
+    }
+
+    out << "\n  ],\n  \"hapax\": [";
+    bool first = true;
+    for (const auto &stats : concordance.words)
+    {
+        if (stats.total != 1)
+            continue;
+        out << (first ? "" : ", ") << "{\"word\": " << jsonString(stats.word) << ", \"surface\": " << jsonString(stats.surface) << "}";
+        first = false;
+    }
+
+    out << "],\n  \"cooccurrence\": [";
+    for (size_t i = 0; i < concordance.pairs.size(); i++)
+    {
+        const PairStats &pair = concordance.pairs[i];
+        out << (i ? "," : "") << "\n    {\"first\": " << jsonString(pair.first) << ", \"second\": "
+            << jsonString(pair.second) << ", \"count\": " << pair.count << "}";
+    }
+    out << "\n  ]\n}\n";
+}
@@ -0,0 +1,44 @@
+#include "../include/corpus.h"
+#include <iostream>
+
+const char *const VERSE_COLUMNS = "id, book, chapter, verse, text, folded, fold_map";
+
+void readVerse(sqlite3_stmt *stmt, Verse &verse)
+{
+    verse.id = sqlite3_column_int(stmt, 0);
+    verse.book = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+    verse.chapter = sqlite3_column_int(stmt, 2);
+    verse.verse = sqlite3_column_int(stmt, 3);
+    verse.text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
+
+    const unsigned char *folded = sqlite3_column_text(stmt, 5);
+    verse.folded = folded ? reinterpret_cast<const char *>(folded) : verse.text;
+    verse.foldMap = decodeFoldMap(sqlite3_column_blob(stmt, 6), sqlite3_column_bytes(stmt, 6));
+}
+
+bool loadCorpus(sqlite3 *db, std::vector<Verse> &verses)
+{
+    verses.clear();
+
+    if (!db)
+        return false;
+
+    std::string query = std::string("SELECT ") + VERSE_COLUMNS + " FROM bible ORDER BY id";
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        Verse verse;
+        readVerse(stmt, verse);
+        verses.push_back(std::move(verse));
+    }
+
+    sqlite3_finalize(stmt);
+    return true;
+}
@@ -0,0 +1,526 @@
+#include "../include/corpus_store.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SqliteCorpusStore::~SqliteCorpusStore()
+{
+    for (sqlite3_stmt *stmt : {selectBooks, selectChapterCount, selectChapter, selectVerse, selectMatches})
+        sqlite3_finalize(stmt);
+
+    if (ownsConnection)
+        sqlite3_close(db);
+}
+
+sqlite3_stmt *SqliteCorpusStore::prepare(sqlite3_stmt *&stmt, const std::string &sql)
+{
+    if (stmt)
+    {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        return stmt;
+    }
+
+    if (!db || sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << (db ? sqlite3_errmsg(db) : "no database") << std::endl;
+        stmt = nullptr;
+    }
+    return stmt;
+}
+
+std::vector<std::string> SqliteCorpusStore::books()
+{
+    std::vector<std::string> names;
+    sqlite3_stmt *stmt = prepare(selectBooks, "SELECT book FROM bible GROUP BY book ORDER BY MIN(id)");
+    if (!stmt)
+        return names;
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        names.push_back(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0)));
+    }
+
+    sqlite3_reset(stmt);
+    return names;
+}
+
+int SqliteCorpusStore::chapterCount(const std::string &book)
+{
+    sqlite3_stmt *stmt = prepare(selectChapterCount, "SELECT MAX(chapter) FROM bible WHERE book = ?");
+    if (!stmt)
+        return 0;
+
+    sqlite3_bind_text(stmt, 1, book.c_str(), -1, SQLITE_TRANSIENT);
+    int count = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : 0;
+    sqlite3_reset(stmt);
+    return count;
+}
+
+std::vector<Verse> SqliteCorpusStore::chapter(const std::string &book, int chapter)
+{
+    std::vector<Verse> verses;
+    sqlite3_stmt *stmt = prepare(selectChapter, std::string("SELECT ") + VERSE_COLUMNS + " FROM bible WHERE book = ? AND chapter = ? ORDER BY verse");
+    if (!stmt)
+        return verses;
+
+    sqlite3_bind_text(stmt, 1, book.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 2, chapter);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        Verse verse;
+        readVerse(stmt, verse);
+        verses.push_back(std::move(verse));
+    }
+
+    sqlite3_reset(stmt);
+    return verses;
+}
+
+bool SqliteCorpusStore::verse(int id, Verse &verse)
+{
+    sqlite3_stmt *stmt = prepare(selectVerse, std::string("SELECT ") + VERSE_COLUMNS + " FROM bible WHERE id = ?");
+    if (!stmt)
+        return false;
+
+    sqlite3_bind_int(stmt, 1, id);
+    bool found = sqlite3_step(stmt) == SQLITE_ROW;
+    if (found)
+        readVerse(stmt, verse);
+
+    sqlite3_reset(stmt);
+    return found;
+}
+
+bool SqliteCorpusStore::allVerses(std::vector<Verse> &verses)
+{
+    return loadCorpus(db, verses);
+}
+
+std::vector<int> SqliteCorpusStore::search(const std::string &foldedTerm)
+{
+    std::vector<int> ids;
+
+    // Plain byte search on the pre-folded shadow text
+    sqlite3_stmt *stmt = prepare(selectMatches, "SELECT id FROM bible WHERE instr(folded, ?) > 0 ORDER BY id");
+    if (!stmt)
+        return ids;
+
+    sqlite3_bind_text(stmt, 1, foldedTerm.c_str(), foldedTerm.length(), SQLITE_TRANSIENT);
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        ids.push_back(sqlite3_column_int(stmt, 0));
+    }
+
+    sqlite3_reset(stmt);
+    return ids;
+}
+
+void FlatCorpusStore::buildIndex(std::vector<std::string> names)
+{
+    bookNames = std::move(names);
+    chapterStarts.assign(bookNames.size(), std::vector<uint32_t>());
+
+    // Records are in id order, which keeps each chapter contiguous
+    for (size_t i = 0; i < recordCount; i++)
+    {
+        const FlatVerse &record = records[i];
+        if (record.book < 0 || static_cast<size_t>(record.book) >= bookNames.size() || record.chapter < 1)
+            continue;
+
+        std::vector<uint32_t> &starts = chapterStarts[record.book];
+        if (starts.size() < static_cast<size_t>(record.chapter))
+            starts.resize(record.chapter, static_cast<uint32_t>(i));
+    }
+
+    // Close each chapter at the start of the next one, or the end of its book
+    for (size_t book = 0; book < chapterStarts.size(); book++)
+    {
+        std::vector<uint32_t> &starts = chapterStarts[book];
+        if (starts.empty())
+            continue;
+
+        uint32_t end = starts.front();
+        while (end < recordCount && records[end].book == static_cast<int32_t>(book))
+            end++;
+        starts.push_back(end);
+    }
+}
+
+void FlatCorpusStore::toVerse(const FlatVerse &record, Verse &verse) const
+{
+    verse.id = record.id;
+    verse.book = bookNames[record.book];
+    verse.chapter = record.chapter;
+    verse.verse = record.verse;
+    verse.text.assign(pool + record.textOffset, record.textLength);
+    verse.folded.assign(pool + record.foldedOffset, record.foldedLength);
+    verse.foldMap = decodeFoldMap(pool + record.mapOffset, record.mapLength);
+}
+
+int FlatCorpusStore::bookIndex(const std::string &book) const
+{
+    auto found = std::find(bookNames.begin(), bookNames.end(), book);
+    return found == bookNames.end() ? -1 : static_cast<int>(found - bookNames.begin());
+}
+
+int FlatCorpusStore::chapterCount(const std::string &book)
+{
+    int index = bookIndex(book);
+    return index < 0 || chapterStarts[index].empty() ? 0 : static_cast<int>(chapterStarts[index].size()) - 1;
+}
+
+std::vector<Verse> FlatCorpusStore::chapter(const std::string &book, int chapter)
+{
+    std::vector<Verse> verses;
+    int index = bookIndex(book);
+    if (index < 0 || chapter < 1 || chapter >= static_cast<int>(chapterStarts[index].size()))
+        return verses;
+
+    // A chapter missing from the text starts and ends where the next one starts
+    uint32_t begin = chapterStarts[index][chapter - 1];
+    uint32_t end = chapterStarts[index][chapter];
+    for (uint32_t i = begin; i < end; i++)
+    {
+        if (records[i].chapter != chapter)
+            continue;
+
+        verses.emplace_back();
+        toVerse(records[i], verses.back());
+    }
+
+    std::sort(verses.begin(), verses.end(), [](const Verse &a, const Verse &b)
+              { return a.verse < b.verse; });
+    return verses;
+}
+
+bool FlatCorpusStore::verse(int id, Verse &verse)
+{
+    const FlatVerse *end = records + recordCount;
+    const FlatVerse *found = std::lower_bound(records, end, id, [](const FlatVerse &record, int value)
+                                              { return record.id < value; });
+    if (found == end || found->id != id)
+        return false;
+
+    toVerse(*found, verse);
+    return true;
+}
+
+bool FlatCorpusStore::allVerses(std::vector<Verse> &verses)
+{
+    verses.clear();
+    verses.resize(recordCount);
+    for (size_t i = 0; i < recordCount; i++)
+        toVerse(records[i], verses[i]);
+    return true;
+}
+
+std::vector<int> FlatCorpusStore::search(const std::string &foldedTerm)
+{
+    std::vector<int> ids;
+    std::string_view term(foldedTerm);
+
+    for (size_t i = 0; i < recordCount; i++)
+    {
+        std::string_view folded(pool + records[i].foldedOffset, records[i].foldedLength);
+        if (folded.find(term) != std::string_view::npos)
+            ids.push_back(records[i].id);
+    }
+
+    return ids;
+}
+
+// Raw rows of the 'bible' table in id order, for building flat stores
+struct FlatSource
+{
+    std::vector<std::string> books;
+    std::vector<FlatVerse> records;
+    std::string pool;
+};
+
+static bool readFlatSource(sqlite3 *db, FlatSource &source)
+{
+    sqlite3_stmt *stmt;
+    const char *query = "SELECT id, book, chapter, verse, text, folded, fold_map FROM bible ORDER BY id";
+
+    if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    auto appendPool = [&source](const void *data, size_t length, uint32_t &offset, uint32_t &size)
+    {
+        offset = static_cast<uint32_t>(source.pool.size());
+        size = static_cast<uint32_t>(length);
+        source.pool.append(static_cast<const char *>(data), length);
+    };
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        std::string book = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+        if (source.books.empty() || source.books.back() != book)
+        {
+            auto known = std::find(source.books.begin(), source.books.end(), book);
+            if (known == source.books.end())
+                source.books.push_back(book);
+        }
+
+        FlatVerse record;
+        record.id = sqlite3_column_int(stmt, 0);
+        record.book = static_cast<int32_t>(std::find(source.books.begin(), source.books.end(), book) - source.books.begin());
+        record.chapter = sqlite3_column_int(stmt, 2);
+        record.verse = sqlite3_column_int(stmt, 3);
+
+        // Older rows without a folded shadow search their text as is
+        int foldedColumn = sqlite3_column_type(stmt, 5) == SQLITE_NULL ? 4 : 5;
+        appendPool(sqlite3_column_text(stmt, 4), sqlite3_column_bytes(stmt, 4), record.textOffset, record.textLength);
+        appendPool(sqlite3_column_text(stmt, foldedColumn), sqlite3_column_bytes(stmt, foldedColumn), record.foldedOffset, record.foldedLength);
+        appendPool(sqlite3_column_blob(stmt, 6), sqlite3_column_bytes(stmt, 6), record.mapOffset, record.mapLength);
+        source.records.push_back(record);
+    }
+
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+bool ArenaCorpusStore::load(sqlite3 *db)
+{
+    FlatSource source;
+    if (!readFlatSource(db, source))
+        return false;
+
+    arena.reset();
+    FlatVerse *copied = static_cast<FlatVerse *>(arena.allocate(std::max<size_t>(1, source.records.size()) * sizeof(FlatVerse), alignof(FlatVerse)));
+    std::copy(source.records.begin(), source.records.end(), copied);
+
+    records = copied;
+    recordCount = source.records.size();
+    pool = arena.copy(source.pool.data(), source.pool.size());
+    buildIndex(std::move(source.books));
+    return true;
+}
+
+size_t ArenaCorpusStore::memoryBytes() const
+{
+    size_t total = arena.bytesReserved();
+    for (const auto &name : bookNames)
+        total += sizeof(name) + name.capacity();
+    for (const auto &starts : chapterStarts)
+        total += sizeof(starts) + starts.capacity() * sizeof(uint32_t);
+    return total;
+}
+
+// Corpus file layout: header, book name table, verse records, string pool.
+// All offsets are from the start of the file.
+static const char corpusMagic[8] = {'B', 'I', 'B', 'L', 'C', 'R', 'P', '1'};
+
+struct CorpusFileHeader
+{
+    char magic[8];
+    uint32_t verseCount;
+    uint32_t bookCount;
+    uint64_t booksOffset;   // bookCount pairs of (pool offset, length)
+    uint64_t recordsOffset; // verseCount FlatVerse records
+    uint64_t poolOffset;
+    uint64_t poolBytes;
+};
+
+// Whether length bytes from offset fit in size, without overflowing
+static bool withinBounds(uint64_t offset, uint64_t length, uint64_t size)
+{
+    return offset <= size && length <= size - offset;
+}
+
+bool writeCorpusFile(sqlite3 *db, const std::string &path)
+{
+    FlatSource source;
+    if (!readFlatSource(db, source))
+        return false;
+
+    std::vector<uint32_t> bookTable;
+    for (const auto &name : source.books)
+    {
+        bookTable.push_back(static_cast<uint32_t>(source.pool.size()));
+        bookTable.push_back(static_cast<uint32_t>(name.length()));
+        source.pool += name;
+    }
+
+    CorpusFileHeader header;
+    std::memcpy(header.magic, corpusMagic, sizeof(corpusMagic));
+    header.verseCount = static_cast<uint32_t>(source.records.size());
+    header.bookCount = static_cast<uint32_t>(source.books.size());
+    header.booksOffset = sizeof(header);
+    header.recordsOffset = header.booksOffset + bookTable.size() * sizeof(uint32_t);
+    header.poolOffset = header.recordsOffset + source.records.size() * sizeof(FlatVerse);
+    header.poolBytes = source.pool.size();
+
+    // Write to a temporary file and rename so readers never map half a file
+    std::string temporary = path + ".tmp";
+    FILE *file = fopen(temporary.c_str(), "wb");
+    if (!file)
+    {
+        std::cerr << "Error writing corpus file: " << temporary << std::endl;
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(bookTable.data(), sizeof(uint32_t), bookTable.size(), file) == bookTable.size() &&
+              fwrite(source.records.data(), sizeof(FlatVerse), source.records.size(), file) == source.records.size() &&
+              fwrite(source.pool.data(), 1, source.pool.size(), file) == source.pool.size();
+    ok = fclose(file) == 0 && ok;
+
+    if (!ok || rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::cerr << "Error writing corpus file: " << path << std::endl;
+        remove(temporary.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool MappedCorpusStore::open(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(CorpusFileHeader))
+    {
+        close(fd);
+        return false;
+    }
+
+    mappedBytes = static_cast<size_t>(info.st_size);
+    mapping = mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        mapping = nullptr;
+        return false;
+    }
+
+    const char *base = static_cast<const char *>(mapping);
+    const CorpusFileHeader *header = reinterpret_cast<const CorpusFileHeader *>(base);
+
+    // Reject files that are truncated, damaged or from another format: every
+    // table, and every string a record or book entry points at, must lie
+    // inside the file before anything is read through it
+    bool valid = std::memcmp(header->magic, corpusMagic, sizeof(corpusMagic)) == 0 &&
+                 header->booksOffset % alignof(uint32_t) == 0 && header->recordsOffset % alignof(FlatVerse) == 0 &&
+                 withinBounds(header->booksOffset, uint64_t(header->bookCount) * 2 * sizeof(uint32_t), mappedBytes) &&
+                 withinBounds(header->recordsOffset, uint64_t(header->verseCount) * sizeof(FlatVerse), mappedBytes) &&
+                 withinBounds(header->poolOffset, header->poolBytes, mappedBytes);
+
+    const uint32_t *bookTable = reinterpret_cast<const uint32_t *>(base + header->booksOffset);
+    for (uint32_t i = 0; valid && i < header->bookCount; i++)
+        valid = withinBounds(bookTable[2 * i], bookTable[2 * i + 1], header->poolBytes);
+
+    const FlatVerse *fileRecords = reinterpret_cast<const FlatVerse *>(base + header->recordsOffset);
+    for (uint32_t i = 0; valid && i < header->verseCount; i++)
+    {
+        const FlatVerse &record = fileRecords[i];
+        valid = withinBounds(record.textOffset, record.textLength, header->poolBytes) &&
+                withinBounds(record.foldedOffset, record.foldedLength, header->poolBytes) &&
+                withinBounds(record.mapOffset, record.mapLength, header->poolBytes) &&
+                record.book >= 0 && static_cast<uint32_t>(record.book) < header->bookCount &&
+                (i == 0 || fileRecords[i - 1].id < record.id); // Lookups binary search by id
+    }
+
+    if (!valid)
+    {
+        std::cerr << "Corpus file is damaged or from another version: " << path << std::endl;
+        return false;
+    }
+
+    records = fileRecords;
+    recordCount = header->verseCount;
+    pool = base + header->poolOffset;
+
+    std::vector<std::string> names;
+    for (uint32_t i = 0; i < header->bookCount; i++)
+        names.emplace_back(pool + bookTable[2 * i], bookTable[2 * i + 1]);
+
+    buildIndex(std::move(names));
+    return true;
+}
+
+MappedCorpusStore::~MappedCorpusStore()
+{
+    if (mapping)
+        munmap(mapping, mappedBytes);
+}
+
+bool parseStoreBackend(const std::string &name, StoreBackend &backend)
+{
+    if (name == "sqlite")
+        backend = StoreBackend::Sqlite;
+    else if (name == "arena")
+        backend = StoreBackend::Arena;
+    else if (name == "mmap")
+        backend = StoreBackend::Mapped;
+    else
+        return false;
+    return true;
+}
+
+std::string corpusFilePath(const std::string &dbPath)
+{
+    return dbPath + ".corpus";
+}
+
+// Time of the last write to a file in nanoseconds, zero if it does not exist
+static int64_t lastModified(const std::string &path)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+        return 0;
+    return static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+}
+
+std::unique_ptr<CorpusStore> openCorpusStore(StoreBackend backend, sqlite3 *db, const std::string &dbPath)
+{
+    switch (backend)
+    {
+    case StoreBackend::Sqlite:
+        return std::unique_ptr<CorpusStore>(new SqliteCorpusStore(db));
+
+    case StoreBackend::Arena:
+    {
+        std::unique_ptr<ArenaCorpusStore> store(new ArenaCorpusStore());
+        if (!store->load(db))
+            return nullptr;
+        return std::unique_ptr<CorpusStore>(std::move(store));
+    }
+
+    case StoreBackend::Mapped:
+    {
+        std::string path = corpusFilePath(dbPath);
+        int64_t source = std::max(lastModified(dbPath), lastModified(dbPath + "-wal"));
+        if (lastModified(path) < source && !writeCorpusFile(db, path))
+            return nullptr;
+
+        // A damaged file is rebuilt once before giving up
+        std::unique_ptr<MappedCorpusStore> store(new MappedCorpusStore());
+        if (!store->open(path))
+        {
+            store.reset(new MappedCorpusStore());
+            if (!writeCorpusFile(db, path) || !store->open(path))
+                return nullptr;
+        }
+        return std::unique_ptr<CorpusStore>(std::move(store));
+    }
+    }
+
+    return nullptr;
+}
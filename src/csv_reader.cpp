@@ -0,0 +1,187 @@
+#include "../include/csv_reader.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+bool CsvReader::open(const std::string &path)
+{
+    close();
+    file = fopen(path.c_str(), "rb");
+    ownsFile = file != nullptr;
+    return file != nullptr;
+}
+
+void CsvReader::attach(FILE *stream)
+{
+    close();
+    file = stream;
+}
+
+void CsvReader::close()
+{
+    if (file && ownsFile)
+        fclose(file);
+
+    file = nullptr;
+    ownsFile = false;
+    position = end = consumed = records = fieldsUsed = 0;
+    atEnd = false;
+}
+
+// Move the unparsed tail to the front and read more behind it, doubling
+// the buffer when a single record fills all of it
+void CsvReader::refill()
+{
+    if (position > 0)
+    {
+        std::memmove(buffer.data(), buffer.data() + position, end - position);
+        end -= position;
+        position = 0;
+    }
+
+    if (end == buffer.size())
+        buffer.resize(buffer.size() * 2);
+
+    size_t got = file ? fread(buffer.data() + end, 1, buffer.size() - end, file) : 0;
+    end += got;
+    if (got == 0)
+        atEnd = true;
+}
+
+bool CsvReader::next()
+{
+    // Skip a UTF-8 byte order mark at the start of the file
+    if (consumed == 0 && records == 0 && end == 0)
+    {
+        refill();
+        if (end >= 3 && std::memcmp(buffer.data(), "\xEF\xBB\xBF", 3) == 0)
+        {
+            position = 3;
+            consumed = 3;
+        }
+    }
+
+    while (true)
+    {
+        switch (parseRecord())
+        {
+        case Parse::Record:
+            records++;
+            return true;
+        case Parse::Finished:
+            return false;
+        case Parse::NeedMore:
+            refill();
+            break;
+        }
+    }
+}
+
+// Parse one record starting at position. A record cut off by the end of
+// the buffer is left alone until more input has been read, unless there is
+// no more, in which case it ends where the input does.
+CsvReader::Parse CsvReader::parseRecord()
+{
+    const char *data = buffer.data();
+    size_t i = position;
+
+    // Blank lines are not records
+    while (i < end && (data[i] == '\n' || data[i] == '\r'))
+        i++;
+    if (i == end)
+    {
+        if (!atEnd)
+            return Parse::NeedMore;
+        consumed += i - position;
+        position = i;
+        return Parse::Finished;
+    }
+
+    fieldsUsed = 0;
+    while (true)
+    {
+        if (fieldsUsed == fields.size())
+            fields.emplace_back();
+        std::string &value = fields[fieldsUsed++];
+        value.clear();
+
+        while (i < end && (data[i] == ' ' || data[i] == '\t'))
+            i++;
+
+        if (i < end && data[i] == '"')
+        {
+            // Quoted: copy up to each quote; "" stands for one quote
+            i++;
+            while (true)
+            {
+                const char *quote = static_cast<const char *>(std::memchr(data + i, '"', end - i));
+                size_t stop = quote ? quote - data : end;
+                value.append(data + i, stop - i);
+                i = stop;
+
+                if (i == end || i + 1 == end)
+                {
+                    // The closing quote or what follows it is not in the buffer yet
+                    if (!atEnd)
+                        return Parse::NeedMore;
+                    i = end;
+                    break;
+                }
+
+                if (data[i + 1] == '"')
+                {
+                    value += '"';
+                    i += 2;
+                    continue;
+                }
+
+                i++;
+                break;
+            }
+
+            // Anything between the closing quote and the separator is kept
+            while (i < end && data[i] != ',' && data[i] != '\n')
+            {
+                if (data[i] != ' ' && data[i] != '\t' && data[i] != '\r')
+                    value += data[i];
+                i++;
+            }
+        }
+        else
+        {
+            size_t start = i;
+            while (i < end && data[i] != ',' && data[i] != '\n')
+                i++;
+
+            size_t stop = i;
+            while (stop > start && (data[stop - 1] == ' ' || data[stop - 1] == '\t' || data[stop - 1] == '\r'))
+                stop--;
+            value.assign(data + start, stop - start);
+        }
+
+        if (i == end)
+        {
+            if (!atEnd)
+                return Parse::NeedMore;
+            break;
+        }
+
+        if (data[i++] == '\n')
+            break;
+    }
+
+    consumed += i - position;
+    position = i;
+    return Parse::Record;
+}
+
+bool CsvReader::integer(size_t index, int &value) const
+{
+    if (index >= fieldsUsed)
+        return false;
+
+    const std::string &text = fields[index];
+    const char *last = text.data() + text.size();
+    auto result = std::from_chars(text.data(), last, value);
+    return result.ec == std::errc() && result.ptr == last && !text.empty();
+}
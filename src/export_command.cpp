@@ -0,0 +1,118 @@
+#include "../include/export_command.h"
+#include "../include/verse_index.h"
+#include "../include/memory_budget.h"
+#include <sqlite3.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <unistd.h>
+
+// Row id of a verse, or of the nearest existing verse inside the chapter
+// when the numbering has a gap there
+static int verseRowId(sqlite3 *db, const std::string &book, const VersePosition &position, bool last)
+{
+    const char *query = last ? "SELECT id FROM bible WHERE book = ? AND chapter = ? AND verse <= ? ORDER BY verse DESC LIMIT 1"
+                             : "SELECT id FROM bible WHERE book = ? AND chapter = ? AND verse >= ? ORDER BY verse LIMIT 1";
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return -1;
+    }
+
+    sqlite3_bind_text(stmt, 1, book.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, position.chapter);
+    sqlite3_bind_int(stmt, 3, position.verse);
+
+    int id = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+    sqlite3_finalize(stmt);
+    return id;
+}
+
+// Utility to write a range of verses, or the whole text, to a file or stdout
+bool exportCommand(const std::string &dbPath, const std::string &range, ExportFormat format, const std::string &outPath)
+{
+    sqlite3 *db;
+    if (sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    int firstId = 0;
+    int lastId = std::numeric_limits<int>::max();
+
+    if (!range.empty())
+    {
+        VerseIndex index;
+        VersePosition first, last;
+        if (!index.load(db))
+        {
+            sqlite3_close(db);
+            return false;
+        }
+
+        if (!index.parseRange(range, first, last))
+        {
+            std::cerr << "Unknown reference or range: " << range << std::endl;
+            sqlite3_close(db);
+            return false;
+        }
+
+        firstId = verseRowId(db, index.bookName(first.book), first, false);
+        lastId = verseRowId(db, index.bookName(last.book), last, true);
+    }
+
+    int fd = STDOUT_FILENO;
+    if (!outPath.empty())
+    {
+        fd = open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            std::cerr << "Error writing file: " << outPath << ": " << strerror(errno) << std::endl;
+            sqlite3_close(db);
+            return false;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    long count;
+    size_t bytes;
+    bool written;
+    int error;
+    {
+        OutputBuffer out(fd);
+        count = exportVerses(db, firstId, lastId, format, out);
+        written = out.flush();
+        error = errno;
+        bytes = out.bytesWritten();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    sqlite3_close(db);
+    if (fd != STDOUT_FILENO)
+        close(fd);
+
+    if (!written)
+    {
+        std::cerr << "Error writing output: " << strerror(error) << std::endl;
+        return false;
+    }
+
+    // Progress goes to stderr when the text itself is on stdout
+    if (count >= 0 && !outPath.empty())
+    {
+        std::cerr << count << " verses, " << formatBytes(bytes) << " written to " << outPath << " in "
+                  << std::fixed << std::setprecision(1) << elapsed.count() * 1000.0 << " ms ("
+                  << std::setprecision(0) << (elapsed.count() > 0 ? bytes / elapsed.count() / 1048576.0 : 0.0)
+                  << " MiB/s)." << std::endl;
+    }
+
+    return count >= 0;
+}
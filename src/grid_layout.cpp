@@ -0,0 +1,114 @@
+#include "../include/grid_layout.h"
+#include <algorithm>
+
+int displayWidth(std::string_view text)
+{
+    int width = 0;
+    for (unsigned char c : text)
+    {
+        if ((c & 0xC0) != 0x80)
+            width++;
+    }
+    return width;
+}
+
+void GridLayout::measure(size_t count, const std::function<int(size_t)> &width)
+{
+    labelWidths.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        labelWidths[i] = width(i);
+    }
+    shapes.clear();
+}
+
+std::vector<int> GridLayout::columnWidths(size_t rows) const
+{
+    std::vector<int> widths;
+    for (size_t start = 0; start < labelWidths.size(); start += rows)
+    {
+        size_t end = std::min(start + rows, labelWidths.size());
+        widths.push_back(*std::max_element(labelWidths.begin() + start, labelWidths.begin() + end) + gap);
+    }
+    return widths;
+}
+
+GridShape GridLayout::compute(int width, int height) const
+{
+    GridShape result;
+    size_t count = labelWidths.size();
+    if (count == 0)
+    {
+        result.widths.push_back(width);
+        return result;
+    }
+
+    auto fits = [this, count, width](size_t columns)
+    {
+        int total = 0;
+        for (int w : columnWidths((count + columns - 1) / columns))
+            total += w;
+        return total <= width;
+    };
+
+    // Widest grid that fits across the screen, trying the most columns first
+    size_t maxColumns = std::min<size_t>(count, std::max(1, width / (gap + 1)));
+    size_t best = 1;
+    for (size_t columns = maxColumns; columns > 1; columns--)
+    {
+        if (fits(columns))
+        {
+            best = columns;
+            break;
+        }
+    }
+
+    // Fewer, roomier columns are easier to read if they still fit on screen
+    size_t columns = best;
+    for (size_t fewer = 1; fewer < best; fewer++)
+    {
+        if ((count + fewer - 1) / fewer <= static_cast<size_t>(std::max(1, height)) && fits(fewer))
+        {
+            columns = fewer;
+            break;
+        }
+    }
+
+    size_t rows = (count + columns - 1) / columns;
+    result.widths = columnWidths(rows);
+    result.columns = static_cast<int>(result.widths.size());
+    result.rows = static_cast<int>(rows);
+
+    // Share out the spare width so the grid spans the screen
+    int total = 0;
+    for (int w : result.widths)
+        total += w;
+
+    if (total < width)
+    {
+        int extra = (width - total) / result.columns;
+        for (int &w : result.widths)
+            w += extra;
+    }
+
+    return result;
+}
+
+const GridShape &GridLayout::shape(int width, int height)
+{
+    std::pair<int, int> key(width, height);
+    auto found = shapes.find(key);
+    if (found == shapes.end())
+    {
+        found = shapes.emplace(key, compute(width, height)).first;
+    }
+    return found->second;
+}
+
+void GridLayout::apply(ListView &list, int width, int height)
+{
+    const GridShape &grid = shape(width, height);
+    list.setColumnMajor(true);
+    list.setColumnWidths(grid.widths);
+    list.setItemCount(count());
+}
@@ -0,0 +1,596 @@
+#include "../include/import_commands.h"
+#include "../include/schema.h"
+#include "../include/stem_index.h"
+#include "../include/minhash.h"
+#include "../include/tokenizer.h"
+#include "../include/content_hash.h"
+#include "../include/csv_reader.h"
+#include "../include/memory_budget.h"
+#include <sqlite3.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+
+bool createDatabase(const std::string &dbPath, const FoldOptions &options, const std::string &stemmerName)
+{
+    sqlite3 *newDb;
+    if (sqlite3_open(dbPath.c_str(), &newDb) != SQLITE_OK)
+    {
+        std::cerr << "Error creating database: " << sqlite3_errmsg(newDb) << std::endl;
+        return false;
+    }
+
+    // Create tables and record how text will be folded and stemmed for searching
+    if (!ensureSchema(newDb) || !saveFoldOptions(newDb, options) || !setMeta(newDb, "stemmer", stemmerName))
+    {
+        sqlite3_close(newDb);
+        return false;
+    }
+
+    std::cout << "Bible database schema created successfully." << std::endl;
+    std::cout << "You should now import Bible text data into this database." << std::endl;
+
+    sqlite3_close(newDb);
+    return true;
+}
+
+// One chapter of the base text as read from a CSV, in file order
+struct ImportedChapter
+{
+    std::string book;
+    int chapter = 0;
+    std::vector<std::pair<int, std::string>> verses; // (verse number, text)
+};
+
+// Serialized form of a chapter that its content hash is taken over
+static uint64_t chapterHash(const std::vector<std::pair<int, std::string>> &verses)
+{
+    std::string content;
+    for (const auto &verse : verses)
+    {
+        content += std::to_string(verse.first);
+        content += '\t';
+        content += verse.second;
+        content += '\n';
+    }
+    return contentHash(content);
+}
+
+// Writes the base text chapter by chapter. Chapters whose content hash
+// matches the one stored at the last import are skipped; changed ones are
+// rewritten in place, keeping their verse ids (which translations are keyed
+// by), together with their stem postings and MinHash entries.
+class BaseTextImport
+{
+private:
+    // A chapter already in the database
+    struct StoredChapter
+    {
+        int firstId = 0;
+        std::map<int, int> verseIds; // Verse number -> id
+        bool seen = false;           // Present in the file being imported
+    };
+
+    sqlite3 *db = nullptr;
+    FoldOptions foldOptions;
+    StemIndexWriter stemIndex;
+    MinHashIndexWriter minHashIndex;
+    std::string code; // Key of the base text in chapter_hashes
+    std::map<std::pair<std::string, int>, StoredChapter> stored;
+    std::map<int, uint64_t> hashes; // First id -> content hash
+    size_t storedSeen = 0;
+
+    sqlite3_stmt *insertVerse = nullptr;
+    sqlite3_stmt *selectVerse = nullptr;
+    sqlite3_stmt *updateVerse = nullptr;
+    sqlite3_stmt *deleteVerse = nullptr;
+    sqlite3_stmt *deleteAnnotations = nullptr;
+    sqlite3_stmt *storeHash = nullptr;
+
+    // Fold and tokenize a verse and bind the derived columns from index 'column' on
+    std::vector<std::string> bindText(sqlite3_stmt *stmt, int column, const std::string &text, std::string &folded, std::string &encodedMap)
+    {
+        FoldMap map;
+        folded = foldText(text, foldOptions, &map);
+        encodedMap = encodeFoldMap(map);
+        std::vector<std::string> words = tokenize(folded);
+
+        sqlite3_bind_text(stmt, column, text.c_str(), text.length(), SQLITE_STATIC);
+        sqlite3_bind_text(stmt, column + 1, folded.c_str(), folded.length(), SQLITE_STATIC);
+        sqlite3_bind_blob(stmt, column + 2, encodedMap.data(), encodedMap.length(), SQLITE_STATIC);
+        sqlite3_bind_int(stmt, column + 3, static_cast<int>(words.size()));
+        return words;
+    }
+
+    // Current text and folded text of a verse
+    bool readVerse(int id, std::string &text, std::string &folded)
+    {
+        sqlite3_bind_int(selectVerse, 1, id);
+        bool found = sqlite3_step(selectVerse) == SQLITE_ROW;
+        if (found)
+        {
+            text = reinterpret_cast<const char *>(sqlite3_column_text(selectVerse, 0));
+            const unsigned char *foldedText = sqlite3_column_text(selectVerse, 1);
+            folded = foldedText ? reinterpret_cast<const char *>(foldedText) : foldText(text, foldOptions);
+        }
+        sqlite3_reset(selectVerse);
+        return found;
+    }
+
+    // Hash of a chapter as stored, for databases imported before hashes were kept
+    uint64_t storedHash(const StoredChapter &chapter)
+    {
+        auto known = hashes.find(chapter.firstId);
+        if (known != hashes.end())
+            return known->second;
+
+        std::vector<std::pair<int, std::string>> verses;
+        for (const auto &verse : chapter.verseIds)
+        {
+            std::string text, folded;
+            if (readVerse(verse.second, text, folded))
+                verses.push_back({verse.first, text});
+        }
+        return chapterHash(verses);
+    }
+
+    bool saveHash(int firstId, uint64_t hash)
+    {
+        sqlite3_bind_text(storeHash, 1, code.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(storeHash, 2, firstId);
+        sqlite3_bind_int64(storeHash, 3, static_cast<sqlite3_int64>(hash));
+        bool ok = sqlite3_step(storeHash) == SQLITE_DONE;
+        sqlite3_reset(storeHash);
+        return ok;
+    }
+
+    bool addChapter(const ImportedChapter &chapter, uint64_t hash)
+    {
+        int firstId = 0;
+        for (const auto &verse : chapter.verses)
+        {
+            std::string folded, encodedMap;
+            sqlite3_bind_text(insertVerse, 1, chapter.book.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_int(insertVerse, 2, chapter.chapter);
+            sqlite3_bind_int(insertVerse, 3, verse.first);
+            std::vector<std::string> words = bindText(insertVerse, 4, verse.second, folded, encodedMap);
+
+            if (sqlite3_step(insertVerse) != SQLITE_DONE)
+            {
+                std::cerr << "Error inserting data: " << sqlite3_errmsg(db) << std::endl;
+                sqlite3_reset(insertVerse);
+                return false;
+            }
+            sqlite3_reset(insertVerse);
+
+            int verseId = static_cast<int>(sqlite3_last_insert_rowid(db));
+            if (!firstId)
+                firstId = verseId;
+            stemIndex.addVerse(verseId, words);
+            minHashIndex.addVerse(verseId, words);
+            addedVerses++;
+        }
+
+        addedChapters++;
+        return !firstId || saveHash(firstId, hash);
+    }
+
+    bool updateChapter(StoredChapter &stored, const ImportedChapter &chapter, uint64_t hash)
+    {
+        std::set<int> present;
+        for (const auto &verse : chapter.verses)
+        {
+            present.insert(verse.first);
+
+            int verseId = stored.verseIds[verse.first];
+            std::string oldText, oldFolded;
+            if (!readVerse(verseId, oldText, oldFolded) || oldText == verse.second)
+                continue;
+
+            std::string folded, encodedMap;
+            std::vector<std::string> words = bindText(updateVerse, 1, verse.second, folded, encodedMap);
+            sqlite3_bind_int(updateVerse, 5, verseId);
+            if (sqlite3_step(updateVerse) != SQLITE_DONE)
+            {
+                std::cerr << "Error updating data: " << sqlite3_errmsg(db) << std::endl;
+                sqlite3_reset(updateVerse);
+                return false;
+            }
+            sqlite3_reset(updateVerse);
+
+            stemIndex.removeVerse(verseId, tokenize(oldFolded));
+            minHashIndex.removeVerse(verseId);
+            stemIndex.addVerse(verseId, words);
+            minHashIndex.addVerse(verseId, words);
+            updatedVerses++;
+        }
+
+        // Verses the revision dropped
+        for (const auto &verse : stored.verseIds)
+        {
+            std::string oldText, oldFolded;
+            if (present.count(verse.first) || !readVerse(verse.second, oldText, oldFolded))
+                continue;
+
+            stemIndex.removeVerse(verse.second, tokenize(oldFolded));
+            minHashIndex.removeVerse(verse.second);
+
+            // Bookmarks, highlights and notes go with the verse
+            for (sqlite3_stmt *stmt : {deleteAnnotations, deleteVerse})
+            {
+                sqlite3_bind_int(stmt, 1, verse.second);
+                if (sqlite3_step(stmt) != SQLITE_DONE)
+                {
+                    std::cerr << "Error deleting data: " << sqlite3_errmsg(db) << std::endl;
+                    sqlite3_reset(stmt);
+                    return false;
+                }
+                sqlite3_reset(stmt);
+            }
+            removedVerses++;
+        }
+
+        changedChapters++;
+        return saveHash(stored.firstId, hash);
+    }
+
+public:
+    size_t unchangedChapters = 0;
+    size_t changedChapters = 0;
+    size_t addedChapters = 0;
+    size_t skippedChapters = 0; // Would need new ids in the middle of the text
+    size_t updatedVerses = 0;
+    size_t addedVerses = 0;
+    size_t removedVerses = 0;
+
+    bool open(sqlite3 *database)
+    {
+        db = database;
+        foldOptions = loadFoldOptions(db);
+        code = getMeta(db, "base_translation", "base");
+
+        if (!stemIndex.open(db) || !minHashIndex.open(db))
+            return false;
+
+        const char *statements[] = {
+            "INSERT INTO bible (book, chapter, verse, text, folded, fold_map, word_count) VALUES (?, ?, ?, ?, ?, ?, ?)",
+            "SELECT text, folded FROM bible WHERE id = ?",
+            "UPDATE bible SET text = ?, folded = ?, fold_map = ?, word_count = ? WHERE id = ?",
+            "DELETE FROM bible WHERE id = ?",
+            "DELETE FROM annotations WHERE verse_id = ?",
+            "INSERT OR REPLACE INTO chapter_hashes (translation, first_id, hash) VALUES (?, ?, ?)"};
+        sqlite3_stmt **targets[] = {&insertVerse, &selectVerse, &updateVerse, &deleteVerse, &deleteAnnotations, &storeHash};
+
+        for (size_t i = 0; i < 6; i++)
+        {
+            if (sqlite3_prepare_v2(db, statements[i], -1, targets[i], nullptr) != SQLITE_OK)
+            {
+                std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+                return false;
+            }
+        }
+
+        // What the last import left behind
+        sqlite3_stmt *stmt;
+        if (sqlite3_prepare_v2(db, "SELECT id, book, chapter, verse FROM bible ORDER BY id", -1, &stmt, nullptr) != SQLITE_OK)
+        {
+            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+            return false;
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            int id = sqlite3_column_int(stmt, 0);
+            StoredChapter &chapter = stored[{reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1)), sqlite3_column_int(stmt, 2)}];
+            if (chapter.verseIds.empty())
+                chapter.firstId = id;
+            chapter.verseIds[sqlite3_column_int(stmt, 3)] = id;
+        }
+        sqlite3_finalize(stmt);
+
+        if (sqlite3_prepare_v2(db, "SELECT first_id, hash FROM chapter_hashes WHERE translation = ?", -1, &stmt, nullptr) != SQLITE_OK)
+        {
+            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+            return false;
+        }
+        sqlite3_bind_text(stmt, 1, code.c_str(), -1, SQLITE_STATIC);
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            hashes[sqlite3_column_int(stmt, 0)] = static_cast<uint64_t>(sqlite3_column_int64(stmt, 1));
+        }
+        sqlite3_finalize(stmt);
+
+        return true;
+    }
+
+    bool importChapter(const ImportedChapter &chapter)
+    {
+        uint64_t hash = chapterHash(chapter.verses);
+
+        auto found = stored.find({chapter.book, chapter.chapter});
+        if (found == stored.end())
+        {
+            // New chapters keep canonical order only when they follow everything stored
+            if (storedSeen < stored.size())
+            {
+                skippedChapters++;
+                return true;
+            }
+            return addChapter(chapter, hash);
+        }
+
+        StoredChapter &existing = found->second;
+        if (!existing.seen)
+        {
+            existing.seen = true;
+            storedSeen++;
+        }
+
+        if (storedHash(existing) == hash)
+        {
+            unchangedChapters++;
+            return true;
+        }
+
+        // Inserted verses would need ids between the existing ones
+        for (const auto &verse : chapter.verses)
+        {
+            if (!existing.verseIds.count(verse.first))
+            {
+                skippedChapters++;
+                return true;
+            }
+        }
+
+        return updateChapter(existing, chapter, hash);
+    }
+
+    // Chapters in the database that the file did not mention
+    size_t keptChapters() const { return stored.size() - storedSeen; }
+
+    void close()
+    {
+        for (sqlite3_stmt *stmt : {insertVerse, selectVerse, updateVerse, deleteVerse, deleteAnnotations, storeHash})
+            sqlite3_finalize(stmt);
+        insertVerse = selectVerse = updateVerse = deleteVerse = deleteAnnotations = storeHash = nullptr;
+        stemIndex.close();
+        minHashIndex.close();
+    }
+
+    ~BaseTextImport() { close(); }
+};
+
+// Utility to import Bible text from a CSV file. Re-importing a revised text
+// rewrites only the chapters whose content changed.
+bool importBibleFromCSV(const std::string &dbPath, const std::string &csvPath)
+{
+    sqlite3 *db;
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK)
+    {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    if (!ensureSchema(db))
+    {
+        sqlite3_close(db);
+        return false;
+    }
+
+    // Viewers keep reading their snapshot while the import writes
+    sqlite3_exec(db, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+
+    // Begin transaction for faster import
+    char *errMsg = nullptr;
+    if (sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, &errMsg) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        sqlite3_close(db);
+        return false;
+    }
+
+    BaseTextImport import;
+    if (!import.open(db))
+    {
+        import.close();
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        sqlite3_close(db);
+        return false;
+    }
+
+    // Open and read CSV file
+    CsvReader csv;
+    if (!csv.open(csvPath))
+    {
+        std::cerr << "Error opening CSV file: " << csvPath << std::endl;
+        import.close();
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        sqlite3_close(db);
+        return false;
+    }
+
+    // Skip header line if present
+    if (!csv.next())
+    {
+        std::cerr << "Error reading CSV file or file is empty." << std::endl;
+        import.close();
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        sqlite3_close(db);
+        return false;
+    }
+
+    // Process data lines a chapter at a time
+    ImportedChapter chapter;
+    bool ok = true;
+    while (ok && csv.next())
+    {
+        // Book, chapter, verse and text; malformed records are skipped
+        int chapterNumber, verse;
+        if (csv.fieldCount() < 4 || !csv.integer(1, chapterNumber) || !csv.integer(2, verse))
+            continue;
+
+        const std::string &book = csv.field(0);
+        const std::string &text = csv.field(3);
+
+        if (chapter.chapter != chapterNumber || chapter.book != book)
+        {
+            if (!chapter.verses.empty())
+                ok = import.importChapter(chapter);
+
+            chapter.book = book;
+            chapter.chapter = chapterNumber;
+            chapter.verses.clear();
+        }
+        chapter.verses.push_back({verse, text});
+    }
+
+    if (ok && !chapter.verses.empty())
+        ok = import.importChapter(chapter);
+
+    csv.close();
+    import.close();
+
+    // Commit transaction
+    if (!ok || sqlite3_exec(db, "COMMIT;", nullptr, nullptr, &errMsg) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << (errMsg ? errMsg : sqlite3_errmsg(db)) << std::endl;
+        sqlite3_free(errMsg);
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        sqlite3_close(db);
+        return false;
+    }
+
+    std::cout << "Chapters: " << import.unchangedChapters << " unchanged, " << import.changedChapters << " changed, "
+              << import.addedChapters << " added." << std::endl;
+    std::cout << "Verses: " << import.updatedVerses << " updated, " << import.addedVerses << " added, "
+              << import.removedVerses << " removed." << std::endl;
+    if (import.skippedChapters > 0)
+    {
+        std::cout << import.skippedChapters << " chapters add verses between existing ones and were skipped;"
+                  << " import them into a new database." << std::endl;
+    }
+    if (import.keptChapters() > 0)
+    {
+        std::cout << import.keptChapters() << " chapters missing from the file were left as they are." << std::endl;
+    }
+
+    sqlite3_close(db);
+    return true;
+}
+
+// Utility to import parallel translations from CSV files, several at once.
+// Verses are stored under the canonical id of the matching verse in the base text.
+bool importTranslationsFromCSV(const std::string &dbPath, std::vector<TranslationImport> &imports, size_t workers)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool ok = importTranslations(dbPath, imports, workers);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t verses = 0;
+    size_t csvBytes = 0;
+    for (const auto &import : imports)
+    {
+        if (!import.ok)
+        {
+            std::cout << "Failed to import translation " << import.code << " from " << import.csvPath << "." << std::endl;
+            continue;
+        }
+
+        verses += import.verses;
+        csvBytes += import.csvBytes;
+
+        std::cout << "Imported " << import.verses << " verses into translation " << import.code << " ("
+                  << formatBytes(import.csvBytes) << " in " << std::fixed << std::setprecision(1) << import.buildMs << " ms, "
+                  << std::setprecision(1) << (import.buildMs > 0 ? import.csvBytes / (import.buildMs / 1000.0) / 1048576.0 : 0.0)
+                  << " MiB/s)." << std::endl;
+        if (import.unmatched > 0)
+        {
+            std::cout << import.unmatched << " verses had no counterpart in the base text; add them to the versification map." << std::endl;
+        }
+
+        std::cout << import.changedChapters << " of " << import.chapters << " chapters changed (" << import.changedVerses
+                  << " verses); " << (import.incremental ? "rewrote only those with the existing dictionary." : "rebuilt every chapter.")
+                  << std::endl;
+
+        std::cout << "Compressed " << import.rawBytes << " bytes of text to " << import.compressedBytes << " bytes";
+        if (import.compressedBytes > 0)
+            std::cout << " (" << std::setprecision(2) << static_cast<double>(import.rawBytes) / import.compressedBytes << "x)";
+        std::cout << "." << std::endl;
+    }
+
+    if (imports.size() > 1)
+    {
+        std::cout << "Total: " << verses << " verses from " << imports.size() << " files, " << formatBytes(csvBytes)
+                  << " in " << std::setprecision(1) << elapsed * 1000.0 << " ms ("
+                  << (elapsed > 0 ? csvBytes / elapsed / 1048576.0 : 0.0) << " MiB/s)." << std::endl;
+    }
+
+    return ok;
+}
+
+// Utility to load a translation's versification differences from a CSV file
+// with the columns book, chapter, verse, canonical_book, canonical_chapter, canonical_verse
+bool importVersificationFromCSV(const std::string &dbPath, const std::string &code, const std::string &csvPath)
+{
+    sqlite3 *db;
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK)
+    {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    CsvReader csv;
+    if (!csv.open(csvPath))
+    {
+        std::cerr << "Error opening CSV file: " << csvPath << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    const char *insertSQL =
+        "INSERT OR REPLACE INTO versification "
+        "(translation, book, chapter, verse, canonical_book, canonical_chapter, canonical_verse) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?)";
+    sqlite3_stmt *stmt;
+
+    if (!ensureSchema(db) || sqlite3_prepare_v2(db, insertSQL, -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
+
+    int count = 0;
+    while (csv.next())
+    {
+        // Book, chapter, verse, then the same in the canonical numbering;
+        // anything else, such as a header, is skipped
+        int chapter, verse, canonicalChapter, canonicalVerse;
+        if (csv.fieldCount() < 6 || !csv.integer(1, chapter) || !csv.integer(2, verse) ||
+            !csv.integer(4, canonicalChapter) || !csv.integer(5, canonicalVerse))
+            continue;
+
+        sqlite3_bind_text(stmt, 1, code.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, csv.field(0).c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 3, chapter);
+        sqlite3_bind_int(stmt, 4, verse);
+        sqlite3_bind_text(stmt, 5, csv.field(3).c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 6, canonicalChapter);
+        sqlite3_bind_int(stmt, 7, canonicalVerse);
+
+        if (sqlite3_step(stmt) == SQLITE_DONE)
+            count++;
+        sqlite3_reset(stmt);
+    }
+
+    sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    std::cout << "Loaded " << count << " versification mappings for " << code << "." << std::endl;
+    return true;
+}
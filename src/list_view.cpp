@@ -0,0 +1,191 @@
+#include "../include/list_view.h"
+#include <algorithm>
+
+void ListView::setArea(WINDOW *target, int y, int x, int rows, int cols)
+{
+    window = target;
+    top = y;
+    left = x;
+    height = std::max(1, rows);
+    width = std::max(1, cols);
+    scrollToSelection();
+}
+
+void ListView::setColumns(int count)
+{
+    columns = std::max(1, count);
+    columnWidths.clear();
+    scrollToSelection();
+}
+
+void ListView::setColumnWidths(const std::vector<int> &widths)
+{
+    columnWidths = widths;
+    columns = std::max<int>(1, widths.size());
+    scrollToSelection();
+}
+
+void ListView::setColumnMajor(bool enabled)
+{
+    columnMajor = enabled;
+    scrollToSelection();
+}
+
+void ListView::setItemHeight(int lines)
+{
+    itemHeight = std::max(1, lines);
+    scrollToSelection();
+}
+
+void ListView::setItemCount(size_t count)
+{
+    itemCount = count;
+    selected = count ? std::min(selected, count - 1) : 0;
+    scrollToSelection();
+}
+
+size_t ListView::rowCount() const
+{
+    return (itemCount + columns - 1) / columns;
+}
+
+size_t ListView::rowOf(size_t index) const
+{
+    return columnMajor ? index % std::max<size_t>(1, rowCount()) : index / columns;
+}
+
+size_t ListView::columnOf(size_t index) const
+{
+    return columnMajor ? index / std::max<size_t>(1, rowCount()) : index % columns;
+}
+
+size_t ListView::indexAt(size_t row, size_t column) const
+{
+    return columnMajor ? column * rowCount() + row : row * columns + column;
+}
+
+int ListView::visibleRows() const
+{
+    return std::max(1, height / itemHeight);
+}
+
+void ListView::scrollToSelection()
+{
+    size_t row = rowOf(selected);
+    size_t rows = static_cast<size_t>(visibleRows());
+
+    if (row < firstRow)
+        firstRow = row;
+    else if (row >= firstRow + rows)
+        firstRow = row - rows + 1;
+
+    // Never leave blank rows at the bottom while there are items above
+    size_t total = rowCount();
+    if (total > rows)
+        firstRow = std::min(firstRow, total - rows);
+    else
+        firstRow = 0;
+}
+
+void ListView::select(size_t index)
+{
+    if (itemCount == 0)
+        return;
+
+    selected = std::min(index, itemCount - 1);
+    scrollToSelection();
+}
+
+bool ListView::handleKey(int key)
+{
+    if (itemCount == 0)
+        return false;
+
+    size_t last = itemCount - 1;
+    size_t row = rowOf(selected);
+    size_t column = columnOf(selected);
+    size_t rows = static_cast<size_t>(visibleRows());
+
+    switch (key)
+    {
+    case KEY_UP:
+        if (row > 0)
+            select(indexAt(row - 1, column));
+        return true;
+
+    case KEY_DOWN:
+        if (row + 1 < rowCount() && indexAt(row + 1, column) <= last)
+            select(indexAt(row + 1, column));
+        return true;
+
+    case KEY_LEFT:
+        if (columnMajor && column > 0)
+            select(indexAt(row, column - 1));
+        else if (!columnMajor && selected > 0)
+            select(selected - 1);
+        return true;
+
+    case KEY_RIGHT:
+        if (columnMajor && column + 1 < static_cast<size_t>(columns))
+            select(std::min(indexAt(row, column + 1), last));
+        else if (!columnMajor && selected < last)
+            select(selected + 1);
+        return true;
+
+    case KEY_NPAGE:
+    {
+        // Scroll the page with the cursor so it keeps its place on screen
+        size_t maxFirst = rowCount() > rows ? rowCount() - rows : 0;
+        firstRow = std::min(firstRow + rows, maxFirst);
+        select(std::min(indexAt(std::min(row + rows, rowCount() - 1), column), last));
+        return true;
+    }
+
+    case KEY_PPAGE:
+        firstRow = firstRow > rows ? firstRow - rows : 0;
+        select(indexAt(row > rows ? row - rows : 0, column));
+        return true;
+
+    case KEY_HOME:
+        select(0);
+        return true;
+
+    case KEY_END:
+        select(last);
+        return true;
+    }
+
+    return false;
+}
+
+void ListView::draw() const
+{
+    if (!window)
+        return;
+
+    for (int line = 0; line < height; line++)
+    {
+        mvwhline(window, top + line, left, ' ', width);
+    }
+
+    if (!drawItem)
+        return;
+
+    int rows = visibleRows();
+
+    for (int row = 0; row < rows && firstRow + row < rowCount(); row++)
+    {
+        int x = left;
+        for (int column = 0; column < columns; column++)
+        {
+            int cellWidth = columnWidths.empty() ? width / columns : columnWidths[column];
+            size_t index = indexAt(firstRow + row, column);
+
+            if (index < itemCount && x < left + width)
+            {
+                drawItem(window, index, top + row * itemHeight, x, std::min(cellWidth, left + width - x), index == selected);
+            }
+            x += cellWidth;
+        }
+    }
+}
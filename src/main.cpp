@@ -1,24 +1,26 @@
 #include <curses.h>
-#include <menu.h>
-#include <string.h>
-#include <cstdlib>
+#include <algorithm>
 #include <string>
-#include "../include/bible_database.h"
+#include "../include/corpus_store.h"
+#include "../include/verse_index.h"
 #include <iostream>
 #include "../include/utils.h"
+#include "../include/list_view.h"
+#include "../include/grid_layout.h"
 #include <locale.h>
 
-#define ARRAY_SIZE(a) (sizeof(a) / sizeof(a[0]))
-#define CTRLD 4
-
-void printVector(const std::vector<std::string> &vec)
+// Draw one label of a list, marking the cursor item while the list has focus
+ListView::DrawItem labelDrawer(const std::vector<std::string> *const &labels, const bool &focused)
 {
-    std::cout << "[ ";
-    for (const std::string &val : vec)
+    return [&labels, &focused](WINDOW *window, size_t index, int y, int x, int width, bool selected)
     {
-        std::cout << val << " ";
-    }
-    std::cout << "]" << std::endl;
+        bool mark = selected && focused;
+        if (mark)
+            wattron(window, A_REVERSE);
+        mvwprintw(window, y, x, "%s%.*s", mark ? " * " : "   ", std::max(0, width - 4), (*labels)[index].c_str());
+        if (mark)
+            wattroff(window, A_REVERSE);
+    };
 }
 
 int main()
@@ -36,202 +38,100 @@ int main()
         "   | |\n"
         "   '-'\n";
 
-    BibleDatabase db("../data/bible.db");
+    sqlite3 *db;
+    if (sqlite3_open("../data/bible.db", &db) != SQLITE_OK)
+    {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return 1;
+    }
+    SqliteCorpusStore store(db, true);
 
-    // Get all books
-    std::vector<std::string> oldTestamentBooks = db.get_old_testament_books();
-    oldTestamentBooks = reorderVector(oldTestamentBooks, 13, 3);
+    // Get all books, split into testaments by their canonical order
+    std::vector<std::string> oldTestamentBooks = store.books();
+    auto newTestamentStart = oldTestamentBooks.begin() + firstNewTestamentBook(oldTestamentBooks.size());
+    std::vector<std::string> newTestamentBooks(newTestamentStart, oldTestamentBooks.end());
+    oldTestamentBooks.erase(newTestamentStart, oldTestamentBooks.end());
 
-    std::vector<std::string> newTestamentBooks = db.get_new_testament_books();
-    newTestamentBooks = reorderVector(newTestamentBooks, 9, 3);
+    // Book grids sized to the terminal, whatever the number of books
+    GridLayout oldTestamentGrid;
+    oldTestamentGrid.measure(oldTestamentBooks.size(), [&](size_t i)
+                             { return displayWidth(oldTestamentBooks[i]) + 3; });
 
-    ITEM **my_items;
-    int c;
-    MENU *my_menu;
-    WINDOW *my_menu_win;
-    int n_choices, i;
+    GridLayout newTestamentGrid;
+    newTestamentGrid.measure(newTestamentBooks.size(), [&](size_t i)
+                             { return displayWidth(newTestamentBooks[i]) + 3; });
 
-    //     /* Initialize curses */
+    /* Initialize curses */
     initscr();
     start_color();
     cbreak();
     noecho();
     keypad(stdscr, TRUE);
+    curs_set(0);
     init_pair(1, COLOR_RED, COLOR_BLACK);
     init_pair(2, COLOR_CYAN, COLOR_BLACK);
 
     std::vector<std::string> testaments = {"The Old Testament", "The New Testament"};
-
-    int testament_choices = testaments.size();
-    ITEM **testament_items = (ITEM **)calloc(testament_choices + 1, sizeof(ITEM *));
-    for (int i = 0; i < testament_choices; ++i)
-        testament_items[i] = new_item(testaments[i].c_str(), testaments[i].c_str());
-
-    if (testament_items == nullptr)
-    {
-        std::cerr << "Memory allocation failed!" << std::endl;
-        return 1;
-    }
-
-    //     /* Crate menu */
-    MENU *testament_menu = new_menu((ITEM **)testament_items);
-
-    // /* Set menu option not to show the description */
-    menu_opts_off(testament_menu, O_SHOWDESC);
-
-    // // /* Create the window to be associated with the menu */
-    WINDOW *testament_menu_win = newwin(0, COLS, 20, 0);
-    keypad(testament_menu_win, TRUE);
-
-    // /* Set main window and sub window */
-    set_menu_win(testament_menu, testament_menu_win);
-    set_menu_sub(testament_menu, derwin(testament_menu_win, 2, 68, 0, 0));
-    set_menu_format(testament_menu, 1, 2);
-    set_menu_mark(testament_menu, " * ");
-
-    // // /* Print a border around the main window and print a title */
-    // box(testament_menu_win, 0, 0);
-
-    attron(COLOR_PAIR(2));
-    mvprintw(LINES - 3, 0, "Use PageUp and PageDown to scroll");
-    mvprintw(LINES - 2, 0, "Use Arrow Keys to navigate (F1 to Exit)");
-    mvprintw(0, (COLS) / 2, "KJV Bible");
-    // mvprintw(2, 0, "The Old Testament");
-    attroff(COLOR_PAIR(2));
-
-    int rows, cols;
-    getmaxyx(stdscr, rows, cols);
-
-    // Calculate the x position to center the ASCII art
-    int startX = (cols) / 2;
-
-    // Print each line of the ASCII art centered
-    char *line = strtok(strdup(text), "\n"); // Split into lines
-    int y = 2;                               // Start from the center row, adjust as needed
-
-    while (line != NULL)
+    const std::vector<std::string> *books = &oldTestamentBooks;
+    GridLayout *grid = &oldTestamentGrid;
+    bool booksFocused = false;
+    bool testamentsFocused = true;
+
+    // Testament picker under the book grid; the grid shows the picked testament
+    ListView testamentList;
+    const std::vector<std::string> *testamentLabels = &testaments;
+    testamentList.setColumns(2);
+    testamentList.setItemCount(testaments.size());
+    testamentList.setDrawItem(labelDrawer(testamentLabels, testamentsFocused));
+
+    ListView bookList;
+    bookList.setDrawItem(labelDrawer(books, booksFocused));
+
+    int c = 0;
+    while (c != KEY_F(1))
     {
-        mvprintw(y, startX, "%s", line);
-        line = strtok(NULL, "\n");
-        y++;
-    }
-
-    refresh();
-
-    // //     /* Post the menu */
-    post_menu(testament_menu);
-    wrefresh(testament_menu_win);
-
-    //     /* Create items */
-    // n_choices = ARRAY_SIZE(choices);
-
-    n_choices = oldTestamentBooks.size();
-    std::cout << n_choices << std::endl;
-
-    my_items = (ITEM **)calloc(n_choices + 1, sizeof(ITEM *));
-    for (i = 0; i < n_choices; ++i)
-        my_items[i] = new_item(oldTestamentBooks[i].c_str(), oldTestamentBooks[i].c_str());
-
-    if (my_items == nullptr)
-    {
-        std::cerr << "Memory allocation failed!" << std::endl;
-        return 1;
-    }
-
-    // // //     /* Crate menu */
-    my_menu = new_menu((ITEM **)my_items);
-
-    // // /* Set menu option not to show the description */
-    menu_opts_off(my_menu, O_SHOWDESC);
-
-    // // // /* Create the window to be associated with the menu */
-    my_menu_win = newwin(0, COLS, 4, 0);
-    keypad(my_menu_win, TRUE);
-
-    // // /* Set main window and sub window */
-    set_menu_win(my_menu, my_menu_win);
-    set_menu_sub(my_menu, derwin(my_menu_win, 14, 68, 0, 0));
-    set_menu_format(my_menu, 14, 3);
-    set_menu_mark(my_menu, " * ");
-
-    // // // /* Print a border around the main window and print a title */
-    // // // box(my_menu_win, 0, 0);
-
-    attron(COLOR_PAIR(2));
-    mvprintw(LINES - 3, 0, "Use PageUp and PageDown to scroll");
-    mvprintw(LINES - 2, 0, "Use Arrow Keys to navigate (F1 to Exit)");
-    mvprintw(0, (COLS) / 2, "KJV Bible");
-    mvprintw(2, 0, "The Old Testament");
-    attroff(COLOR_PAIR(2));
-    refresh();
-
-    // // //     /* Post the menu */
-    post_menu(my_menu);
-    wrefresh(my_menu_win);
-
-    while ((c = wgetch(testament_menu_win)) != KEY_F(1))
-    {
-        switch (c)
+        clear();
+
+        // Re-flow to the current terminal size; books start below the ASCII art
+        int bookRows = std::max(1, LINES - 18);
+        bookList.setArea(stdscr, 10, 0, bookRows, COLS);
+        grid->apply(bookList, COLS, bookRows);
+        testamentList.setArea(stdscr, LINES - 6, 0, 1, std::min(COLS, 68));
+
+        attron(COLOR_PAIR(2));
+        mvprintw(LINES - 4, 0, "Use Tab or Enter to switch between testaments and books");
+        mvprintw(LINES - 3, 0, "Use PageUp and PageDown to scroll");
+        mvprintw(LINES - 2, 0, "Use Arrow Keys to navigate (F1 to Exit)");
+        mvprintw(0, (COLS) / 2, "KJV Bible");
+        mvprintw(2, 0, "%s", testaments[testamentList.selection()].c_str());
+        attroff(COLOR_PAIR(2));
+
+        bookList.draw();
+        testamentList.draw();
+
+        // Print the ASCII art from the centre column
+        printMultilineAscii(2, COLS / 2, text);
+        refresh();
+
+        c = getch();
+        if (c == '\t' || c == '\n' || c == KEY_ENTER)
         {
-        case KEY_DOWN:
-            menu_driver(testament_menu, REQ_DOWN_ITEM);
-            break;
-        case KEY_UP:
-            menu_driver(testament_menu, REQ_UP_ITEM);
-            break;
-        case KEY_LEFT:
-            menu_driver(testament_menu, REQ_LEFT_ITEM);
-            break;
-        case KEY_RIGHT:
-            menu_driver(testament_menu, REQ_RIGHT_ITEM);
-            break;
-        case KEY_NPAGE:
-            menu_driver(testament_menu, REQ_SCR_DPAGE);
-            break;
-        case KEY_PPAGE:
-            menu_driver(testament_menu, REQ_SCR_UPAGE);
-            break;
+            booksFocused = !booksFocused;
+            testamentsFocused = !booksFocused;
         }
-        wrefresh(testament_menu_win);
-    }
-
-    //     /* Unpost and free all the memory taken up */
-    unpost_menu(testament_menu);
-    free_menu(testament_menu);
-    for (i = 0; i < testament_choices; ++i)
-        free_item(testament_items[i]);
-    endwin();
-
-    while ((c = wgetch(my_menu_win)) != KEY_F(1))
-    {
-        switch (c)
+        else if (booksFocused)
         {
-        case KEY_DOWN:
-            menu_driver(my_menu, REQ_DOWN_ITEM);
-            break;
-        case KEY_UP:
-            menu_driver(my_menu, REQ_UP_ITEM);
-            break;
-        case KEY_LEFT:
-            menu_driver(my_menu, REQ_LEFT_ITEM);
-            break;
-        case KEY_RIGHT:
-            menu_driver(my_menu, REQ_RIGHT_ITEM);
-            break;
-        case KEY_NPAGE:
-            menu_driver(my_menu, REQ_SCR_DPAGE);
-            break;
-        case KEY_PPAGE:
-            menu_driver(my_menu, REQ_SCR_UPAGE);
-            break;
+            bookList.handleKey(c);
+        }
+        else if (testamentList.handleKey(c))
+        {
+            bool oldTestament = testamentList.selection() == 0;
+            books = oldTestament ? &oldTestamentBooks : &newTestamentBooks;
+            grid = oldTestament ? &oldTestamentGrid : &newTestamentGrid;
+            bookList.select(0);
         }
-        wrefresh(my_menu_win);
     }
 
-    //     /* Unpost and free all the memory taken up */
-    unpost_menu(my_menu);
-    free_menu(my_menu);
-    for (i = 0; i < n_choices; ++i)
-        free_item(my_items[i]);
     endwin();
-}
\ No newline at end of file
+}
@@ -0,0 +1,114 @@
+#include "../include/memory_budget.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+double MemoryBudget::priority(double cost, size_t bytes) const
+{
+    return inflation + cost / static_cast<double>(bytes ? bytes : 1);
+}
+
+size_t MemoryBudget::bytesUsed() const
+{
+    size_t total = 0;
+    for (const BudgetedCache *cache : caches)
+        total += cache->bytesUsed();
+    return total;
+}
+
+void MemoryBudget::enforce()
+{
+    if (limit == 0)
+        return;
+
+    size_t used = bytesUsed();
+    while (used > limit)
+    {
+        BudgetedCache *victim = nullptr;
+        double lowest = std::numeric_limits<double>::infinity();
+
+        for (BudgetedCache *cache : caches)
+        {
+            double candidate = cache->oldestPriority();
+            if (candidate < lowest)
+            {
+                lowest = candidate;
+                victim = cache;
+            }
+        }
+
+        // Everything left is pinned
+        if (!victim)
+            break;
+
+        size_t freed = victim->evictOldest();
+        if (freed == 0)
+            break;
+
+        // Age the survivors so recently used entries outrank them
+        inflation = lowest;
+        evictions++;
+        used -= std::min(used, freed);
+    }
+}
+
+bool parseByteSize(const std::string &text, size_t &bytes)
+{
+    char *end = nullptr;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str())
+        return false;
+
+    std::string suffix(end);
+    for (char &c : suffix)
+        c = std::toupper(static_cast<unsigned char>(c));
+
+    if (suffix == "K" || suffix == "KB" || suffix == "KIB")
+        value <<= 10;
+    else if (suffix == "M" || suffix == "MB" || suffix == "MIB")
+        value <<= 20;
+    else if (suffix == "G" || suffix == "GB" || suffix == "GIB")
+        value <<= 30;
+    else if (!suffix.empty() && suffix != "B")
+        return false;
+
+    bytes = static_cast<size_t>(value);
+    return true;
+}
+
+std::string formatBytes(size_t bytes)
+{
+    char buffer[32];
+    if (bytes >= (1 << 20))
+        std::snprintf(buffer, sizeof(buffer), "%.1f MiB", bytes / 1048576.0);
+    else if (bytes >= (1 << 10))
+        std::snprintf(buffer, sizeof(buffer), "%.1f KiB", bytes / 1024.0);
+    else
+        std::snprintf(buffer, sizeof(buffer), "%zu B", bytes);
+    return buffer;
+}
+
+size_t heapBytes(const std::string &text)
+{
+    // Short strings live inside the object itself
+    const char *data = text.data();
+    const char *object = reinterpret_cast<const char *>(&text);
+    if (data >= object && data < object + sizeof(text))
+        return 0;
+    return text.capacity() + 1;
+}
+
+size_t verseBytes(const Verse &verse)
+{
+    return sizeof(Verse) + heapBytes(verse.book) + heapBytes(verse.text) + heapBytes(verse.folded) +
+           verse.foldMap.capacity() * sizeof(FoldAnchor);
+}
+
+size_t verseVectorBytes(const std::vector<Verse> &verses)
+{
+    size_t total = (verses.capacity() - verses.size()) * sizeof(Verse);
+    for (const Verse &verse : verses)
+        total += verseBytes(verse);
+    return total;
+}
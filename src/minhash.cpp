@@ -0,0 +1,325 @@
+#include "../include/minhash.h"
+#include "../include/tokenizer.h"
+#include <algorithm>
+#include <iostream>
+#include <set>
+
+static uint64_t mix(uint64_t key)
+{
+    // splitmix64 finalizer
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+static uint64_t hashWord(const std::string &word)
+{
+    // FNV-1a
+    uint64_t hash = 1469598103934665603ULL;
+    for (char c : word)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::vector<uint64_t> shingleHashes(const std::vector<std::string> &words)
+{
+    std::vector<uint64_t> shingles;
+
+    if (words.size() == 1)
+    {
+        shingles.push_back(mix(hashWord(words[0])));
+    }
+
+    for (size_t i = 0; i + 1 < words.size(); i++)
+    {
+        shingles.push_back(mix(hashWord(words[i]) * 31 + hashWord(words[i + 1])));
+    }
+
+    std::sort(shingles.begin(), shingles.end());
+    shingles.erase(std::unique(shingles.begin(), shingles.end()), shingles.end());
+    return shingles;
+}
+
+MinHashSignature minHashSignature(const std::vector<uint64_t> &shingles)
+{
+    MinHashSignature signature(MINHASH_HASHES, UINT32_MAX);
+
+    for (uint64_t shingle : shingles)
+    {
+        for (int i = 0; i < MINHASH_HASHES; i++)
+        {
+            // Each hash function is the mixer seeded with its index
+            uint32_t value = static_cast<uint32_t>(mix(shingle ^ (0x9e3779b97f4a7c15ULL * (i + 1))));
+            signature[i] = std::min(signature[i], value);
+        }
+    }
+
+    return signature;
+}
+
+uint32_t bandBucket(const MinHashSignature &signature, int band)
+{
+    uint64_t hash = band;
+    for (int row = 0; row < MINHASH_ROWS; row++)
+    {
+        hash = mix(hash * 31 + signature[band * MINHASH_ROWS + row]);
+    }
+    return static_cast<uint32_t>(hash);
+}
+
+double jaccard(const std::vector<uint64_t> &a, const std::vector<uint64_t> &b)
+{
+    if (a.empty() && b.empty())
+        return 0.0;
+
+    size_t common = 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.size() && j < b.size())
+    {
+        if (a[i] == b[j])
+        {
+            common++;
+            i++;
+            j++;
+        }
+        else if (a[i] < b[j])
+        {
+            i++;
+        }
+        else
+        {
+            j++;
+        }
+    }
+
+    return static_cast<double>(common) / (a.size() + b.size() - common);
+}
+
+bool MinHashIndexWriter::open(sqlite3 *database)
+{
+    db = database;
+
+    const char *signatureSQL = "INSERT OR REPLACE INTO minhash (verse_id, signature) VALUES (?, ?)";
+    const char *bucketSQL = "INSERT OR IGNORE INTO lsh_buckets (band, bucket, verse_id) VALUES (?, ?, ?)";
+
+    if (sqlite3_prepare_v2(db, signatureSQL, -1, &insertSignature, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, bucketSQL, -1, &insertBucket, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, "SELECT signature FROM minhash WHERE verse_id = ?", -1, &selectSignature, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, "DELETE FROM minhash WHERE verse_id = ?", -1, &deleteSignature, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, "DELETE FROM lsh_buckets WHERE band = ? AND bucket = ? AND verse_id = ?", -1, &deleteBucket, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool MinHashIndexWriter::addVerse(int verseId, const std::vector<std::string> &words)
+{
+    std::vector<uint64_t> shingles = shingleHashes(words);
+    if (shingles.empty())
+        return true;
+
+    MinHashSignature signature = minHashSignature(shingles);
+
+    sqlite3_bind_int(insertSignature, 1, verseId);
+    sqlite3_bind_blob(insertSignature, 2, signature.data(), signature.size() * sizeof(uint32_t), SQLITE_STATIC);
+    if (sqlite3_step(insertSignature) != SQLITE_DONE)
+    {
+        std::cerr << "Error inserting data: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_reset(insertSignature);
+        return false;
+    }
+    sqlite3_reset(insertSignature);
+
+    for (int band = 0; band < MINHASH_BANDS; band++)
+    {
+        sqlite3_bind_int(insertBucket, 1, band);
+        sqlite3_bind_int64(insertBucket, 2, bandBucket(signature, band));
+        sqlite3_bind_int(insertBucket, 3, verseId);
+        sqlite3_step(insertBucket);
+        sqlite3_reset(insertBucket);
+    }
+
+    return true;
+}
+
+bool MinHashIndexWriter::removeVerse(int verseId)
+{
+    // The bucket table is keyed by (band, bucket), so recompute them from the old signature
+    MinHashSignature signature;
+    sqlite3_bind_int(selectSignature, 1, verseId);
+    if (sqlite3_step(selectSignature) == SQLITE_ROW && sqlite3_column_bytes(selectSignature, 0) == MINHASH_HASHES * sizeof(uint32_t))
+    {
+        const uint32_t *stored = static_cast<const uint32_t *>(sqlite3_column_blob(selectSignature, 0));
+        signature.assign(stored, stored + MINHASH_HASHES);
+    }
+    sqlite3_reset(selectSignature);
+
+    if (signature.empty())
+        return true;
+
+    for (int band = 0; band < MINHASH_BANDS; band++)
+    {
+        sqlite3_bind_int(deleteBucket, 1, band);
+        sqlite3_bind_int64(deleteBucket, 2, bandBucket(signature, band));
+        sqlite3_bind_int(deleteBucket, 3, verseId);
+        sqlite3_step(deleteBucket);
+        sqlite3_reset(deleteBucket);
+    }
+
+    sqlite3_bind_int(deleteSignature, 1, verseId);
+    bool ok = sqlite3_step(deleteSignature) == SQLITE_DONE;
+    sqlite3_reset(deleteSignature);
+
+    if (!ok)
+        std::cerr << "Error deleting data: " << sqlite3_errmsg(db) << std::endl;
+    return ok;
+}
+
+void MinHashIndexWriter::close()
+{
+    sqlite3_finalize(insertSignature);
+    sqlite3_finalize(insertBucket);
+    sqlite3_finalize(selectSignature);
+    sqlite3_finalize(deleteSignature);
+    sqlite3_finalize(deleteBucket);
+    insertSignature = nullptr;
+    insertBucket = nullptr;
+    selectSignature = nullptr;
+    deleteSignature = nullptr;
+    deleteBucket = nullptr;
+}
+
+MinHashIndexWriter::~MinHashIndexWriter()
+{
+    close();
+}
+
+bool rebuildMinHashIndex(sqlite3 *db)
+{
+    char *errMsg = nullptr;
+    if (sqlite3_exec(db, "BEGIN TRANSACTION; DELETE FROM minhash; DELETE FROM lsh_buckets;", nullptr, nullptr, &errMsg) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+
+    MinHashIndexWriter writer;
+    sqlite3_stmt *stmt;
+
+    if (!writer.open(db) ||
+        sqlite3_prepare_v2(db, "SELECT id, folded FROM bible ORDER BY id", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        const unsigned char *folded = sqlite3_column_text(stmt, 1);
+        if (folded)
+        {
+            writer.addVerse(sqlite3_column_int(stmt, 0), tokenize(reinterpret_cast<const char *>(folded)));
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    writer.close();
+
+    if (sqlite3_exec(db, "COMMIT;", nullptr, nullptr, &errMsg) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+
+    return true;
+}
+
+// Shingles of a verse, recomputed from its folded text
+static std::vector<uint64_t> verseShingles(sqlite3_stmt *selectFolded, int verseId)
+{
+    std::vector<uint64_t> shingles;
+
+    sqlite3_bind_int(selectFolded, 1, verseId);
+    if (sqlite3_step(selectFolded) == SQLITE_ROW && sqlite3_column_text(selectFolded, 0))
+    {
+        shingles = shingleHashes(tokenize(reinterpret_cast<const char *>(sqlite3_column_text(selectFolded, 0))));
+    }
+    sqlite3_reset(selectFolded);
+
+    return shingles;
+}
+
+std::vector<RelatedVerse> findRelatedVerses(sqlite3 *db, int verseId, size_t count)
+{
+    std::vector<RelatedVerse> related;
+    sqlite3_stmt *selectSignature;
+    sqlite3_stmt *selectBucket;
+    sqlite3_stmt *selectFolded;
+
+    if (sqlite3_prepare_v2(db, "SELECT signature FROM minhash WHERE verse_id = ?", -1, &selectSignature, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return related;
+    }
+
+    sqlite3_prepare_v2(db, "SELECT verse_id FROM lsh_buckets WHERE band = ? AND bucket = ?", -1, &selectBucket, nullptr);
+    sqlite3_prepare_v2(db, "SELECT folded FROM bible WHERE id = ?", -1, &selectFolded, nullptr);
+
+    MinHashSignature signature;
+    sqlite3_bind_int(selectSignature, 1, verseId);
+    if (sqlite3_step(selectSignature) == SQLITE_ROW &&
+        sqlite3_column_bytes(selectSignature, 0) == static_cast<int>(MINHASH_HASHES * sizeof(uint32_t)))
+    {
+        const uint32_t *values = static_cast<const uint32_t *>(sqlite3_column_blob(selectSignature, 0));
+        signature.assign(values, values + MINHASH_HASHES);
+    }
+    sqlite3_finalize(selectSignature);
+
+    // Candidates are the verses sharing at least one band bucket
+    std::set<int> candidates;
+    for (int band = 0; band < MINHASH_BANDS && !signature.empty(); band++)
+    {
+        sqlite3_bind_int(selectBucket, 1, band);
+        sqlite3_bind_int64(selectBucket, 2, bandBucket(signature, band));
+        while (sqlite3_step(selectBucket) == SQLITE_ROW)
+        {
+            int candidate = sqlite3_column_int(selectBucket, 0);
+            if (candidate != verseId)
+                candidates.insert(candidate);
+        }
+        sqlite3_reset(selectBucket);
+    }
+
+    // Re-rank candidates by their exact similarity
+    std::vector<uint64_t> shingles = verseShingles(selectFolded, verseId);
+    for (int candidate : candidates)
+    {
+        double similarity = jaccard(shingles, verseShingles(selectFolded, candidate));
+        if (similarity > 0.0)
+            related.push_back({candidate, similarity});
+    }
+
+    sqlite3_finalize(selectBucket);
+    sqlite3_finalize(selectFolded);
+
+    std::sort(related.begin(), related.end(), [](const RelatedVerse &a, const RelatedVerse &b)
+              { return a.similarity != b.similarity ? a.similarity > b.similarity : a.verseId < b.verseId; });
+
+    if (related.size() > count)
+        related.resize(count);
+
+    return related;
+}
@@ -0,0 +1,47 @@
+#include "../include/parallel.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+size_t workerCount()
+{
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : hw;
+}
+
+void parallelFor(size_t count, const std::function<void(size_t, size_t, size_t)> &fn, size_t shards)
+{
+    if (shards == 0)
+        shards = workerCount();
+
+    // Don't spin up threads for shards that would have nothing to do
+    shards = std::max<size_t>(1, std::min(shards, count));
+
+    size_t chunk = count / shards;
+    size_t remainder = count % shards;
+
+    std::vector<std::thread> threads;
+    threads.reserve(shards - 1);
+
+    size_t begin = 0;
+    for (size_t shard = 0; shard < shards; shard++)
+    {
+        size_t end = begin + chunk + (shard < remainder ? 1 : 0);
+
+        if (shard == shards - 1)
+        {
+            fn(begin, end, shard);
+        }
+        else
+        {
+            threads.emplace_back(fn, begin, end, shard);
+        }
+
+        begin = end;
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
@@ -0,0 +1,141 @@
+#include "../include/plan_command.h"
+#include "../include/reading_plan.h"
+#include "../include/verse_index.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <unistd.h>
+
+bool parseDayCounts(const std::string &text, std::vector<int> &dayCounts)
+{
+    for (size_t start = 0; start <= text.size();)
+    {
+        size_t comma = std::min(text.find(',', start), text.size());
+        std::string item = text.substr(start, comma - start);
+        start = comma + 1;
+
+        int low = 0, high = 0;
+        char extra;
+        int fields = sscanf(item.c_str(), "%d-%d%c", &low, &high, &extra);
+        if (fields == 1)
+            high = low;
+        else if (fields != 2)
+            return false;
+        if (low < 1 || high < low)
+            return false;
+
+        for (int days = low; days <= high; days++)
+            dayCounts.push_back(days);
+    }
+    return !dayCounts.empty();
+}
+
+bool planCommand(const std::string &dbPath, const std::vector<int> &dayCounts, const std::string &range, long startDate,
+                 const std::string &outPath, std::string *opening)
+{
+    sqlite3 *db;
+    if (sqlite3_open_v2(dbPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    VerseIndex index;
+    WordPrefix prefix;
+    bool loaded = index.load(db) && prefix.load(db, index);
+    sqlite3_close(db);
+    if (!loaded || index.totalVerses() == 0)
+    {
+        std::cerr << "No verses found in the database." << std::endl;
+        return false;
+    }
+
+    int first = 0;
+    int last = index.totalVerses() - 1;
+    if (!range.empty())
+    {
+        VersePosition from, to;
+        if (!index.parseRange(range, from, to))
+        {
+            std::cerr << "Unknown reference or range: " << range << std::endl;
+            return false;
+        }
+        first = index.absolute(from);
+        last = index.absolute(to);
+    }
+
+    // Checked up front so a bad count leaves no half-written output
+    int most = *std::max_element(dayCounts.begin(), dayCounts.end());
+    if (most > last - first + 1)
+    {
+        std::cerr << "Cannot split " << last - first + 1 << " verses into " << most << " days." << std::endl;
+        return false;
+    }
+
+    int fd = opening && outPath.empty() ? -1 : STDOUT_FILENO;
+    if (!outPath.empty())
+    {
+        fd = open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            std::cerr << "Error writing file: " << outPath << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<PlanDay> schedule;
+    double planMs = 0.0;
+    bool written = true;
+    int error = 0;
+    {
+        OutputBuffer out(fd < 0 ? STDOUT_FILENO : fd);
+        if (dayCounts.size() > 1 && fd >= 0)
+            out.append("[\n", 2);
+
+        for (size_t i = 0; i < dayCounts.size(); i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            partitionPlan(prefix, first, last, dayCounts[i], schedule);
+            planMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            if (fd < 0)
+                continue;
+            writePlanJson(out, index, schedule, startDate);
+            out.append(i + 1 < dayCounts.size() ? ",\n" : "\n", i + 1 < dayCounts.size() ? 2 : 1);
+        }
+
+        if (dayCounts.size() > 1 && fd >= 0)
+            out.append("]\n", 2);
+        written = out.flush();
+        error = errno;
+    }
+
+    if (fd > STDOUT_FILENO)
+        close(fd);
+
+    if (!written)
+    {
+        std::cerr << "Error writing output: " << strerror(error) << std::endl;
+        return false;
+    }
+
+    if (opening)
+        *opening = index.reference(index.position(schedule[planDayOn(today(), startDate, schedule.size())].first));
+
+    // Timings go to stderr when the plans themselves are on stdout
+    if (!outPath.empty())
+    {
+        std::cerr << dayCounts.size() << " plans over " << last - first + 1 << " verses in " << std::fixed << std::setprecision(2)
+                  << planMs << " ms (" << std::setprecision(1) << planMs * 1000.0 / dayCounts.size() << " us per plan), written to "
+                  << outPath << std::endl;
+    }
+
+    return true;
+}
@@ -0,0 +1,184 @@
+#include "../include/reading_plan.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <unordered_map>
+
+bool WordPrefix::load(sqlite3 *db, const VerseIndex &index)
+{
+    std::unordered_map<std::string, int> bookIndex;
+    for (size_t i = 0; i < index.bookCount(); i++)
+        bookIndex[index.bookName(static_cast<int>(i))] = static_cast<int>(i);
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT book, chapter, verse, word_count FROM bible", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    // Counts go in first, one slot ahead, then are summed in place
+    sums.assign(index.totalVerses() + 1, 0);
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        auto book = bookIndex.find(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0)));
+        if (book == bookIndex.end())
+            continue;
+
+        VersePosition position;
+        position.book = book->second;
+        position.chapter = sqlite3_column_int(stmt, 1);
+        position.verse = sqlite3_column_int(stmt, 2);
+
+        int absolute = index.absolute(position);
+        if (absolute >= 0)
+            sums[absolute + 1] = std::max(0, sqlite3_column_int(stmt, 3));
+    }
+
+    sqlite3_finalize(stmt);
+
+    for (size_t i = 1; i < sums.size(); i++)
+        sums[i] += sums[i - 1];
+    return true;
+}
+
+bool partitionPlan(const WordPrefix &prefix, int first, int last, int days, std::vector<PlanDay> &schedule)
+{
+    schedule.clear();
+    if (days < 1 || last < first || last - first + 1 < days)
+        return false;
+
+    long long base = prefix.before(first);
+    long long total = prefix.words(first, last);
+    schedule.reserve(days);
+
+    // Day d ends before verse 'end'; the cut moves forward only, so the whole
+    // plan is a single pass over the range
+    int start = first;
+    for (int d = 1; d <= days; d++)
+    {
+        int end = last + 1;
+        if (d < days)
+        {
+            long long target = base + (total * d + days / 2) / days;
+            int latest = last + 1 - (days - d); // Leave a verse for each day after this
+            end = start + 1;
+            while (end < latest && prefix.before(end + 1) <= target)
+                end++;
+            if (end < latest && prefix.before(end + 1) - target < target - prefix.before(end))
+                end++;
+        }
+
+        schedule.push_back({start, end - 1, prefix.words(start, end - 1)});
+        start = end;
+    }
+
+    return true;
+}
+
+// Howard Hinnant's civil calendar conversions, valid for any Gregorian date
+long daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    long era = (year >= 0 ? year : year - 399) / 400;
+    long yearOfEra = year - era * 400;
+    long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+std::string civilDate(long days)
+{
+    days += 719468;
+    long era = (days >= 0 ? days : days - 146096) / 146097;
+    long dayOfEra = days - era * 146097;
+    long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    long monthIndex = (5 * dayOfYear + 2) / 153;
+    int day = static_cast<int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    int month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    long year = yearOfEra + era * 400 + (month <= 2);
+
+    // Room for any long year, so the date is never cut short
+    char text[32];
+    snprintf(text, sizeof(text), "%04ld-%02d-%02d", year, month, day);
+    return text;
+}
+
+bool parseDate(const std::string &text, long &days)
+{
+    int year, month, day;
+    char extra;
+    if (sscanf(text.c_str(), "%4d-%2d-%2d%c", &year, &month, &day, &extra) != 3 || month < 1 || month > 12 || day < 1)
+        return false;
+
+    days = daysFromCivil(year, month, day);
+
+    // Reject the 31st of a 30-day month and the like
+    return civilDate(days) == text;
+}
+
+long today()
+{
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+    return daysFromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday);
+}
+
+int planDayOn(long date, long startDate, size_t dayCount)
+{
+    long day = std::max(0L, std::min(date - startDate, static_cast<long>(dayCount) - 1));
+    return static_cast<int>(day);
+}
+
+static void appendReference(OutputBuffer &out, const VerseIndex &index, int absolute)
+{
+    std::string reference = index.reference(index.position(absolute));
+    appendJsonString(out, reference.data(), reference.size());
+}
+
+void writePlanJson(OutputBuffer &out, const VerseIndex &index, const std::vector<PlanDay> &schedule, long startDate)
+{
+    if (schedule.empty())
+        return;
+
+    long long words = 0;
+    for (const PlanDay &day : schedule)
+        words += day.words;
+
+    out.append("{\"from\": ", 9);
+    appendReference(out, index, schedule.front().first);
+    out.append(", \"to\": ", 8);
+    appendReference(out, index, schedule.back().last);
+    out.append(", \"start\": \"", 12);
+    std::string start = civilDate(startDate);
+    out.append(start.data(), start.size());
+    out.append("\", \"days\": ", 11);
+    out.appendInt(static_cast<long long>(schedule.size()));
+    out.append(", \"words\": ", 11);
+    out.appendInt(words);
+    out.append(",\n \"schedule\": [\n", 17);
+
+    for (size_t i = 0; i < schedule.size(); i++)
+    {
+        const PlanDay &day = schedule[i];
+        out.append("  {\"day\": ", 10);
+        out.appendInt(static_cast<long long>(i + 1));
+        out.append(", \"date\": \"", 11);
+        std::string date = civilDate(startDate + static_cast<long>(i));
+        out.append(date.data(), date.size());
+        out.append("\", \"from\": ", 11);
+        appendReference(out, index, day.first);
+        out.append(", \"to\": ", 8);
+        appendReference(out, index, day.last);
+        out.append(", \"verses\": ", 12);
+        out.appendInt(day.last - day.first + 1);
+        out.append(", \"words\": ", 11);
+        out.appendInt(day.words);
+        out.append(i + 1 < schedule.size() ? "},\n" : "}\n", i + 1 < schedule.size() ? 3 : 2);
+    }
+
+    out.append(" ]}", 3);
+}
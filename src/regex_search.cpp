@@ -0,0 +1,272 @@
+#include "../include/regex_search.h"
+#include "../include/parallel.h"
+#include <cctype>
+#include <cstring>
+
+bool RegexSearch::compile(const std::string &source, const FoldOptions &options, std::string &error)
+{
+    compiled = false;
+    std::string folded = foldPattern(source, options);
+
+    try
+    {
+        pattern = std::regex(folded, std::regex::ECMAScript | std::regex::optimize);
+    }
+    catch (const std::regex_error &e)
+    {
+        error = e.what();
+        return false;
+    }
+
+    literal = extractRequiredLiteral(folded);
+    compiled = true;
+    return true;
+}
+
+std::vector<size_t> RegexSearch::search(const std::vector<Verse> &verses) const
+{
+    std::vector<size_t> results;
+
+    if (!compiled)
+        return results;
+
+    size_t shards = workerCount();
+    std::vector<std::vector<size_t>> shardResults(shards);
+
+    parallelFor(verses.size(), [&](size_t begin, size_t end, size_t shard)
+                {
+                    std::vector<size_t> &hits = shardResults[shard];
+
+                    for (size_t i = begin; i < end; i++)
+                    {
+                        const std::string &text = verses[i].folded;
+
+                        // Skip verses that can't match before paying for the regex engine
+                        if (!literal.empty() &&
+                            memmem(text.data(), text.size(), literal.data(), literal.size()) == nullptr)
+                        {
+                            continue;
+                        }
+
+                        if (std::regex_search(text, pattern))
+                        {
+                            hits.push_back(i);
+                        }
+                    } },
+                shards);
+
+    // Shards are contiguous, so concatenating them keeps corpus order
+    for (const auto &hits : shardResults)
+    {
+        results.insert(results.end(), hits.begin(), hits.end());
+    }
+
+    return results;
+}
+
+void RegexSearch::matchSpans(const std::string &text, std::vector<HitSpan> &spans) const
+{
+    if (!compiled || (!literal.empty() && memmem(text.data(), text.size(), literal.data(), literal.size()) == nullptr))
+        return;
+
+    for (std::sregex_iterator match(text.begin(), text.end(), pattern), end; match != end; ++match)
+    {
+        if (match->length(0) > 0)
+        {
+            size_t begin = static_cast<size_t>(match->position(0));
+            spans.push_back({begin, begin + static_cast<size_t>(match->length(0))});
+        }
+    }
+}
+
+// Index of the last character of the escape whose backslash is at i. Most
+// escapes are one character, but \xHH, \uHHHH, \cX and back-references such
+// as \12 run on, and none of what follows the backslash is literal text.
+static size_t escapeEnd(const std::string &source, size_t i)
+{
+    size_t end = i + 1;
+    if (end >= source.length())
+        return end;
+
+    char kind = source[end];
+    size_t hexDigits = kind == 'x' ? 2 : kind == 'u' ? 4 : 0;
+    if (hexDigits > 0)
+    {
+        while (hexDigits > 0 && end + 1 < source.length() && std::isxdigit(static_cast<unsigned char>(source[end + 1])))
+        {
+            end++;
+            hexDigits--;
+        }
+    }
+    else if (kind == 'c')
+    {
+        if (end + 1 < source.length() && std::isalpha(static_cast<unsigned char>(source[end + 1])))
+            end++;
+    }
+    else if (std::isdigit(static_cast<unsigned char>(kind)))
+    {
+        while (end + 1 < source.length() && std::isdigit(static_cast<unsigned char>(source[end + 1])))
+            end++;
+    }
+    return end;
+}
+
+std::string RegexSearch::extractRequiredLiteral(const std::string &source)
+{
+    // A top-level alternation means no single literal is required
+    int depth = 0;
+    for (size_t i = 0; i < source.length(); i++)
+    {
+        char c = source[i];
+        if (c == '\\')
+        {
+            i = escapeEnd(source, i);
+        }
+        else if (c == '[')
+        {
+            // Skip the character class; ']' right after '[' or '[^' is literal
+            i++;
+            if (i < source.length() && source[i] == '^')
+                i++;
+            if (i < source.length() && source[i] == ']')
+                i++;
+            while (i < source.length() && source[i] != ']')
+            {
+                if (source[i] == '\\')
+                    i = escapeEnd(source, i);
+                i++;
+            }
+        }
+        else if (c == '(')
+        {
+            depth++;
+        }
+        else if (c == ')')
+        {
+            depth--;
+        }
+        else if (c == '|' && depth == 0)
+        {
+            return "";
+        }
+    }
+
+    std::string best;
+    std::string current;
+    depth = 0;
+
+    auto flush = [&]()
+    {
+        if (current.length() > best.length())
+        {
+            best = current;
+        }
+        current.clear();
+    };
+
+    for (size_t i = 0; i < source.length(); i++)
+    {
+        char c = source[i];
+
+        switch (c)
+        {
+        case '\\':
+        {
+            if (i + 1 >= source.length())
+            {
+                flush();
+                break;
+            }
+
+            char next = source[i + 1];
+            i = escapeEnd(source, i);
+
+            // \b, \w, \x6C, back-references etc. aren't literals; escaped punctuation is
+            if (std::isalnum(static_cast<unsigned char>(next)) || depth > 0)
+            {
+                flush();
+            }
+            else
+            {
+                current += next;
+            }
+            break;
+        }
+
+        case '[':
+            flush();
+            i++;
+            if (i < source.length() && source[i] == '^')
+                i++;
+            if (i < source.length() && source[i] == ']')
+                i++;
+            while (i < source.length() && source[i] != ']')
+            {
+                if (source[i] == '\\')
+                    i = escapeEnd(source, i);
+                i++;
+            }
+            break;
+
+        case '(':
+            depth++;
+            flush();
+            break;
+
+        case ')':
+            depth--;
+            flush();
+            break;
+
+        case '*':
+        case '?':
+        case '{':
+            // The preceding atom may be absent, so it can't be part of the literal
+            if (!current.empty())
+            {
+                current.pop_back();
+            }
+            flush();
+            if (c == '{')
+            {
+                while (i < source.length() && source[i] != '}')
+                    i++;
+            }
+            break;
+
+        case '+':
+            // The preceding atom is required but may repeat, which ends the run
+            flush();
+            break;
+
+        case '.':
+        case '^':
+        case '$':
+            flush();
+            break;
+
+        default:
+            if (depth > 0)
+            {
+                flush();
+            }
+            else
+            {
+                current += c;
+            }
+            break;
+        }
+    }
+
+    flush();
+    return best;
+}
+
+bool parseRegexQuery(const std::string &term, std::string &pattern)
+{
+    if (term.length() < 2 || term.front() != '/' || term.back() != '/')
+        return false;
+
+    pattern = term.substr(1, term.length() - 2);
+    return !pattern.empty();
+}
@@ -0,0 +1,289 @@
+#include "../include/schema.h"
+#include "../include/stem_index.h"
+#include "../include/minhash.h"
+#include <iostream>
+#include <set>
+
+static bool execSQL(sqlite3 *db, const char *sql)
+{
+    char *errMsg = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
+static std::set<std::string> tableColumns(sqlite3 *db, const std::string &table)
+{
+    std::set<std::string> columns;
+    std::string query = "PRAGMA table_info(" + table + ")";
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+        return columns;
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        columns.insert(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1)));
+    }
+
+    sqlite3_finalize(stmt);
+    return columns;
+}
+
+static bool tableExists(sqlite3 *db, const std::string &table)
+{
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT name FROM sqlite_master WHERE type='table' AND name = ?", -1, &stmt, nullptr) != SQLITE_OK)
+        return false;
+
+    sqlite3_bind_text(stmt, 1, table.c_str(), -1, SQLITE_STATIC);
+    bool exists = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
+// Compute the folded shadow text for rows that don't have one yet
+static bool backfillFoldedText(sqlite3 *db)
+{
+    FoldOptions options = loadFoldOptions(db);
+
+    sqlite3_stmt *select;
+    sqlite3_stmt *update;
+
+    if (sqlite3_prepare_v2(db, "SELECT id, text FROM bible WHERE folded IS NULL", -1, &select, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    if (sqlite3_prepare_v2(db, "UPDATE bible SET folded = ?, fold_map = ? WHERE id = ?", -1, &update, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_finalize(select);
+        return false;
+    }
+
+    if (!execSQL(db, "BEGIN TRANSACTION;"))
+    {
+        sqlite3_finalize(select);
+        sqlite3_finalize(update);
+        return false;
+    }
+
+    while (sqlite3_step(select) == SQLITE_ROW)
+    {
+        std::string text = reinterpret_cast<const char *>(sqlite3_column_text(select, 1));
+        FoldMap map;
+        std::string folded = foldText(text, options, &map);
+        std::string encodedMap = encodeFoldMap(map);
+
+        sqlite3_bind_text(update, 1, folded.c_str(), folded.length(), SQLITE_STATIC);
+        sqlite3_bind_blob(update, 2, encodedMap.data(), encodedMap.length(), SQLITE_STATIC);
+        sqlite3_bind_int(update, 3, sqlite3_column_int(select, 0));
+
+        if (sqlite3_step(update) != SQLITE_DONE)
+        {
+            std::cerr << "Error updating data: " << sqlite3_errmsg(db) << std::endl;
+        }
+        sqlite3_reset(update);
+    }
+
+    sqlite3_finalize(select);
+    sqlite3_finalize(update);
+    return execSQL(db, "COMMIT;");
+}
+
+bool ensureSchema(sqlite3 *db)
+{
+    const char *createTablesSQL =
+        "CREATE TABLE IF NOT EXISTS bible ("
+        "    id INTEGER PRIMARY KEY,"
+        "    book TEXT NOT NULL,"
+        "    chapter INTEGER NOT NULL,"
+        "    verse INTEGER NOT NULL,"
+        "    text TEXT NOT NULL,"
+        "    folded TEXT,"
+        "    fold_map BLOB,"
+        "    word_count INTEGER"
+        ");"
+        "CREATE TABLE IF NOT EXISTS meta ("
+        "    key TEXT PRIMARY KEY,"
+        "    value TEXT NOT NULL"
+        ");";
+
+    // Stem -> verse index with term frequencies, and the surface forms seen for each stem
+    const char *createStemTablesSQL =
+        "CREATE TABLE IF NOT EXISTS stem_postings ("
+        "    stem TEXT NOT NULL,"
+        "    verse_id INTEGER NOT NULL,"
+        "    tf INTEGER NOT NULL,"
+        "    PRIMARY KEY (stem, verse_id)"
+        ") WITHOUT ROWID;"
+        "CREATE TABLE IF NOT EXISTS stem_forms ("
+        "    stem TEXT NOT NULL,"
+        "    form TEXT NOT NULL,"
+        "    PRIMARY KEY (stem, form)"
+        ") WITHOUT ROWID;";
+
+    // MinHash signatures and LSH band buckets for related-verse lookups
+    const char *createMinHashTablesSQL =
+        "CREATE TABLE IF NOT EXISTS minhash ("
+        "    verse_id INTEGER PRIMARY KEY,"
+        "    signature BLOB NOT NULL"
+        ");"
+        "CREATE TABLE IF NOT EXISTS lsh_buckets ("
+        "    band INTEGER NOT NULL,"
+        "    bucket INTEGER NOT NULL,"
+        "    verse_id INTEGER NOT NULL,"
+        "    PRIMARY KEY (band, bucket, verse_id)"
+        ") WITHOUT ROWID;";
+
+    // Parallel translations keyed by canonical verse id, plus per-translation
+    // versification differences mapped onto the base text's references.
+    // Compacted translations move from translation_text into compressed
+    // chapter blocks with a trained symbol table. Each chapter's content hash
+    // (keyed by its first canonical id; the base text under its own code)
+    // lets a re-import skip the chapters that did not change.
+    const char *createTranslationTablesSQL =
+        "CREATE TABLE IF NOT EXISTS translations ("
+        "    code TEXT PRIMARY KEY,"
+        "    name TEXT"
+        ");"
+        "CREATE TABLE IF NOT EXISTS translation_text ("
+        "    translation TEXT NOT NULL,"
+        "    verse_id INTEGER NOT NULL,"
+        "    text TEXT NOT NULL,"
+        "    PRIMARY KEY (translation, verse_id)"
+        ") WITHOUT ROWID;"
+        "CREATE TABLE IF NOT EXISTS versification ("
+        "    translation TEXT NOT NULL,"
+        "    book TEXT NOT NULL,"
+        "    chapter INTEGER NOT NULL,"
+        "    verse INTEGER NOT NULL,"
+        "    canonical_book TEXT NOT NULL,"
+        "    canonical_chapter INTEGER NOT NULL,"
+        "    canonical_verse INTEGER NOT NULL,"
+        "    PRIMARY KEY (translation, book, chapter, verse)"
+        ") WITHOUT ROWID;"
+        "CREATE TABLE IF NOT EXISTS codec_dictionaries ("
+        "    translation TEXT PRIMARY KEY,"
+        "    symbols BLOB NOT NULL"
+        ");"
+        "CREATE TABLE IF NOT EXISTS text_blocks ("
+        "    translation TEXT NOT NULL,"
+        "    first_id INTEGER NOT NULL,"
+        "    verse_count INTEGER NOT NULL,"
+        "    data BLOB NOT NULL,"
+        "    PRIMARY KEY (translation, first_id)"
+        ") WITHOUT ROWID;"
+        "CREATE TABLE IF NOT EXISTS chapter_hashes ("
+        "    translation TEXT NOT NULL,"
+        "    first_id INTEGER NOT NULL,"
+        "    hash INTEGER NOT NULL,"
+        "    PRIMARY KEY (translation, first_id)"
+        ") WITHOUT ROWID;"
+        "CREATE INDEX IF NOT EXISTS bible_reference ON bible (book, chapter, verse);";
+
+    // Bookmarks, highlights and notes on canonical verse ids; kind is an AnnotationKind
+    const char *createAnnotationTablesSQL =
+        "CREATE TABLE IF NOT EXISTS annotations ("
+        "    verse_id INTEGER NOT NULL,"
+        "    kind INTEGER NOT NULL,"
+        "    note TEXT,"
+        "    PRIMARY KEY (verse_id, kind)"
+        ") WITHOUT ROWID;";
+
+    bool hadMinHashIndex = tableExists(db, "minhash");
+
+    // Indexes from before term frequencies were stored are rebuilt from scratch
+    bool hadStemIndex = tableExists(db, "stem_postings") && tableColumns(db, "stem_postings").count("tf");
+    if (!hadStemIndex && !execSQL(db, "DROP TABLE IF EXISTS stem_postings;"))
+        return false;
+
+    if (!execSQL(db, createTablesSQL) || !execSQL(db, createStemTablesSQL) || !execSQL(db, createMinHashTablesSQL) ||
+        !execSQL(db, createTranslationTablesSQL) || !execSQL(db, createAnnotationTablesSQL))
+        return false;
+
+    // Databases created before the folded shadow text existed
+    std::set<std::string> columns = tableColumns(db, "bible");
+    if (!columns.count("folded"))
+    {
+        if (!execSQL(db, "ALTER TABLE bible ADD COLUMN folded TEXT;") ||
+            !execSQL(db, "ALTER TABLE bible ADD COLUMN fold_map BLOB;") ||
+            !backfillFoldedText(db))
+            return false;
+    }
+
+    if (!columns.count("word_count"))
+    {
+        if (!execSQL(db, "ALTER TABLE bible ADD COLUMN word_count INTEGER;"))
+            return false;
+        hadStemIndex = false;
+    }
+
+    // Databases imported before the stem index or word counts existed
+    if (!hadStemIndex && !rebuildStemIndex(db))
+        return false;
+
+    if (!hadMinHashIndex && !rebuildMinHashIndex(db))
+        return false;
+
+    return true;
+}
+
+std::string getMeta(sqlite3 *db, const std::string &key, const std::string &fallback)
+{
+    std::string value = fallback;
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, "SELECT value FROM meta WHERE key = ?", -1, &stmt, nullptr) != SQLITE_OK)
+        return value;
+
+    sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        value = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+    }
+
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+bool setMeta(sqlite3 *db, const std::string &key, const std::string &value)
+{
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO meta (key, value) VALUES (?, ?)", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, value.c_str(), -1, SQLITE_STATIC);
+
+    bool ok = sqlite3_step(stmt) == SQLITE_DONE;
+    if (!ok)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+    }
+
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+FoldOptions loadFoldOptions(sqlite3 *db)
+{
+    FoldOptions options;
+    options.stripDiacritics = getMeta(db, "fold_strip_diacritics", "1") == "1";
+    return options;
+}
+
+bool saveFoldOptions(sqlite3 *db, const FoldOptions &options)
+{
+    return setMeta(db, "fold_strip_diacritics", options.stripDiacritics ? "1" : "0");
+}
@@ -0,0 +1,105 @@
+#include "../include/search_commands.h"
+#include "../include/corpus.h"
+#include "../include/regex_search.h"
+#include "../include/schema.h"
+#include "../include/stem_index.h"
+#include "../include/bm25.h"
+#include "../include/text_fold.h"
+#include <sqlite3.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Utility to print every verse matching a regular expression
+bool regexSearchCommand(const std::string &dbPath, const std::string &pattern)
+{
+    sqlite3 *db;
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK)
+    {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    if (!ensureSchema(db))
+    {
+        sqlite3_close(db);
+        return false;
+    }
+
+    RegexSearch search;
+    std::string error;
+    if (!search.compile(pattern, loadFoldOptions(db), error))
+    {
+        std::cerr << "Invalid pattern: " << error << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    std::vector<Verse> corpus;
+    bool loaded = loadCorpus(db, corpus);
+    sqlite3_close(db);
+
+    if (!loaded)
+        return false;
+
+    std::vector<size_t> hits = search.search(corpus);
+    for (size_t index : hits)
+    {
+        const Verse &verse = corpus[index];
+        std::cout << verse.book << " " << verse.chapter << ":" << verse.verse << " " << verse.text << "\n";
+    }
+
+    std::cout << hits.size() << " matching verses." << std::endl;
+    return true;
+}
+
+// Utility to print the verses most relevant to a query, with their BM25 scores
+bool rankedSearchCommand(const std::string &dbPath, const std::string &query, size_t count)
+{
+    sqlite3 *db;
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK)
+    {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    std::unique_ptr<Stemmer> stemmer;
+    Bm25Ranker ranker;
+    if (!ensureSchema(db) || !(stemmer = loadStemmer(db)) || !ranker.load(db))
+    {
+        sqlite3_close(db);
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ScoredVerse> ranked = ranker.search(db, *stemmer, foldText(query, loadFoldOptions(db)), count);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT book, chapter, verse, text FROM bible WHERE id = ?", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    for (const auto &scored : ranked)
+    {
+        sqlite3_bind_int(stmt, 1, scored.verseId);
+        if (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            std::cout << std::fixed << std::setprecision(3) << scored.score << "  "
+                      << sqlite3_column_text(stmt, 0) << " " << sqlite3_column_int(stmt, 1) << ":"
+                      << sqlite3_column_int(stmt, 2) << " " << sqlite3_column_text(stmt, 3) << "\n";
+        }
+        sqlite3_reset(stmt);
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    std::cout << ranked.size() << " verses ranked in " << std::setprecision(2) << elapsed.count() << " ms." << std::endl;
+    return true;
+}
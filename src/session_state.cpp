@@ -0,0 +1,93 @@
+#include "../include/session_state.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Bumped whenever the layout of the file changes
+static const char *const sessionHeader = "bible_cli-session 1";
+
+std::string sessionStatePath(const std::string &dbPath)
+{
+    return dbPath + ".state";
+}
+
+bool saveSessionState(const std::string &path, const SessionState &state, WINDOW *frame)
+{
+    // Write to a temporary file and rename so a crash never leaves half a state
+    std::string temporary = path + ".tmp";
+    FILE *file = fopen(temporary.c_str(), "wb");
+    if (!file)
+        return false;
+
+    fprintf(file, "%s\n", sessionHeader);
+    fprintf(file, "book=%s\n", state.book.c_str());
+    fprintf(file, "chapter=%d\nverse=%d\n", state.chapter, state.verse);
+    fprintf(file, "parallel=%d\nrelated=%d\n", state.parallelCount, state.showRelated ? 1 : 0);
+    fprintf(file, "size=%dx%d\n", state.rows, state.cols);
+
+    bool ok = true;
+    if (frame)
+    {
+        fprintf(file, "frame\n");
+        ok = putwin(frame, file) != ERR;
+    }
+
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        remove(temporary.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool loadSessionState(const std::string &path, SessionState &state, WINDOW **frame)
+{
+    if (frame)
+        *frame = nullptr;
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    char line[512];
+    if (!fgets(line, sizeof(line), file) || strncmp(line, sessionHeader, strlen(sessionHeader)) != 0)
+    {
+        fclose(file);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file))
+    {
+        line[strcspn(line, "\n")] = '\0';
+
+        if (strcmp(line, "frame") == 0)
+        {
+            if (frame)
+                *frame = getwin(file);
+            break;
+        }
+
+        char *value = strchr(line, '=');
+        if (!value)
+            continue;
+        *value++ = '\0';
+
+        if (strcmp(line, "book") == 0)
+            state.book = value;
+        else if (strcmp(line, "chapter") == 0)
+            state.chapter = atoi(value);
+        else if (strcmp(line, "verse") == 0)
+            state.verse = atoi(value);
+        else if (strcmp(line, "parallel") == 0)
+            state.parallelCount = atoi(value);
+        else if (strcmp(line, "related") == 0)
+            state.showRelated = atoi(value) != 0;
+        else if (strcmp(line, "size") == 0)
+            sscanf(value, "%dx%d", &state.rows, &state.cols);
+    }
+
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,55 @@
+#include "../include/stats_command.h"
+#include "../include/corpus.h"
+#include "../include/schema.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Utility to compute a concordance and word statistics for the whole corpus
+bool statsCommand(const std::string &dbPath, const std::string &format, const std::string &outDir, const ConcordanceOptions &options)
+{
+    sqlite3 *db;
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK)
+    {
+        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    std::vector<Verse> corpus;
+    bool loaded = ensureSchema(db) && loadCorpus(db, corpus);
+    sqlite3_close(db);
+
+    if (!loaded)
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+    Concordance concordance = buildConcordance(corpus, options);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    if (format == "json")
+    {
+        std::ofstream out(outDir + "/concordance.json");
+        if (!out)
+        {
+            std::cerr << "Error writing JSON file to: " << outDir << std::endl;
+            return false;
+        }
+        writeConcordanceJson(concordance, out);
+    }
+    else if (!writeConcordanceCsv(concordance, outDir))
+    {
+        return false;
+    }
+
+    size_t hapaxCount = std::count_if(concordance.words.begin(), concordance.words.end(), [](const WordStats &stats)
+                                      { return stats.total == 1; });
+
+    std::cout << concordance.tokenCount << " words, " << concordance.words.size() << " distinct, "
+              << hapaxCount << " hapax legomena, computed in " << std::fixed << std::setprecision(1)
+              << elapsed.count() << " ms." << std::endl;
+    return true;
+}
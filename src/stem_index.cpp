@@ -0,0 +1,216 @@
+#include "../include/stem_index.h"
+#include "../include/schema.h"
+#include "../include/tokenizer.h"
+#include <iostream>
+#include <map>
+
+bool StemIndexWriter::open(sqlite3 *database)
+{
+    db = database;
+    stemmer = loadStemmer(db);
+
+    if (!stemmer)
+    {
+        std::cerr << "Unknown stemmer: " << getMeta(db, "stemmer") << std::endl;
+        return false;
+    }
+
+    const char *postingSQL = "INSERT OR REPLACE INTO stem_postings (stem, verse_id, tf) VALUES (?, ?, ?)";
+    const char *formSQL = "INSERT OR IGNORE INTO stem_forms (stem, form) VALUES (?, ?)";
+    const char *deleteSQL = "DELETE FROM stem_postings WHERE stem = ? AND verse_id = ?";
+
+    if (sqlite3_prepare_v2(db, postingSQL, -1, &insertPosting, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, formSQL, -1, &insertForm, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, deleteSQL, -1, &deletePosting, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool StemIndexWriter::addVerse(int verseId, const std::vector<std::string> &words)
+{
+    std::map<std::string, int> stems; // Stem -> occurrences in this verse
+
+    for (const auto &word : words)
+    {
+        std::string stem = stemmer->stem(word);
+        stems[stem]++;
+
+        if (seenForms.insert({stem, word}).second)
+        {
+            sqlite3_bind_text(insertForm, 1, stem.c_str(), stem.length(), SQLITE_TRANSIENT);
+            sqlite3_bind_text(insertForm, 2, word.c_str(), word.length(), SQLITE_TRANSIENT);
+            sqlite3_step(insertForm);
+            sqlite3_reset(insertForm);
+        }
+    }
+
+    for (const auto &entry : stems)
+    {
+        sqlite3_bind_text(insertPosting, 1, entry.first.c_str(), entry.first.length(), SQLITE_STATIC);
+        sqlite3_bind_int(insertPosting, 2, verseId);
+        sqlite3_bind_int(insertPosting, 3, entry.second);
+
+        if (sqlite3_step(insertPosting) != SQLITE_DONE)
+        {
+            std::cerr << "Error inserting data: " << sqlite3_errmsg(db) << std::endl;
+            sqlite3_reset(insertPosting);
+            return false;
+        }
+        sqlite3_reset(insertPosting);
+    }
+
+    return true;
+}
+
+bool StemIndexWriter::removeVerse(int verseId, const std::vector<std::string> &words)
+{
+    // Postings are keyed by stem first, so delete each one directly
+    std::set<std::string> stems;
+    for (const auto &word : words)
+        stems.insert(stemmer->stem(word));
+
+    for (const auto &stem : stems)
+    {
+        sqlite3_bind_text(deletePosting, 1, stem.c_str(), stem.length(), SQLITE_STATIC);
+        sqlite3_bind_int(deletePosting, 2, verseId);
+
+        if (sqlite3_step(deletePosting) != SQLITE_DONE)
+        {
+            std::cerr << "Error deleting data: " << sqlite3_errmsg(db) << std::endl;
+            sqlite3_reset(deletePosting);
+            return false;
+        }
+        sqlite3_reset(deletePosting);
+    }
+
+    return true;
+}
+
+void StemIndexWriter::close()
+{
+    sqlite3_finalize(insertPosting);
+    sqlite3_finalize(insertForm);
+    sqlite3_finalize(deletePosting);
+    insertPosting = nullptr;
+    insertForm = nullptr;
+    deletePosting = nullptr;
+    seenForms.clear();
+}
+
+StemIndexWriter::~StemIndexWriter()
+{
+    close();
+}
+
+bool rebuildStemIndex(sqlite3 *db)
+{
+    char *errMsg = nullptr;
+    if (sqlite3_exec(db, "BEGIN TRANSACTION; DELETE FROM stem_postings; DELETE FROM stem_forms;", nullptr, nullptr, &errMsg) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+
+    StemIndexWriter writer;
+    sqlite3_stmt *stmt;
+    sqlite3_stmt *update;
+
+    if (!writer.open(db) ||
+        sqlite3_prepare_v2(db, "SELECT id, folded FROM bible ORDER BY id", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+
+    if (sqlite3_prepare_v2(db, "UPDATE bible SET word_count = ? WHERE id = ?", -1, &update, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_finalize(stmt);
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        const unsigned char *folded = sqlite3_column_text(stmt, 1);
+        if (!folded)
+            continue;
+
+        int id = sqlite3_column_int(stmt, 0);
+        std::vector<std::string> words = tokenize(reinterpret_cast<const char *>(folded));
+        writer.addVerse(id, words);
+
+        sqlite3_bind_int(update, 1, static_cast<int>(words.size()));
+        sqlite3_bind_int(update, 2, id);
+        sqlite3_step(update);
+        sqlite3_reset(update);
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_finalize(update);
+    writer.close();
+
+    if (sqlite3_exec(db, "COMMIT;", nullptr, nullptr, &errMsg) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+
+    return true;
+}
+
+std::unique_ptr<Stemmer> loadStemmer(sqlite3 *db)
+{
+    return createStemmer(getMeta(db, "stemmer", "archaic-english"));
+}
+
+std::vector<int> lookupStem(sqlite3 *db, const Stemmer &stemmer, const std::string &foldedWord)
+{
+    std::vector<int> ids;
+    std::string stem = stemmer.stem(foldedWord);
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, "SELECT verse_id FROM stem_postings WHERE stem = ? ORDER BY verse_id", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return ids;
+    }
+
+    sqlite3_bind_text(stmt, 1, stem.c_str(), stem.length(), SQLITE_STATIC);
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        ids.push_back(sqlite3_column_int(stmt, 0));
+    }
+
+    sqlite3_finalize(stmt);
+    return ids;
+}
+
+std::vector<std::string> stemForms(sqlite3 *db, const Stemmer &stemmer, const std::string &foldedWord)
+{
+    std::vector<std::string> forms;
+    std::string stem = stemmer.stem(foldedWord);
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, "SELECT form FROM stem_forms WHERE stem = ?", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return forms;
+    }
+
+    sqlite3_bind_text(stmt, 1, stem.c_str(), stem.length(), SQLITE_STATIC);
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        forms.push_back(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0)));
+    }
+
+    sqlite3_finalize(stmt);
+    return forms;
+}
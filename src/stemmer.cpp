@@ -0,0 +1,110 @@
+#include "../include/stemmer.h"
+#include <unordered_map>
+
+static bool endsWith(const std::string &word, const std::string &suffix)
+{
+    return word.length() >= suffix.length() &&
+           word.compare(word.length() - suffix.length(), suffix.length(), suffix) == 0;
+}
+
+static bool isVowel(char c)
+{
+    return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u' || c == 'y';
+}
+
+std::string ArchaicEnglishStemmer::stem(const std::string &input) const
+{
+    static const std::unordered_map<std::string, std::string> irregular = {
+        {"hath", "have"}, {"hast", "have"}, {"had", "have"}, {"hadst", "have"}, {"having", "have"},
+        {"doth", "do"}, {"dost", "do"}, {"did", "do"}, {"didst", "do"}, {"doeth", "do"}, {"doest", "do"},
+        {"saith", "say"}, {"said", "say"}, {"saidst", "say"},
+        {"spake", "speak"}, {"spoken", "speak"}, {"spakest", "speak"},
+        {"shalt", "shall"}, {"wilt", "will"}, {"canst", "can"}, {"couldest", "could"},
+        {"wouldest", "would"}, {"shouldest", "should"}, {"art", "art"}, {"wast", "was"},
+        {"went", "go"}, {"goeth", "go"}, {"gone", "go"},
+        {"came", "come"}, {"camest", "come"},
+        {"gave", "give"}, {"given", "give"}, {"gavest", "give"},
+        {"took", "take"}, {"taken", "take"}, {"tookest", "take"},
+        {"knew", "know"}, {"known", "know"}, {"knewest", "know"},
+        {"priest", "priest"}, {"priests", "priest"},
+    };
+
+    std::string word = input;
+
+    // Possessives
+    if (endsWith(word, "'s"))
+        word.erase(word.length() - 2);
+    else if (!word.empty() && word.back() == '\'')
+        word.pop_back();
+
+    // Irregular forms map to their base verb, which then takes the usual final-e trim
+    auto found = irregular.find(word);
+    bool isIrregular = found != irregular.end();
+    if (isIrregular)
+        word = found->second;
+
+    // Only plain ASCII words follow English inflection rules
+    for (char c : word)
+    {
+        if (c < 'a' || c > 'z')
+            return word;
+    }
+
+    if (isIrregular)
+    {
+        if (word.length() > 3 && word.back() == 'e')
+            word.pop_back();
+        return word;
+    }
+
+    struct Rule
+    {
+        const char *suffix;
+        const char *replacement;
+        size_t minStem;
+    };
+
+    // Longest suffixes first; the first one that leaves a long enough stem wins
+    static const Rule rules[] = {
+        {"iedst", "y", 2}, {"iest", "y", 2}, {"ieth", "y", 2}, {"ied", "y", 2}, {"ies", "y", 2},
+        {"edst", "", 3}, {"eth", "", 2}, {"est", "", 3}, {"ing", "", 3},
+        {"ed", "", 3}, {"es", "", 3}, {"s", "", 3},
+    };
+
+    for (const auto &rule : rules)
+    {
+        std::string suffix = rule.suffix;
+        if (!endsWith(word, suffix) || word.length() - suffix.length() < rule.minStem)
+            continue;
+
+        // "ss" is not a plural ("bless", "unless")
+        if (suffix == "s" && endsWith(word, "ss"))
+            continue;
+
+        word = word.substr(0, word.length() - suffix.length()) + rule.replacement;
+
+        // "sinned" -> "sinn" -> "sin", but keep "bless", "fall", "buzz"
+        size_t n = word.length();
+        if (n >= 3 && word[n - 1] == word[n - 2] && !isVowel(word[n - 1]) &&
+            word[n - 1] != 'l' && word[n - 1] != 's' && word[n - 1] != 'z')
+        {
+            word.pop_back();
+        }
+        break;
+    }
+
+    // "love", "loved", "loveth" all reduce to "lov"
+    if (word.length() > 3 && word.back() == 'e')
+        word.pop_back();
+
+    return word;
+}
+
+std::unique_ptr<Stemmer> createStemmer(const std::string &name)
+{
+    if (name == "archaic-english")
+        return std::unique_ptr<Stemmer>(new ArchaicEnglishStemmer());
+    if (name == "none")
+        return std::unique_ptr<Stemmer>(new IdentityStemmer());
+    return nullptr;
+}
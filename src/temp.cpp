@@ -2,713 +2,376 @@
 // Filename: bible_viewer.cpp
 
 #include <iostream>
-#include <iomanip>
 #include <string>
 #include <vector>
 #include <algorithm>
-#include <sqlite3.h>
-#include <cstring>
-#include <ncurses.h>
+#include "../include/viewer.h"
+#include "../include/import_commands.h"
+#include "../include/search_commands.h"
+#include "../include/stats_command.h"
+#include "../include/export_command.h"
+#include "../include/plan_command.h"
+#include "../include/command_options.h"
+#include "../include/reading_plan.h"
+#include "../include/stemmer.h"
+#include "../include/memory_budget.h"
+#include "../include/parallel.h"
 
-// Structure to hold Bible verses
-struct Verse
-{
-    int id;
-    std::string book;
-    int chapter;
-    int verse;
-    std::string text;
-};
-
-// Structure to hold Bible books
-struct Book
+void printUsage()
 {
-    std::string name;
-    int chapters;
-};
+    std::cout << "Bible Terminal Viewer" << std::endl;
+    std::cout << "Usage:" << std::endl;
+    std::cout << "  bible_cli view <database.db> [--mem-budget <bytes, e.g. 32M>] [--store sqlite|arena|mmap] [--no-restore] [--goto <reference>]" << std::endl;
+    std::cout << "  bible_cli create <database.db> [--keep-diacritics] [--stemmer archaic-english|none]" << std::endl;
+    std::cout << "  bible_cli import <database.db> <bible.csv> [--translation <code>]" << std::endl;
+    std::cout << "  bible_cli import <database.db> --translations <code.csv|code=file.csv>... [--jobs <threads>]" << std::endl;
+    std::cout << "  bible_cli versification <database.db> <code> <mapping.csv>" << std::endl;
+    std::cout << "  bible_cli regex <database.db> <pattern>" << std::endl;
+    std::cout << "  bible_cli rank <database.db> <query> [count]" << std::endl;
+    std::cout << "  bible_cli stats <database.db> [--format csv|json] [--out <dir>] [--window <verses>] [--pairs <count>]" << std::endl;
+    std::cout << "  bible_cli cat <database.db> <range, e.g. \"Gen 1 - Deut 34\" or \"John 3:16-18\">" << std::endl;
+    std::cout << "  bible_cli export <database.db> [--format txt|csv|json] [--range <range>] [--out <file>]" << std::endl;
+    std::cout << "  bible_cli plan <database.db> --days <n[,n...] or a-b> [--range <range>] [--start YYYY-MM-DD] [--out <file>] [--open]" << std::endl;
+}
 
-class BibleViewer
+// Arguments after a command's fixed ones: at most one count, no options
+static bool parseTrailingCount(int argc, char *argv[], int first, size_t &count)
 {
-private:
-    sqlite3 *db;
-    std::vector<Book> books;
-    int currentBook = 0;
-    int currentChapter = 1;
-    int currentVerse = 1;
-    int screenRows = 0;
-    int screenCols = 0;
-
-    // Initialize ncurses
-    void initNcurses()
+    CommandOptions parser;
+    parser.acceptPositional();
+    if (!parser.parse(argc, argv, first))
+        return false;
+
+    const std::vector<std::string> &extra = parser.arguments();
+    if (extra.size() > 1 || (extra.size() == 1 && !parseCount(extra[0], count)))
     {
-        initscr();
-        cbreak();
-        noecho();
-        keypad(stdscr, TRUE);
-        start_color();
-        init_pair(1, COLOR_WHITE, COLOR_BLUE);   // Title
-        init_pair(2, COLOR_YELLOW, COLOR_BLACK); // Highlights
-        init_pair(3, COLOR_GREEN, COLOR_BLACK);  // Verse numbers
-        curs_set(0);                             // Hide cursor
+        std::cout << "Error: Unexpected argument: " << extra.back() << std::endl;
+        return false;
     }
+    return true;
+}
 
-    // Load books from the database
-    void loadBooks()
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
     {
-        books.clear();
+        printUsage();
+        return 1;
+    }
 
-        const char *query = "SELECT DISTINCT book, MAX(chapter) as chapters FROM bible GROUP BY book ORDER BY id";
-        sqlite3_stmt *stmt;
+    std::string command = argv[1];
+    std::string dbPath = argv[2];
 
-        if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) != SQLITE_OK)
+    if (command == "view")
+    {
+        ViewerOptions options;
+
+        CommandOptions parser;
+        parser.value("--mem-budget", [&](const std::string &value)
+                     { return parseByteSize(value, options.memoryBudget); });
+        parser.value("--store", [&](const std::string &value)
+                     { return parseStoreBackend(value, options.storeBackend); });
+        parser.flag("--no-restore", [&]
+                    { options.restoreSession = false; });
+        parser.value("--goto", [&](const std::string &value)
+                     { options.startReference = value; return true; });
+        if (!parser.parse(argc, argv, 3))
         {
-            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-            return;
+            printUsage();
+            return 1;
         }
 
-        while (sqlite3_step(stmt) == SQLITE_ROW)
+        if (!runViewer(dbPath, options))
         {
-            Book book;
-            book.name = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
-            book.chapters = sqlite3_column_int(stmt, 1);
-            books.push_back(book);
+            return 1;
         }
-
-        sqlite3_finalize(stmt);
     }
-
-    // Get verses for a specific chapter
-    std::vector<Verse> getChapterVerses(const std::string &book, int chapter)
+    else if (command == "create")
     {
-        std::vector<Verse> verses;
-
-        std::string query = "SELECT id, book, chapter, verse, text FROM bible WHERE book = ? AND chapter = ? ORDER BY verse";
-        sqlite3_stmt *stmt;
-
-        if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+        // Searches ignore accents unless asked to keep them
+        FoldOptions options;
+        std::string stemmerName = "archaic-english";
+
+        CommandOptions parser;
+        parser.flag("--keep-diacritics", [&]
+                    { options.stripDiacritics = false; });
+        parser.value("--stemmer", [&](const std::string &value)
+                     { stemmerName = value; return true; });
+        if (!parser.parse(argc, argv, 3))
         {
-            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-            return verses;
-        }
-
-        sqlite3_bind_text(stmt, 1, book.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_int(stmt, 2, chapter);
-
-        while (sqlite3_step(stmt) == SQLITE_ROW)
-        {
-            Verse verse;
-            verse.id = sqlite3_column_int(stmt, 0);
-            verse.book = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-            verse.chapter = sqlite3_column_int(stmt, 2);
-            verse.verse = sqlite3_column_int(stmt, 3);
-            verse.text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-            verses.push_back(verse);
+            printUsage();
+            return 1;
         }
 
-        sqlite3_finalize(stmt);
-        return verses;
-    }
-
-    // Search for verses containing a specific term
-    std::vector<Verse> searchVerses(const std::string &term)
-    {
-        std::vector<Verse> results;
-
-        std::string query = "SELECT id, book, chapter, verse, text FROM bible WHERE text LIKE ? ORDER BY id LIMIT 100";
-        sqlite3_stmt *stmt;
-
-        if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+        if (!createStemmer(stemmerName))
         {
-            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-            return results;
+            std::cout << "Error: Unknown stemmer: " << stemmerName << std::endl;
+            return 1;
         }
 
-        std::string searchTerm = "%" + term + "%";
-        sqlite3_bind_text(stmt, 1, searchTerm.c_str(), -1, SQLITE_STATIC);
-
-        while (sqlite3_step(stmt) == SQLITE_ROW)
+        if (createDatabase(dbPath, options, stemmerName))
         {
-            Verse verse;
-            verse.id = sqlite3_column_int(stmt, 0);
-            verse.book = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-            verse.chapter = sqlite3_column_int(stmt, 2);
-            verse.verse = sqlite3_column_int(stmt, 3);
-            verse.text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-            results.push_back(verse);
+            std::cout << "Database created successfully: " << dbPath << std::endl;
         }
-
-        sqlite3_finalize(stmt);
-        return results;
     }
-
-    // Display the current chapter
-    void displayChapter()
+    else if (command == "import")
     {
-        clear();
-        getmaxyx(stdscr, screenRows, screenCols);
-
-        // Display title
-        attron(COLOR_PAIR(1));
-        std::string title = books[currentBook].name + " Chapter " + std::to_string(currentChapter);
-        mvprintw(0, (screenCols - title.length()) / 2, "%s", title.c_str());
-        mvhline(1, 0, ACS_HLINE, screenCols);
-        attroff(COLOR_PAIR(1));
-
-        // Get and display verses
-        std::vector<Verse> verses = getChapterVerses(books[currentBook].name, currentChapter);
+        if (argc < 4)
+        {
+            std::cout << "Error: Missing CSV file path." << std::endl;
+            printUsage();
+            return 1;
+        }
 
-        int row = 3;
-        int scrollOffset = 0;
+        std::string csvPath = argv[3];
 
-        // Calculate scroll offset to keep current verse visible
-        if (currentVerse > 1)
+        // Several translations at once, each named by its file or as code=file
+        if (csvPath == "--translations")
         {
-            for (size_t i = 0; i < verses.size() && i < static_cast<size_t>(currentVerse - 1); i++)
+            std::vector<TranslationImport> imports;
+            size_t workers = workerCount();
+
+            CommandOptions parser;
+            parser.value("--jobs", [&](const std::string &value)
+                         { return parseCount(value, workers) && workers > 0; });
+            parser.acceptPositional();
+            if (!parser.parse(argc, argv, 4))
             {
-                scrollOffset += (verses[i].text.length() / (screenCols - 10) + 1);
+                printUsage();
+                return 1;
             }
-            scrollOffset = std::max(0, scrollOffset - screenRows + 10);
-        }
-
-        // Display verses with word wrapping
-        for (const auto &verse : verses)
-        {
-            std::string verseText = verse.text;
 
-            // Highlight the current verse
-            if (verse.verse == currentVerse)
+            for (const std::string &arg : parser.arguments())
             {
-                attron(COLOR_PAIR(2));
+                TranslationImport import;
+                size_t equals = arg.find('=');
+                import.csvPath = equals == std::string::npos ? arg : arg.substr(equals + 1);
+                import.code = equals == std::string::npos ? translationCodeFor(arg) : arg.substr(0, equals);
+                imports.push_back(import);
             }
 
-            // Display verse number
-            attron(COLOR_PAIR(3));
-            mvprintw(row - scrollOffset, 2, "%d", verse.verse);
-            attroff(COLOR_PAIR(3));
-
-            // Word wrap verse text
-            int col = 6;
-            for (size_t i = 0; i < verseText.length(); i++)
+            if (imports.empty())
             {
-                if (col >= screenCols - 2)
-                {
-                    row++;
-                    col = 6;
-                }
-
-                if (row - scrollOffset >= 2 && row - scrollOffset < screenRows - 2)
-                {
-                    mvaddch(row - scrollOffset, col, verseText[i]);
-                }
-                col++;
+                std::cout << "Error: Missing CSV file path." << std::endl;
+                printUsage();
+                return 1;
             }
 
-            if (verse.verse == currentVerse)
+            if (!importTranslationsFromCSV(dbPath, imports, workers))
             {
-                attroff(COLOR_PAIR(2));
+                return 1;
             }
-
-            row += 2;
+            std::cout << "Translations imported successfully into: " << dbPath << std::endl;
         }
-
-        // Display navigation help
-        attron(COLOR_PAIR(1));
-        mvhline(screenRows - 2, 0, ACS_HLINE, screenCols);
-        mvprintw(screenRows - 1, 0, "↑/↓: Navigate verses | ←/→: Chapters | b: Book list | s: Search | q: Quit");
-        attroff(COLOR_PAIR(1));
-
-        refresh();
-    }
-
-    // Display the book selection menu
-    void displayBookMenu()
-    {
-        clear();
-        getmaxyx(stdscr, screenRows, screenCols);
-
-        attron(COLOR_PAIR(1));
-        std::string title = "Bible Book Selection";
-        mvprintw(0, (screenCols - title.length()) / 2, "%s", title.c_str());
-        mvhline(1, 0, ACS_HLINE, screenCols);
-        attroff(COLOR_PAIR(1));
-
-        int startRow = 3;
-        int booksPerRow = 3;
-        int columnWidth = screenCols / booksPerRow;
-
-        for (size_t i = 0; i < books.size(); i++)
+        // A translation code imports a parallel text aligned to the base one.
+        // Anything else after the file must not fall through to replacing the base text.
+        else if (argc >= 5)
         {
-            int row = startRow + (i / booksPerRow) * 2;
-            int col = (i % booksPerRow) * columnWidth;
-
-            if (i == static_cast<size_t>(currentBook))
+            if (argc != 6 || std::string(argv[4]) != "--translation" || argv[5][0] == '\0' || argv[5][0] == '-')
             {
-                attron(COLOR_PAIR(2));
+                std::cout << "Error: Expected --translation <code> after the CSV file." << std::endl;
+                printUsage();
+                return 1;
             }
 
-            mvprintw(row, col + 2, "%s (%d chapters)",
-                     books[i].name.c_str(), books[i].chapters);
-
-            if (i == static_cast<size_t>(currentBook))
+            std::vector<TranslationImport> imports(1);
+            imports[0].code = argv[5];
+            imports[0].csvPath = csvPath;
+            if (!importTranslationsFromCSV(dbPath, imports, 1))
             {
-                attroff(COLOR_PAIR(2));
+                return 1;
             }
+            std::cout << "Translation imported successfully into: " << dbPath << std::endl;
         }
-
-        attron(COLOR_PAIR(1));
-        mvhline(screenRows - 2, 0, ACS_HLINE, screenCols);
-        mvprintw(screenRows - 1, 0, "↑/↓/←/→: Navigate | Enter: Select | q: Quit");
-        attroff(COLOR_PAIR(1));
-
-        refresh();
-    }
-
-    // Display search interface
-    void displaySearchInterface()
-    {
-        clear();
-        getmaxyx(stdscr, screenRows, screenCols);
-
-        attron(COLOR_PAIR(1));
-        std::string title = "Bible Search";
-        mvprintw(0, (screenCols - title.length()) / 2, "%s", title.c_str());
-        mvhline(1, 0, ACS_HLINE, screenCols);
-        attroff(COLOR_PAIR(1));
-
-        mvprintw(3, 2, "Enter search term: ");
-        echo();
-        curs_set(1);
-
-        char searchTerm[100];
-        getstr(searchTerm);
-
-        noecho();
-        curs_set(0);
-
-        // If search term is empty, return to chapter view
-        if (strlen(searchTerm) == 0)
-        {
-            displayChapter();
-            return;
-        }
-
-        // Search for verses
-        std::vector<Verse> results = searchVerses(searchTerm);
-
-        clear();
-        attron(COLOR_PAIR(1));
-        std::string resultTitle = "Search Results for: " + std::string(searchTerm);
-        mvprintw(0, (screenCols - resultTitle.length()) / 2, "%s", resultTitle.c_str());
-        mvhline(1, 0, ACS_HLINE, screenCols);
-        attroff(COLOR_PAIR(1));
-
-        if (results.empty())
+        else if (importBibleFromCSV(dbPath, csvPath))
         {
-            mvprintw(3, 2, "No results found.");
+            std::cout << "Bible data imported successfully into: " << dbPath << std::endl;
         }
         else
         {
-            mvprintw(2, 2, "Found %zu results:", results.size());
-
-            int row = 4;
-            for (const auto &verse : results)
-            {
-                if (row >= screenRows - 3)
-                    break;
-
-                attron(COLOR_PAIR(3));
-                mvprintw(row, 2, "%s %d:%d", verse.book.c_str(), verse.chapter, verse.verse);
-                attroff(COLOR_PAIR(3));
-
-                // Truncate verse text if too long for display
-                std::string displayText = verse.text;
-                if (displayText.length() > static_cast<size_t>(screenCols - 4))
-                {
-                    displayText = displayText.substr(0, screenCols - 7) + "...";
-                }
-
-                mvprintw(row + 1, 4, "%s", displayText.c_str());
-                row += 3;
-            }
+            return 1;
         }
-
-        attron(COLOR_PAIR(1));
-        mvhline(screenRows - 2, 0, ACS_HLINE, screenCols);
-        mvprintw(screenRows - 1, 0, "Press any key to return");
-        attroff(COLOR_PAIR(1));
-
-        refresh();
-        getch(); // Wait for key press
-        displayChapter();
     }
-
-public:
-    BibleViewer() : db(nullptr) {}
-
-    ~BibleViewer()
+    else if (command == "versification")
     {
-        if (db)
+        if (argc < 5)
         {
-            sqlite3_close(db);
+            std::cout << "Error: Missing translation code or mapping file." << std::endl;
+            printUsage();
+            return 1;
         }
-        endwin(); // Clean up ncurses
-    }
 
-    // Initialize the database
-    bool initDatabase(const std::string &dbPath)
-    {
-        if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK)
+        if (!CommandOptions().parse(argc, argv, 5))
         {
-            std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
-            return false;
+            printUsage();
+            return 1;
         }
 
-        // Check if the database has the required table
-        sqlite3_stmt *stmt;
-        const char *checkTableSQL = "SELECT name FROM sqlite_master WHERE type='table' AND name='bible'";
-
-        if (sqlite3_prepare_v2(db, checkTableSQL, -1, &stmt, nullptr) != SQLITE_OK)
+        if (!importVersificationFromCSV(dbPath, argv[3], argv[4]))
         {
-            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-            return false;
+            return 1;
         }
-
-        bool tableExists = (sqlite3_step(stmt) == SQLITE_ROW);
-        sqlite3_finalize(stmt);
-
-        if (!tableExists)
+    }
+    else if (command == "regex")
+    {
+        if (argc < 4)
         {
-            std::cerr << "Database does not have a 'bible' table. Please use a properly formatted database." << std::endl;
-            return false;
+            std::cout << "Error: Missing search pattern." << std::endl;
+            printUsage();
+            return 1;
         }
 
-        loadBooks();
-
-        if (books.empty())
+        if (!CommandOptions().parse(argc, argv, 4))
         {
-            std::cerr << "No books found in the database." << std::endl;
-            return false;
+            printUsage();
+            return 1;
         }
 
-        return true;
+        if (!regexSearchCommand(dbPath, argv[3]))
+        {
+            return 1;
+        }
     }
-
-    // Run the main interface
-    void run()
+    else if (command == "rank")
     {
-        if (!db || books.empty())
+        if (argc < 4)
         {
-            std::cerr << "Database not initialized correctly." << std::endl;
-            return;
+            std::cout << "Error: Missing query." << std::endl;
+            printUsage();
+            return 1;
         }
 
-        initNcurses();
-        displayChapter();
-
-        int ch;
-        bool quitRequested = false;
-
-        while (!quitRequested && (ch = getch()))
+        size_t count = 50;
+        if (!parseTrailingCount(argc, argv, 4, count))
         {
-            switch (ch)
-            {
-            case 'q':
-            case 'Q':
-                quitRequested = true;
-                break;
-
-            case KEY_UP:
-                if (currentVerse > 1)
-                {
-                    currentVerse--;
-                    displayChapter();
-                }
-                break;
-
-            case KEY_DOWN:
-            {
-                std::vector<Verse> verses = getChapterVerses(books[currentBook].name, currentChapter);
-                if (currentVerse < static_cast<int>(verses.size()))
-                {
-                    currentVerse++;
-                    displayChapter();
-                }
-                break;
-            }
-
-            case KEY_LEFT:
-                if (currentChapter > 1)
-                {
-                    currentChapter--;
-                    currentVerse = 1;
-                    displayChapter();
-                }
-                break;
-
-            case KEY_RIGHT:
-                if (currentChapter < books[currentBook].chapters)
-                {
-                    currentChapter++;
-                    currentVerse = 1;
-                    displayChapter();
-                }
-                break;
-
-            case 'b':
-            case 'B':
-            {
-                bool bookMenuActive = true;
-                displayBookMenu();
-
-                while (bookMenuActive)
-                {
-                    int bookCh = getch();
-
-                    switch (bookCh)
-                    {
-                    case 'q':
-                    case 'Q':
-                        bookMenuActive = false;
-                        quitRequested = true;
-                        break;
-
-                    case KEY_UP:
-                        if (currentBook >= 3)
-                        {
-                            currentBook -= 3;
-                            displayBookMenu();
-                        }
-                        break;
-
-                    case KEY_DOWN:
-                        if (currentBook + 3 < static_cast<int>(books.size()))
-                        {
-                            currentBook += 3;
-                            displayBookMenu();
-                        }
-                        break;
-
-                    case KEY_LEFT:
-                        if (currentBook > 0)
-                        {
-                            currentBook--;
-                            displayBookMenu();
-                        }
-                        break;
-
-                    case KEY_RIGHT:
-                        if (currentBook < static_cast<int>(books.size()) - 1)
-                        {
-                            currentBook++;
-                            displayBookMenu();
-                        }
-                        break;
-
-                    case '\n':
-                    case KEY_ENTER:
-                        bookMenuActive = false;
-                        currentChapter = 1;
-                        currentVerse = 1;
-                        displayChapter();
-                        break;
-                    }
-                }
-                break;
-            }
-
-            case 's':
-            case 'S':
-                displaySearchInterface();
-                break;
-            }
+            printUsage();
+            return 1;
+        }
+        if (!rankedSearchCommand(dbPath, argv[3], count))
+        {
+            return 1;
         }
     }
-
-    // Create database schema and import data (simplified example)
-    static bool createDatabase(const std::string &dbPath)
+    else if (command == "stats")
     {
-        sqlite3 *newDb;
-        if (sqlite3_open(dbPath.c_str(), &newDb) != SQLITE_OK)
+        std::string format = "csv";
+        std::string outDir = ".";
+        ConcordanceOptions options;
+
+        CommandOptions parser;
+        parser.value("--format", [&](const std::string &value)
+                     { format = value; return format == "csv" || format == "json"; });
+        parser.value("--out", [&](const std::string &value)
+                     { outDir = value; return true; });
+        parser.value("--window", [&](const std::string &value)
+                     {
+                         size_t window;
+                         if (!parseCount(value, window) || window < 1 || window > 1000000)
+                             return false;
+                         options.window = static_cast<int>(window);
+                         return true; });
+        parser.value("--pairs", [&](const std::string &value)
+                     { return parseCount(value, options.topPairs); });
+        if (!parser.parse(argc, argv, 3))
         {
-            std::cerr << "Error creating database: " << sqlite3_errmsg(newDb) << std::endl;
-            return false;
+            printUsage();
+            return 1;
         }
 
-        // Create table
-        const char *createTableSQL =
-            "CREATE TABLE IF NOT EXISTS bible ("
-            "    id INTEGER PRIMARY KEY,"
-            "    book TEXT NOT NULL,"
-            "    chapter INTEGER NOT NULL,"
-            "    verse INTEGER NOT NULL,"
-            "    text TEXT NOT NULL"
-            ");";
-
-        char *errMsg = nullptr;
-        if (sqlite3_exec(newDb, createTableSQL, nullptr, nullptr, &errMsg) != SQLITE_OK)
+        if (!statsCommand(dbPath, format, outDir, options))
         {
-            std::cerr << "SQL error: " << errMsg << std::endl;
-            sqlite3_free(errMsg);
-            sqlite3_close(newDb);
-            return false;
+            return 1;
         }
-
-        std::cout << "Bible database schema created successfully." << std::endl;
-        std::cout << "You should now import Bible text data into this database." << std::endl;
-
-        sqlite3_close(newDb);
-        return true;
-    }
-};
-
-// Utility to import Bible text from a CSV file
-bool importBibleFromCSV(const std::string &dbPath, const std::string &csvPath)
-{
-    sqlite3 *db;
-    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK)
-    {
-        std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
-        return false;
-    }
-
-    // Begin transaction for faster import
-    char *errMsg = nullptr;
-    if (sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, &errMsg) != SQLITE_OK)
-    {
-        std::cerr << "SQL error: " << errMsg << std::endl;
-        sqlite3_free(errMsg);
-        sqlite3_close(db);
-        return false;
-    }
-
-    // Prepare insert statement
-    const char *insertSQL = "INSERT INTO bible (book, chapter, verse, text) VALUES (?, ?, ?, ?)";
-    sqlite3_stmt *stmt;
-
-    if (sqlite3_prepare_v2(db, insertSQL, -1, &stmt, nullptr) != SQLITE_OK)
-    {
-        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_close(db);
-        return false;
-    }
-
-    // Open and read CSV file
-    FILE *file = fopen(csvPath.c_str(), "r");
-    if (!file)
-    {
-        std::cerr << "Error opening CSV file: " << csvPath << std::endl;
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
-        return false;
-    }
-
-    // Simple CSV parser
-    char line[10000]; // Assuming no line is longer than 10000 chars
-    int count = 0;
-
-    // Skip header line if present
-    if (fgets(line, sizeof(line), file) == nullptr)
-    {
-        std::cerr << "Error reading CSV file or file is empty." << std::endl;
-        fclose(file);
-        sqlite3_finalize(stmt);
-        sqlite3_close(db);
-        return false;
     }
-
-    // Process data lines
-    while (fgets(line, sizeof(line), file))
+    else if (command == "cat")
     {
-        char book[100];
-        int chapter, verse;
-        char text[9000];
-
-        // Parse CSV line (very simplified - assumes proper formatting)
-        if (sscanf(line, "\"%[^\"]\", %d, %d, \"%[^\"]\"", book, &chapter, &verse, text) == 4)
+        if (argc < 4)
         {
-            sqlite3_bind_text(stmt, 1, book, -1, SQLITE_STATIC);
-            sqlite3_bind_int(stmt, 2, chapter);
-            sqlite3_bind_int(stmt, 3, verse);
-            sqlite3_bind_text(stmt, 4, text, -1, SQLITE_STATIC);
-
-            if (sqlite3_step(stmt) != SQLITE_DONE)
-            {
-                std::cerr << "Error inserting data: " << sqlite3_errmsg(db) << std::endl;
-            }
-            else
-            {
-                count++;
-            }
-
-            sqlite3_reset(stmt);
+            std::cout << "Error: Missing range." << std::endl;
+            printUsage();
+            return 1;
         }
-    }
 
-    fclose(file);
-    sqlite3_finalize(stmt);
+        // Allow the range unquoted: cat bible.db Gen 1 - Deut 34
+        std::string range = argv[3];
+        for (int i = 4; i < argc; i++)
+            range += std::string(" ") + argv[i];
 
-    // Commit transaction
-    if (sqlite3_exec(db, "COMMIT;", nullptr, nullptr, &errMsg) != SQLITE_OK)
-    {
-        std::cerr << "SQL error: " << errMsg << std::endl;
-        sqlite3_free(errMsg);
-        sqlite3_close(db);
-        return false;
+        if (!exportCommand(dbPath, range, ExportFormat::Text, ""))
+        {
+            return 1;
+        }
     }
-
-    std::cout << "Imported " << count << " verses successfully." << std::endl;
-    sqlite3_close(db);
-    return true;
-}
-
-void printUsage()
-{
-    std::cout << "Bible Terminal Viewer" << std::endl;
-    std::cout << "Usage:" << std::endl;
-    std::cout << "  bible_viewer view <database.db>" << std::endl;
-    std::cout << "  bible_viewer create <database.db>" << std::endl;
-    std::cout << "  bible_viewer import <database.db> <bible.csv>" << std::endl;
-}
-
-int main(int argc, char *argv[])
-{
-    if (argc < 3)
+    else if (command == "export")
     {
-        printUsage();
-        return 1;
-    }
-
-    std::string command = argv[1];
-    std::string dbPath = argv[2];
+        ExportFormat format = ExportFormat::Text;
+        std::string range;
+        std::string outPath;
+
+        CommandOptions parser;
+        parser.value("--format", [&](const std::string &value)
+                     { return parseExportFormat(value, format); });
+        parser.value("--range", [&](const std::string &value)
+                     { range = value; return true; });
+        parser.value("--out", [&](const std::string &value)
+                     { outPath = value; return true; });
+        if (!parser.parse(argc, argv, 3))
+        {
+            printUsage();
+            return 1;
+        }
 
-    if (command == "view")
-    {
-        BibleViewer viewer;
-        if (viewer.initDatabase(dbPath))
+        if (!exportCommand(dbPath, range, format, outPath))
         {
-            viewer.run();
+            return 1;
         }
     }
-    else if (command == "create")
+    else if (command == "plan")
     {
-        if (BibleViewer::createDatabase(dbPath))
+        std::vector<int> dayCounts;
+        std::string range;
+        std::string outPath;
+        long startDate = today();
+        bool openViewer = false;
+
+        CommandOptions parser;
+        parser.value("--days", [&](const std::string &value)
+                     { return parseDayCounts(value, dayCounts); });
+        parser.value("--range", [&](const std::string &value)
+                     { range = value; return true; });
+        parser.value("--start", [&](const std::string &value)
+                     { return parseDate(value, startDate); });
+        parser.value("--out", [&](const std::string &value)
+                     { outPath = value; return true; });
+        parser.flag("--open", [&]
+                    { openViewer = true; });
+        if (!parser.parse(argc, argv, 3))
         {
-            std::cout << "Database created successfully: " << dbPath << std::endl;
+            printUsage();
+            return 1;
         }
-    }
-    else if (command == "import")
-    {
-        if (argc < 4)
+
+        if (dayCounts.empty() || (openViewer && dayCounts.size() > 1))
         {
-            std::cout << "Error: Missing CSV file path." << std::endl;
+            std::cout << "Error: Give the number of days" << (openViewer ? ", once, to open the viewer." : ".") << std::endl;
             printUsage();
             return 1;
         }
 
-        std::string csvPath = argv[3];
-        if (importBibleFromCSV(dbPath, csvPath))
+        std::string opening;
+        if (!planCommand(dbPath, dayCounts, range, startDate, outPath, openViewer ? &opening : nullptr))
         {
-            std::cout << "Bible data imported successfully into: " << dbPath << std::endl;
+            return 1;
+        }
+
+        if (openViewer)
+        {
+            ViewerOptions options;
+            options.startReference = opening;
+            if (!runViewer(dbPath, options))
+            {
+                return 1;
+            }
         }
     }
     else
@@ -0,0 +1,178 @@
+#include "../include/text_codec.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+void SymbolTable::buildIndex()
+{
+    for (auto &codes : byFirstByte)
+        codes.clear();
+
+    for (size_t code = 0; code < symbols.size(); code++)
+    {
+        byFirstByte[static_cast<unsigned char>(symbols[code].bytes[0])].push_back(static_cast<uint8_t>(code));
+    }
+
+    for (auto &codes : byFirstByte)
+    {
+        std::sort(codes.begin(), codes.end(), [this](uint8_t a, uint8_t b)
+                  { return symbols[a].length > symbols[b].length; });
+    }
+}
+
+int SymbolTable::match(const char *text, size_t remaining) const
+{
+    for (uint8_t code : byFirstByte[static_cast<unsigned char>(text[0])])
+    {
+        const Symbol &symbol = symbols[code];
+        if (symbol.length <= remaining && std::memcmp(symbol.bytes, text, symbol.length) == 0)
+            return code;
+    }
+    return -1;
+}
+
+void SymbolTable::train(const std::vector<const std::string *> &samples)
+{
+    symbols.clear();
+    buildIndex();
+
+    // A few rounds of: compress the sample with the current table, then keep
+    // the symbols and symbol pairs that would have saved the most bytes
+    for (int round = 0; round < 5; round++)
+    {
+        std::unordered_map<std::string, size_t> gains;
+
+        for (const std::string *sample : samples)
+        {
+            const char *text = sample->data();
+            size_t length = sample->length();
+            std::string previous;
+
+            for (size_t i = 0; i < length;)
+            {
+                int code = match(text + i, length - i);
+                std::string current = code >= 0 ? std::string(symbols[code].bytes, symbols[code].length)
+                                                 : std::string(1, text[i]);
+
+                gains[current] += current.length();
+                if (!previous.empty() && previous.length() + current.length() <= 8)
+                {
+                    gains[previous + current] += previous.length() + current.length();
+                }
+
+                previous = current;
+                i += current.length();
+            }
+        }
+
+        std::vector<std::pair<std::string, size_t>> ranked(gains.begin(), gains.end());
+        size_t keep = std::min<size_t>(maxSymbols, ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + keep, ranked.end(), [](const auto &a, const auto &b)
+                          { return a.second != b.second ? a.second > b.second : a.first < b.first; });
+
+        symbols.clear();
+        for (size_t i = 0; i < keep; i++)
+        {
+            Symbol symbol;
+            std::memset(symbol.bytes, 0, sizeof(symbol.bytes));
+            std::memcpy(symbol.bytes, ranked[i].first.data(), ranked[i].first.length());
+            symbol.length = static_cast<uint8_t>(ranked[i].first.length());
+            symbols.push_back(symbol);
+        }
+        buildIndex();
+    }
+}
+
+std::string SymbolTable::encode(const std::string &text) const
+{
+    std::string encoded;
+    encoded.reserve(text.length() / 2 + 16);
+
+    for (size_t i = 0; i < text.length();)
+    {
+        int code = match(text.data() + i, text.length() - i);
+        if (code >= 0)
+        {
+            encoded += static_cast<char>(code);
+            i += symbols[code].length;
+        }
+        else
+        {
+            encoded += static_cast<char>(escapeCode);
+            encoded += text[i];
+            i++;
+        }
+    }
+
+    return encoded;
+}
+
+void SymbolTable::decode(const char *data, size_t length, std::string &out) const
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        unsigned char code = static_cast<unsigned char>(data[i]);
+        if (code == escapeCode)
+        {
+            if (++i < length)
+                out += data[i];
+        }
+        else if (code < symbols.size())
+        {
+            out.append(symbols[code].bytes, symbols[code].length);
+        }
+    }
+}
+
+std::string SymbolTable::serialize() const
+{
+    std::string data;
+    data += static_cast<char>(symbols.size());
+
+    for (const auto &symbol : symbols)
+    {
+        data += static_cast<char>(symbol.length);
+        data.append(symbol.bytes, symbol.length);
+    }
+
+    return data;
+}
+
+bool SymbolTable::deserialize(const std::string &data)
+{
+    symbols.clear();
+
+    if (data.empty())
+        return false;
+
+    size_t count = static_cast<unsigned char>(data[0]);
+    size_t position = 1;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (position >= data.length())
+            return false;
+
+        Symbol symbol;
+        std::memset(symbol.bytes, 0, sizeof(symbol.bytes));
+        symbol.length = static_cast<uint8_t>(data[position++]);
+
+        if (symbol.length == 0 || symbol.length > 8 || position + symbol.length > data.length())
+            return false;
+
+        std::memcpy(symbol.bytes, data.data() + position, symbol.length);
+        position += symbol.length;
+        symbols.push_back(symbol);
+    }
+
+    buildIndex();
+    return true;
+}
+
+size_t SymbolTable::memoryBytes() const
+{
+    size_t total = sizeof(*this) + symbols.capacity() * sizeof(Symbol);
+    for (const auto &codes : byFirstByte)
+        total += codes.capacity();
+    return total;
+}
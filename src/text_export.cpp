@@ -0,0 +1,248 @@
+#include "../include/text_export.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/uio.h>
+#include <unistd.h>
+
+bool parseExportFormat(const std::string &name, ExportFormat &format)
+{
+    if (name == "txt" || name == "text")
+        format = ExportFormat::Text;
+    else if (name == "csv")
+        format = ExportFormat::Csv;
+    else if (name == "json")
+        format = ExportFormat::Json;
+    else
+        return false;
+    return true;
+}
+
+void OutputBuffer::writeAll(const char *head, size_t headLength, const char *tail, size_t tailLength)
+{
+    struct iovec pieces[2] = {{const_cast<char *>(head), headLength}, {const_cast<char *>(tail), tailLength}};
+    int first = 0;
+
+    while (!failed && first < 2)
+    {
+        ssize_t count = writev(fd, pieces + first, 2 - first);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            failed = true;
+            break;
+        }
+
+        // Skip past whatever the kernel took, which may end mid-piece
+        size_t remaining = static_cast<size_t>(count);
+        written += remaining;
+        while (first < 2 && remaining >= pieces[first].iov_len)
+        {
+            remaining -= pieces[first].iov_len;
+            first++;
+        }
+        if (first < 2)
+        {
+            pieces[first].iov_base = static_cast<char *>(pieces[first].iov_base) + remaining;
+            pieces[first].iov_len -= remaining;
+        }
+    }
+}
+
+void OutputBuffer::append(const char *data, size_t length)
+{
+    if (used + length <= buffer.size())
+    {
+        std::memcpy(buffer.data() + used, data, length);
+        used += length;
+        return;
+    }
+
+    // Copying half a buffer or more saves nothing over a second iovec
+    if (length >= buffer.size() / 2)
+    {
+        writeAll(buffer.data(), used, data, length);
+        used = 0;
+        return;
+    }
+
+    flush();
+    std::memcpy(buffer.data(), data, length);
+    used = length;
+}
+
+void OutputBuffer::appendInt(long long value)
+{
+    char digits[21];
+    char *end = digits + sizeof(digits);
+    char *start = end;
+    unsigned long long magnitude = value < 0 ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+
+    do
+    {
+        *--start = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+
+    if (value < 0)
+        *--start = '-';
+    append(start, end - start);
+}
+
+bool OutputBuffer::flush()
+{
+    if (used)
+    {
+        writeAll(buffer.data(), used, nullptr, 0);
+        used = 0;
+    }
+    return !failed;
+}
+
+// Copy text into a quoted CSV field, doubling embedded quotes
+static void appendCsvField(OutputBuffer &out, const char *text, size_t length)
+{
+    out.append('"');
+    const char *end = text + length;
+    while (text < end)
+    {
+        const char *quote = static_cast<const char *>(std::memchr(text, '"', end - text));
+        if (!quote)
+        {
+            out.append(text, end - text);
+            break;
+        }
+        out.append(text, quote + 1 - text);
+        out.append('"');
+        text = quote + 1;
+    }
+    out.append('"');
+}
+
+// Runs of ordinary bytes (including UTF-8) are copied whole
+void appendJsonString(OutputBuffer &out, const char *text, size_t length)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    out.append('"');
+    size_t start = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        out.append(text + start, i - start);
+        start = i + 1;
+
+        out.append('\\');
+        switch (c)
+        {
+        case '"':
+        case '\\':
+            out.append(static_cast<char>(c));
+            break;
+        case '\n':
+            out.append('n');
+            break;
+        case '\r':
+            out.append('r');
+            break;
+        case '\t':
+            out.append('t');
+            break;
+        default:
+            out.append("u00", 3);
+            out.append(hex[c >> 4]);
+            out.append(hex[c & 15]);
+            break;
+        }
+    }
+    out.append(text + start, length - start);
+    out.append('"');
+}
+
+long exportVerses(sqlite3 *db, int firstId, int lastId, ExportFormat format, OutputBuffer &out)
+{
+    const char *query = "SELECT book, chapter, verse, text FROM bible WHERE id BETWEEN ? AND ? ORDER BY id";
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return -1;
+    }
+
+    sqlite3_bind_int(stmt, 1, firstId);
+    sqlite3_bind_int(stmt, 2, lastId);
+
+    if (format == ExportFormat::Csv)
+        out.append("book,chapter,verse,text\n", 24);
+    else if (format == ExportFormat::Json)
+        out.append('[');
+
+    // Column text is copied straight from SQLite's row buffer into the output
+    long count = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW && out.ok())
+    {
+        const char *book = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+        size_t bookLength = sqlite3_column_bytes(stmt, 0);
+        int chapter = sqlite3_column_int(stmt, 1);
+        int verse = sqlite3_column_int(stmt, 2);
+        const char *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
+        size_t textLength = sqlite3_column_bytes(stmt, 3);
+
+        switch (format)
+        {
+        case ExportFormat::Text:
+            out.append(book, bookLength);
+            out.append(' ');
+            out.appendInt(chapter);
+            out.append(':');
+            out.appendInt(verse);
+            out.append(' ');
+            out.append(text, textLength);
+            out.append('\n');
+            break;
+
+        case ExportFormat::Csv:
+            appendCsvField(out, book, bookLength);
+            out.append(", ", 2);
+            out.appendInt(chapter);
+            out.append(", ", 2);
+            out.appendInt(verse);
+            out.append(", ", 2);
+            appendCsvField(out, text, textLength);
+            out.append('\n');
+            break;
+
+        case ExportFormat::Json:
+            out.append(count ? ",\n{\"book\":" : "\n{\"book\":", count ? 10 : 9);
+            appendJsonString(out, book, bookLength);
+            out.append(",\"chapter\":", 11);
+            out.appendInt(chapter);
+            out.append(",\"verse\":", 9);
+            out.appendInt(verse);
+            out.append(",\"text\":", 8);
+            appendJsonString(out, text, textLength);
+            out.append('}');
+            break;
+        }
+        count++;
+    }
+
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_DONE && rc != SQLITE_ROW)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return -1;
+    }
+
+    if (format == ExportFormat::Json)
+        out.append("\n]\n", 3);
+
+    return count;
+}
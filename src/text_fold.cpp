@@ -0,0 +1,715 @@
+#include "../include/text_fold.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <set>
+
+// Base letters for U+0100..U+017F with accents removed; '*' marks ligatures
+static const char latinExtendedBase[] =
+    "aaaaaa"       // U+0100 A macron .. a ogonek
+    "cccccccc"     // U+0106 C acute .. c caron
+    "dddd"         // U+010E D caron .. d stroke
+    "eeeeeeeeee"   // U+0112 E macron .. e caron
+    "gggggggg"     // U+011C G circumflex .. g cedilla
+    "hhhh"         // U+0124 H circumflex .. h stroke
+    "iiiiiiiiii"   // U+0128 I tilde .. dotless i
+    "**"           // U+0132 IJ ligature
+    "jj"           // U+0134 J circumflex
+    "kkk"          // U+0136 K cedilla, kra
+    "llllllllll"   // U+0139 L acute .. l stroke
+    "nnnnnnn"      // U+0143 N acute .. n preceded by apostrophe
+    "nn"           // U+014A Eng
+    "oooooo"       // U+014C O macron .. o double acute
+    "**"           // U+0152 OE ligature
+    "rrrrrr"       // U+0154 R acute .. r caron
+    "ssssssss"     // U+015A S acute .. s caron
+    "tttttt"       // U+0162 T cedilla .. t stroke
+    "uuuuuuuuuuuu" // U+0168 U tilde .. u ogonek
+    "ww"           // U+0174 W circumflex
+    "yyy"          // U+0176 Y circumflex .. Y diaeresis
+    "zzzzzz"       // U+0179 Z acute .. z caron
+    "s";           // U+017F long s
+
+// Folded form of U+00C0..U+00FF with accents removed; nullptr keeps the character
+static const char *const latin1Base[64] = {
+    "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+    "d", "n", "o", "o", "o", "o", "o", nullptr, "o", "u", "u", "u", "u", "y", "th", "ss",
+    "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+    "d", "n", "o", "o", "o", "o", "o", nullptr, "o", "u", "u", "u", "u", "y", "th", "y"};
+
+static void appendUtf8(uint32_t cp, std::string &out)
+{
+    if (cp < 0x80)
+    {
+        out += static_cast<char>(cp);
+    }
+    else if (cp < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// Decode one UTF-8 character at text[i]. Invalid sequences decode as a single byte.
+static uint32_t decodeUtf8(const std::string &text, size_t i, size_t &length)
+{
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    uint32_t cp;
+
+    if (c < 0x80)
+    {
+        length = 1;
+        return c;
+    }
+    else if ((c & 0xE0) == 0xC0)
+    {
+        length = 2;
+        cp = c & 0x1F;
+    }
+    else if ((c & 0xF0) == 0xE0)
+    {
+        length = 3;
+        cp = c & 0x0F;
+    }
+    else if ((c & 0xF8) == 0xF0)
+    {
+        length = 4;
+        cp = c & 0x07;
+    }
+    else
+    {
+        length = 1;
+        return c;
+    }
+
+    if (i + length > text.length())
+    {
+        length = 1;
+        return c;
+    }
+
+    for (size_t k = 1; k < length; k++)
+    {
+        unsigned char next = static_cast<unsigned char>(text[i + k]);
+        if ((next & 0xC0) != 0x80)
+        {
+            length = 1;
+            return c;
+        }
+        cp = (cp << 6) | (next & 0x3F);
+    }
+
+    return cp;
+}
+
+// Strip tonos, dialytika and the polytonic marks from a lower-case Greek letter
+static uint32_t greekBase(uint32_t cp)
+{
+    static const uint32_t vowels[7] = {0x3B1, 0x3B5, 0x3B7, 0x3B9, 0x3BF, 0x3C5, 0x3C9};
+
+    switch (cp)
+    {
+    case 0x3AC:
+        return 0x3B1;
+    case 0x3AD:
+        return 0x3B5;
+    case 0x3AE:
+        return 0x3B7;
+    case 0x3AF:
+    case 0x390:
+    case 0x3CA:
+        return 0x3B9;
+    case 0x3CC:
+        return 0x3BF;
+    case 0x3B0:
+    case 0x3CB:
+    case 0x3CD:
+        return 0x3C5;
+    case 0x3CE:
+        return 0x3C9;
+    }
+
+    if (cp < 0x1F00 || cp > 0x1FFC)
+        return cp;
+
+    if (cp <= 0x1F6F)
+        return vowels[(cp - 0x1F00) >> 4];
+    if (cp <= 0x1F7D)
+        return vowels[(cp - 0x1F70) >> 1];
+    if (cp <= 0x1F8F)
+        return 0x3B1;
+    if (cp <= 0x1F9F)
+        return 0x3B7;
+    if (cp <= 0x1FAF)
+        return 0x3C9;
+    if (cp <= 0x1FBC)
+        return 0x3B1;
+    if (cp == 0x1FC8 || cp == 0x1FC9)
+        return 0x3B5;
+    if (cp >= 0x1FC2 && cp <= 0x1FCC)
+        return 0x3B7;
+    if (cp >= 0x1FD0 && cp <= 0x1FDB)
+        return 0x3B9;
+    if (cp >= 0x1FE4 && cp <= 0x1FE5)
+        return 0x3C1;
+    if (cp == 0x1FEC)
+        return 0x3C1;
+    if (cp >= 0x1FE0 && cp <= 0x1FEB)
+        return 0x3C5;
+    if (cp == 0x1FF8 || cp == 0x1FF9)
+        return 0x3BF;
+    if (cp >= 0x1FF2 && cp <= 0x1FFC)
+        return 0x3C9;
+
+    return cp;
+}
+
+// Append the folded form of one code point. Returns false if it folds to itself.
+static bool foldCodepoint(uint32_t cp, const FoldOptions &options, std::string &out)
+{
+    if (cp < 0x80)
+    {
+        if (cp >= 'A' && cp <= 'Z')
+        {
+            out += static_cast<char>(cp + 0x20);
+            return true;
+        }
+        return false;
+    }
+
+    // Compatibility spaces (no-break, en/em, narrow, ideographic)
+    if (cp == 0xA0 || (cp >= 0x2000 && cp <= 0x200A) || cp == 0x202F || cp == 0x205F || cp == 0x3000)
+    {
+        out += ' ';
+        return true;
+    }
+
+    // Combining diacritical marks
+    if (cp >= 0x300 && cp <= 0x36F)
+    {
+        return options.stripDiacritics;
+    }
+
+    if (cp >= 0xC0 && cp <= 0xFF)
+    {
+        if (options.stripDiacritics)
+        {
+            const char *base = latin1Base[cp - 0xC0];
+            if (!base)
+                return false;
+            out += base;
+            return true;
+        }
+        if (cp == 0xDF)
+        {
+            out += "ss";
+            return true;
+        }
+        if (cp <= 0xDE && cp != 0xD7)
+        {
+            appendUtf8(cp + 0x20, out);
+            return true;
+        }
+        return false;
+    }
+
+    if (cp >= 0x100 && cp <= 0x17F)
+    {
+        if (cp == 0x132 || cp == 0x133)
+        {
+            out += "ij";
+            return true;
+        }
+        if (options.stripDiacritics)
+        {
+            char base = latinExtendedBase[cp - 0x100];
+            if (base == '*')
+                out += "oe";
+            else
+                out += base;
+            return true;
+        }
+
+        uint32_t lower = cp;
+        if (cp == 0x130)
+            lower = 'i';
+        else if ((cp < 0x138 || (cp >= 0x14A && cp < 0x178)) && cp % 2 == 0)
+            lower = cp + 1;
+        else if (((cp >= 0x139 && cp < 0x149) || (cp >= 0x179 && cp < 0x17F)) && cp % 2 == 1)
+            lower = cp + 1;
+        else if (cp == 0x178)
+            lower = 0xFF;
+        else if (cp == 0x17F)
+            lower = 's';
+
+        if (lower == cp)
+            return false;
+        appendUtf8(lower, out);
+        return true;
+    }
+
+    if (cp >= 0x370 && cp <= 0x3FF)
+    {
+        uint32_t lower = cp;
+        if ((cp >= 0x391 && cp <= 0x3A1) || (cp >= 0x3A3 && cp <= 0x3AB))
+            lower = cp + 0x20;
+        else if (cp == 0x386)
+            lower = 0x3AC;
+        else if (cp >= 0x388 && cp <= 0x38A)
+            lower = cp + 0x25;
+        else if (cp == 0x38C)
+            lower = 0x3CC;
+        else if (cp == 0x38E || cp == 0x38F)
+            lower = cp + 0x3F;
+        else if (cp == 0x3C2)
+            lower = 0x3C3; // Final sigma
+
+        if (options.stripDiacritics)
+            lower = greekBase(lower);
+
+        if (lower == cp)
+            return false;
+        appendUtf8(lower, out);
+        return true;
+    }
+
+    if (cp >= 0x1F00 && cp <= 0x1FFF)
+    {
+        uint32_t lower = cp;
+        if (options.stripDiacritics)
+            lower = greekBase(cp);
+        else if (((cp >= 0x1F00 && cp <= 0x1F6F) || (cp >= 0x1F80 && cp <= 0x1FAF)) && (cp & 0x8))
+            lower = cp - 8;
+
+        if (lower == cp)
+            return false;
+        appendUtf8(lower, out);
+        return true;
+    }
+
+    if (cp >= 0x400 && cp <= 0x45F)
+    {
+        uint32_t lower = cp;
+        if (cp >= 0x410 && cp <= 0x42F)
+            lower = cp + 0x20;
+        else if (cp < 0x410)
+            lower = cp + 0x50;
+
+        if (options.stripDiacritics && (lower == 0x450 || lower == 0x451))
+            lower = 0x435;
+
+        if (lower == cp)
+            return false;
+        appendUtf8(lower, out);
+        return true;
+    }
+
+    // Latin ligatures (ff, fi, fl, ffi, ffl, long st, st)
+    if (cp >= 0xFB00 && cp <= 0xFB06)
+    {
+        static const char *const ligatures[7] = {"ff", "fi", "fl", "ffi", "ffl", "st", "st"};
+        out += ligatures[cp - 0xFB00];
+        return true;
+    }
+
+    return false;
+}
+
+std::string foldText(const std::string &text, const FoldOptions &options, FoldMap *map)
+{
+    std::string folded;
+    folded.reserve(text.length());
+
+    if (map)
+        map->clear();
+
+    for (size_t i = 0; i < text.length();)
+    {
+        size_t length;
+        uint32_t cp = decodeUtf8(text, i, length);
+        size_t start = folded.length();
+
+        bool changed = foldCodepoint(cp, options, folded);
+        if (!changed)
+        {
+            folded.append(text, i, length);
+        }
+
+        // Expansions like "ß" -> "ss" keep the byte count but must still be
+        // mapped as a unit, or a range could end in the middle of "ß"
+        size_t foldedLength = folded.length() - start;
+        bool expanded = changed && foldedLength > 1 && static_cast<unsigned char>(folded[start]) < 0x80;
+        if (map && (foldedLength != length || expanded))
+        {
+            map->push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(i),
+                            static_cast<uint8_t>(foldedLength), static_cast<uint8_t>(length)});
+        }
+
+        i += length;
+    }
+
+    return folded;
+}
+
+// Folded form of one code point, the code point itself when folding keeps it
+static std::string foldedCodepoint(uint32_t cp, const FoldOptions &options)
+{
+    std::string folded;
+    if (!foldCodepoint(cp, options, folded))
+        appendUtf8(cp, folded);
+    return folded;
+}
+
+// Append text to a pattern as literal characters
+static void appendEscaped(const std::string &text, std::string &out)
+{
+    for (char c : text)
+    {
+        if (std::strchr("\\^$.|?*+()[]{}", c))
+            out += '\\';
+        out += c;
+    }
+}
+
+// Whether a quantifier starts at pattern[i]; it would bind to the last byte only
+static bool quantifierAt(const std::string &pattern, size_t i)
+{
+    return i < pattern.length() && pattern[i] && std::strchr("*+?{", pattern[i]);
+}
+
+// Append \xHH or \uHHHH for a code point
+static void appendHexEscape(uint32_t cp, int digits, std::string &out)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    out += digits == 2 ? "\\x" : "\\u";
+    for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4)
+        out += hex[(cp >> shift) & 0xF];
+}
+
+// Append an ASCII character to a character class
+static void appendClassMember(int c, std::string &out)
+{
+    if (c < 0x20 || c == 0x7F)
+    {
+        appendHexEscape(c, 2, out);
+        return;
+    }
+    if (std::strchr("\\]^-[", c))
+        out += '\\';
+    out += static_cast<char>(c);
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+// Decode a \xHH or \uHHHH escape at pattern[i]
+static bool codeEscape(const std::string &pattern, size_t i, uint32_t &cp, size_t &length)
+{
+    if (i + 1 >= pattern.length() || pattern[i] != '\\' || (pattern[i + 1] != 'x' && pattern[i + 1] != 'u'))
+        return false;
+
+    size_t digits = pattern[i + 1] == 'x' ? 2 : 4;
+    if (i + 2 + digits > pattern.length())
+        return false;
+
+    cp = 0;
+    for (size_t k = 0; k < digits; k++)
+    {
+        int value = hexValue(pattern[i + 2 + k]);
+        if (value < 0)
+            return false;
+        cp = cp * 16 + value;
+    }
+
+    length = 2 + digits;
+    return true;
+}
+
+// Read one class member at pattern[i] and advance past it. Class escapes
+// like \d are copied to shorthands and read no code point.
+static bool classMember(const std::string &pattern, size_t &i, uint32_t &cp, std::string &shorthands)
+{
+    size_t length;
+    if (codeEscape(pattern, i, cp, length))
+    {
+        i += length;
+        return true;
+    }
+
+    if (pattern[i] == '\\' && i + 1 < pattern.length())
+    {
+        char c = pattern[i + 1];
+        const char *controls = c ? std::strchr("btnvfr", c) : nullptr;
+        if (c && std::strchr("dDwWsS", c))
+        {
+            shorthands.append(pattern, i, 2);
+            i += 2;
+            return false;
+        }
+        if (controls)
+        {
+            static const uint32_t codes[] = {8, 9, 10, 11, 12, 13};
+            cp = codes[controls - "btnvfr"];
+            i += 2;
+            return true;
+        }
+        if (c == 'c' && i + 2 < pattern.length() && isalpha(static_cast<unsigned char>(pattern[i + 2])))
+        {
+            cp = pattern[i + 2] % 32;
+            i += 3;
+            return true;
+        }
+        i++;
+    }
+
+    cp = decodeUtf8(pattern, i, length);
+    i += length;
+    return true;
+}
+
+// Fold a character class starting at pattern[i] (the '[') into out and
+// return the position after it. Members are folded one by one, ranges
+// member by member, since folding the endpoints of [À-Ö] would give [a-o].
+// Members that fold to several bytes become alternatives beside the class.
+static size_t foldClass(const std::string &pattern, size_t i, const FoldOptions &options, std::string &out)
+{
+    // Ranges wider than this keep their non-ASCII part as written
+    const uint32_t expansionLimit = 0x1000;
+
+    size_t end = i + 1;
+    bool negated = end < pattern.length() && pattern[end] == '^';
+    if (negated)
+        end++;
+
+    bool ascii[128] = {};
+    std::string shorthands;
+    std::set<std::string> sequences;
+    auto add = [&](uint32_t cp)
+    {
+        std::string folded = foldedCodepoint(cp, options);
+        if (folded.length() == 1 && static_cast<unsigned char>(folded[0]) < 0x80)
+            ascii[static_cast<unsigned char>(folded[0])] = true;
+        else if (!folded.empty())
+            sequences.insert(folded);
+    };
+
+    while (end < pattern.length() && pattern[end] != ']')
+    {
+        uint32_t first;
+        if (!classMember(pattern, end, first, shorthands))
+            continue;
+
+        uint32_t last = first;
+        size_t next = end + 1;
+        std::string rangeShorthands;
+        if (end + 1 < pattern.length() && pattern[end] == '-' && pattern[end + 1] != ']' &&
+            classMember(pattern, next, last, rangeShorthands))
+        {
+            // An out of order range is left for the regex compiler to reject
+            if (last < first)
+            {
+                out.append(pattern, i, std::string::npos);
+                return pattern.length();
+            }
+            end = next;
+        }
+
+        bool wide = last - first >= expansionLimit;
+        for (uint32_t cp = first; cp <= last && (cp < 0x80 || !wide); cp++)
+            add(cp);
+        if (wide && last >= 0x80)
+        {
+            appendHexEscape(std::max<uint32_t>(first, 0x80), 4, shorthands);
+            shorthands += '-';
+            appendHexEscape(std::min<uint32_t>(last, 0xFFFF), 4, shorthands);
+        }
+    }
+
+    // Unterminated: leave the rest for the regex compiler to reject
+    if (end >= pattern.length())
+    {
+        out.append(pattern, i, std::string::npos);
+        return pattern.length();
+    }
+
+    std::string set = negated ? "[^" : "[";
+    for (int c = 0; c < 128; c++)
+    {
+        if (!ascii[c])
+            continue;
+
+        int run = c;
+        while (run + 1 < 128 && ascii[run + 1])
+            run++;
+
+        appendClassMember(c, set);
+        if (run > c + 1)
+            set += '-';
+        if (run > c)
+            appendClassMember(run, set);
+        c = run;
+    }
+    set += shorthands + "]";
+
+    std::string alternatives;
+    for (const auto &sequence : sequences)
+    {
+        if (!alternatives.empty())
+            alternatives += '|';
+        appendEscaped(sequence, alternatives);
+    }
+
+    if (sequences.empty())
+        out += set;
+    else if (negated)
+        out += "(?:(?!" + alternatives + ")" + set + ")";
+    else if (set == "[]")
+        out += "(?:" + alternatives + ")";
+    else
+        out += "(?:" + set + "|" + alternatives + ")";
+
+    return end + 1;
+}
+
+std::string foldPattern(const std::string &pattern, const FoldOptions &options)
+{
+    std::string folded;
+
+    for (size_t i = 0; i < pattern.length();)
+    {
+        if (pattern[i] == '[')
+        {
+            i = foldClass(pattern, i, options, folded);
+            continue;
+        }
+
+        // A literal written as \xHH or \uHHHH is folded like the character itself
+        uint32_t cp;
+        size_t length;
+        std::string literal;
+        if (codeEscape(pattern, i, cp, length))
+        {
+            literal = foldedCodepoint(cp, options);
+            if (cp < 0x80 && literal.length() == 1 && literal[0] == static_cast<char>(cp))
+                literal = pattern.substr(i, length);
+            else
+            {
+                std::string text = literal;
+                literal.clear();
+                appendEscaped(text, literal);
+            }
+        }
+        else if (pattern[i] == '\\' && i + 1 < pattern.length() && static_cast<unsigned char>(pattern[i + 1]) < 0x80)
+        {
+            // Classes, anchors, back references and escaped punctuation stay as written
+            length = pattern[i + 1] == 'c' && i + 2 < pattern.length() ? 3 : 2;
+            literal = pattern.substr(i, length);
+        }
+        else
+        {
+            // An escaped non-ASCII character is a plain literal
+            size_t start = pattern[i] == '\\' && i + 1 < pattern.length() ? i + 1 : i;
+            decodeUtf8(pattern, start, length);
+            std::string text = foldText(pattern.substr(start, length), options);
+            if (static_cast<unsigned char>(pattern[start]) < 0x80)
+                literal = text;
+            else
+                appendEscaped(text, literal);
+            length += start - i;
+        }
+
+        // A quantifier after "ß" must repeat all of "ss", not its last byte
+        bool group = literal.length() > 1 && literal[0] != '\\' && quantifierAt(pattern, i + length);
+        folded += group ? "(?:" + literal + ")" : literal;
+        i += length;
+    }
+
+    return folded;
+}
+
+// Translate a folded offset to an original one. An offset inside a folded
+// character maps to the character's start, or its end when isEnd is set.
+static size_t toOriginal(const FoldMap &map, size_t offset, bool isEnd)
+{
+    auto it = std::upper_bound(map.begin(), map.end(), offset,
+                               [](size_t value, const FoldAnchor &anchor)
+                               { return value < anchor.folded; });
+
+    if (it == map.begin())
+        return offset;
+
+    const FoldAnchor &anchor = *(it - 1);
+    size_t foldedEnd = anchor.folded + anchor.foldedLength;
+
+    if (offset >= foldedEnd)
+        return anchor.original + anchor.originalLength + (offset - foldedEnd);
+
+    if (isEnd && offset > anchor.folded)
+        return anchor.original + anchor.originalLength;
+
+    return anchor.original;
+}
+
+void mapFoldedRange(const FoldMap &map, size_t &begin, size_t &end)
+{
+    begin = toOriginal(map, begin, false);
+    end = toOriginal(map, end, true);
+}
+
+std::string encodeFoldMap(const FoldMap &map)
+{
+    std::string bytes;
+    bytes.reserve(map.size() * 10);
+
+    for (const auto &anchor : map)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+            bytes += static_cast<char>((anchor.folded >> shift) & 0xFF);
+        for (int shift = 0; shift < 32; shift += 8)
+            bytes += static_cast<char>((anchor.original >> shift) & 0xFF);
+        bytes += static_cast<char>(anchor.foldedLength);
+        bytes += static_cast<char>(anchor.originalLength);
+    }
+
+    return bytes;
+}
+
+FoldMap decodeFoldMap(const void *data, size_t bytes)
+{
+    FoldMap map;
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+
+    if (!p)
+        return map;
+
+    map.reserve(bytes / 10);
+    for (size_t i = 0; i + 10 <= bytes; i += 10)
+    {
+        FoldAnchor anchor;
+        anchor.folded = p[i] | (p[i + 1] << 8) | (p[i + 2] << 16) | (static_cast<uint32_t>(p[i + 3]) << 24);
+        anchor.original = p[i + 4] | (p[i + 5] << 8) | (p[i + 6] << 16) | (static_cast<uint32_t>(p[i + 7]) << 24);
+        anchor.foldedLength = p[i + 8];
+        anchor.originalLength = p[i + 9];
+        map.push_back(anchor);
+    }
+
+    return map;
+}
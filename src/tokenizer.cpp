@@ -0,0 +1,44 @@
+#include "../include/tokenizer.h"
+
+static bool isWordByte(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+std::vector<std::string> tokenize(const std::string &folded)
+{
+    std::vector<std::string> words;
+    size_t length = folded.length();
+    size_t i = 0;
+
+    while (i < length)
+    {
+        while (i < length && !isWordByte(static_cast<unsigned char>(folded[i])))
+            i++;
+
+        size_t start = i;
+        while (i < length)
+        {
+            unsigned char c = static_cast<unsigned char>(folded[i]);
+            if (isWordByte(c))
+            {
+                i++;
+            }
+            else if (c == '\'' && i > start && i + 1 < length && isWordByte(static_cast<unsigned char>(folded[i + 1])))
+            {
+                i++;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        if (i > start)
+        {
+            words.push_back(folded.substr(start, i - start));
+        }
+    }
+
+    return words;
+}
@@ -0,0 +1,713 @@
+#include "../include/translation_store.h"
+#include "../include/schema.h"
+#include "../include/content_hash.h"
+#include <map>
+#include <algorithm>
+#include <iostream>
+
+static void appendVarint(std::string &out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+static uint32_t readVarint(const std::string &data, size_t &position)
+{
+    uint32_t value = 0;
+    int shift = 0;
+    while (position < data.length())
+    {
+        unsigned char byte = static_cast<unsigned char>(data[position++]);
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            break;
+        shift += 7;
+    }
+    return value;
+}
+
+// First and last canonical id of every chapter of the base text, in order
+static std::vector<std::pair<int, int>> chapterRanges(sqlite3 *db)
+{
+    std::vector<std::pair<int, int>> ranges;
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, "SELECT MIN(id), MAX(id) FROM bible GROUP BY book, chapter ORDER BY 1", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return ranges;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        ranges.push_back({sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1)});
+    }
+
+    sqlite3_finalize(stmt);
+    return ranges;
+}
+
+// Raw text of a column, indexed by canonical id
+static bool loadRawTexts(sqlite3 *db, const std::string &code, bool isBase, std::vector<std::string> &texts)
+{
+    sqlite3_stmt *stmt;
+    int rc;
+
+    if (isBase)
+    {
+        rc = sqlite3_prepare_v2(db, "SELECT id, text FROM bible ORDER BY id", -1, &stmt, nullptr);
+    }
+    else
+    {
+        rc = sqlite3_prepare_v2(db, "SELECT verse_id, text FROM translation_text WHERE translation = ? ORDER BY verse_id", -1, &stmt, nullptr);
+        sqlite3_bind_text(stmt, 1, code.c_str(), -1, SQLITE_TRANSIENT);
+    }
+
+    if (rc != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        int id = sqlite3_column_int(stmt, 0);
+        if (id < 0)
+            continue;
+
+        if (id >= static_cast<int>(texts.size()))
+            texts.resize(id + 1);
+
+        texts[id] = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+    }
+
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+// Compressed blocks previously written for a translation, with their dictionary
+static bool loadStoredBlocks(sqlite3 *db, const std::string &code, SymbolTable &table,
+                             std::vector<std::pair<int, std::string>> &blocks, std::vector<int> &counts)
+{
+    // Read the dictionary and blocks from one snapshot so an import
+    // committing in between can't pair a new dictionary with old blocks
+    if (sqlite3_get_autocommit(db))
+    {
+        sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr);
+        bool found = loadStoredBlocks(db, code, table, blocks, counts);
+        sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+        return found;
+    }
+
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, "SELECT symbols FROM codec_dictionaries WHERE translation = ?", -1, &stmt, nullptr) != SQLITE_OK)
+        return false;
+
+    sqlite3_bind_text(stmt, 1, code.c_str(), -1, SQLITE_TRANSIENT);
+    bool found = false;
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        std::string symbols(static_cast<const char *>(sqlite3_column_blob(stmt, 0)), sqlite3_column_bytes(stmt, 0));
+        found = table.deserialize(symbols);
+    }
+    sqlite3_finalize(stmt);
+
+    if (!found)
+        return false;
+
+    if (sqlite3_prepare_v2(db, "SELECT first_id, verse_count, data FROM text_blocks WHERE translation = ? ORDER BY first_id", -1, &stmt, nullptr) != SQLITE_OK)
+        return false;
+
+    sqlite3_bind_text(stmt, 1, code.c_str(), -1, SQLITE_TRANSIENT);
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        const char *data = static_cast<const char *>(sqlite3_column_blob(stmt, 2));
+        blocks.push_back({sqlite3_column_int(stmt, 0), std::string(data, sqlite3_column_bytes(stmt, 2))});
+        counts.push_back(sqlite3_column_int(stmt, 1));
+    }
+    sqlite3_finalize(stmt);
+
+    return true;
+}
+
+// Block layout: a varint byte length per verse, then the encoded concatenated text
+static void decodeBlockTexts(const SymbolTable &table, const std::string &data, int verseCount, std::vector<std::string> &texts)
+{
+    size_t position = 0;
+    std::vector<uint32_t> lengths(verseCount);
+    for (int i = 0; i < verseCount; i++)
+    {
+        lengths[i] = readVarint(data, position);
+    }
+
+    std::string joined;
+    table.decode(data.data() + position, data.length() - position, joined);
+
+    texts.resize(verseCount);
+    size_t offset = 0;
+    for (int i = 0; i < verseCount; i++)
+    {
+        texts[i].assign(joined, std::min(offset, joined.length()), lengths[i]);
+        offset += lengths[i];
+    }
+}
+
+// Uncompressed block content: a varint length per verse and the joined text
+static void chapterPayload(const std::vector<std::string> &texts, const std::pair<int, int> &range, std::string &lengths, std::string &joined)
+{
+    for (int id = range.first; id <= range.second; id++)
+    {
+        const std::string &text = id < static_cast<int>(texts.size()) ? texts[id] : std::string();
+        appendVarint(lengths, static_cast<uint32_t>(text.length()));
+        joined += text;
+    }
+}
+
+void TranslationStore::buildBlocks(sqlite3 *db, const std::vector<std::string> &texts, SymbolTable &table,
+                                   std::vector<std::pair<int, std::string>> &blocks)
+{
+    // Train on a sample of about a megabyte spread over the whole text
+    std::vector<const std::string *> samples;
+    size_t total = 0;
+    for (const auto &text : texts)
+        total += text.length();
+
+    size_t stride = std::max<size_t>(1, total / (1 << 20));
+    for (size_t i = 0; i < texts.size(); i += stride)
+    {
+        if (!texts[i].empty())
+            samples.push_back(&texts[i]);
+    }
+    table.train(samples);
+
+    for (const auto &range : chapterRanges(db))
+    {
+        std::string lengths;
+        std::string joined;
+        chapterPayload(texts, range, lengths, joined);
+        blocks.push_back({range.first, lengths + table.encode(joined)});
+    }
+}
+
+// Rough cost of rebuilding an evicted entry, in microseconds
+static const double decodeCost = 20.0;
+static const double columnLoadCost = 300000.0;
+
+static size_t decodedBlockBytes(const std::vector<std::string> &texts)
+{
+    size_t total = texts.capacity() * sizeof(std::string);
+    for (const auto &text : texts)
+        total += heapBytes(text);
+    return total;
+}
+
+TranslationStore::TranslationStore() : decoded("decoded text blocks", decodeCost, decodedBlockBytes, 64)
+{
+}
+
+bool TranslationStore::open(sqlite3 *database)
+{
+    db = database;
+    columns.clear();
+    decoded.clear();
+
+    Column base;
+    base.code = getMeta(db, "base_translation", "base");
+    columns.push_back(base);
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT code FROM translations ORDER BY code", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        Column column;
+        column.code = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+        columns.push_back(column);
+    }
+
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+void TranslationStore::attach(MemoryBudget *memoryBudget)
+{
+    budget = memoryBudget;
+    budget->attach(this);
+    decoded.attach(budget);
+}
+
+bool TranslationStore::load(size_t index)
+{
+    if (index >= columns.size())
+        return false;
+
+    Column &column = columns[index];
+    if (column.loaded)
+        return true;
+
+    std::vector<std::pair<int, std::string>> blocks;
+    std::vector<int> counts;
+
+    // Compacted translations are read as stored; anything else is compressed on load
+    if (index == 0 || !loadStoredBlocks(db, column.code, column.table, blocks, counts))
+    {
+        std::vector<std::string> texts;
+        if (!loadRawTexts(db, column.code, index == 0, texts))
+            return false;
+
+        blocks.clear();
+        buildBlocks(db, texts, column.table, blocks);
+
+        counts.clear();
+        for (const auto &range : chapterRanges(db))
+            counts.push_back(range.second - range.first + 1);
+    }
+
+    column.blocks.clear();
+    column.blocks.reserve(blocks.size());
+    column.rawBytes = 0;
+    column.bytes = column.table.memoryBytes();
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        column.blocks.push_back({blocks[i].first, counts[i], std::move(blocks[i].second)});
+        column.bytes += sizeof(TextBlock) + heapBytes(column.blocks.back().data);
+
+        size_t position = 0;
+        for (int v = 0; v < counts[i]; v++)
+            column.rawBytes += readVarint(column.blocks.back().data, position);
+    }
+
+    column.loaded = true;
+    column.priority = budget ? budget->priority(columnLoadCost, column.bytes) : 0.0;
+    return true;
+}
+
+void TranslationStore::unload(size_t index)
+{
+    Column &column = columns[index];
+    column.loaded = false;
+    column.table = SymbolTable();
+    std::vector<TextBlock>().swap(column.blocks);
+    column.bytes = 0;
+
+    // Decoded blocks of the column stay valid; the LRU ages them out
+}
+
+const std::vector<std::string> &TranslationStore::decodedBlock(size_t column, size_t block)
+{
+    BlockKey key(column, block);
+    std::vector<std::string> *cached = decoded.find(key);
+    if (cached)
+        return *cached;
+
+    std::vector<std::string> texts;
+    const TextBlock &textBlock = columns[column].blocks[block];
+    decodeBlockTexts(columns[column].table, textBlock.data, textBlock.verseCount, texts);
+    return decoded.insert(key, std::move(texts));
+}
+
+std::string TranslationStore::text(size_t index, int verseId)
+{
+    if (index >= columns.size() || !load(index))
+        return std::string();
+
+    Column &column = columns[index];
+    if (budget)
+        column.priority = budget->priority(columnLoadCost, column.bytes);
+
+    const std::vector<TextBlock> &blocks = column.blocks;
+    auto it = std::upper_bound(blocks.begin(), blocks.end(), verseId, [](int id, const TextBlock &block)
+                               { return id < block.firstId; });
+
+    if (it == blocks.begin())
+        return std::string();
+
+    --it;
+    if (verseId >= it->firstId + it->verseCount)
+        return std::string();
+
+    return decodedBlock(index, it - blocks.begin())[verseId - it->firstId];
+}
+
+size_t TranslationStore::compressedBytes(size_t column) const
+{
+    size_t total = 0;
+    for (const auto &block : columns[column].blocks)
+        total += block.data.length();
+    return total;
+}
+
+size_t TranslationStore::bytesUsed() const
+{
+    size_t total = columns.capacity() * sizeof(Column);
+    for (const auto &column : columns)
+        total += heapBytes(column.code) + column.bytes;
+    return total;
+}
+
+size_t TranslationStore::entryCount() const
+{
+    return std::count_if(columns.begin(), columns.end(), [](const Column &column)
+                         { return column.loaded; });
+}
+
+double TranslationStore::oldestPriority() const
+{
+    double lowest = std::numeric_limits<double>::infinity();
+    for (const auto &column : columns)
+    {
+        if (column.loaded)
+            lowest = std::min(lowest, column.priority);
+    }
+    return lowest;
+}
+
+size_t TranslationStore::evictOldest()
+{
+    double lowest = oldestPriority();
+    for (size_t i = 0; i < columns.size(); i++)
+    {
+        if (columns[i].loaded && columns[i].priority == lowest)
+        {
+            size_t freed = columns[i].bytes;
+            unload(i);
+            return freed;
+        }
+    }
+    return 0;
+}
+
+// Content hashes stored for a translation's chapters, by first canonical id
+static std::map<int, uint64_t> loadChapterHashes(sqlite3 *db, const std::string &code)
+{
+    std::map<int, uint64_t> hashes;
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, "SELECT first_id, hash FROM chapter_hashes WHERE translation = ?", -1, &stmt, nullptr) != SQLITE_OK)
+        return hashes;
+
+    sqlite3_bind_text(stmt, 1, code.c_str(), -1, SQLITE_TRANSIENT);
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        hashes[sqlite3_column_int(stmt, 0)] = static_cast<uint64_t>(sqlite3_column_int64(stmt, 1));
+    }
+
+    sqlite3_finalize(stmt);
+    return hashes;
+}
+
+bool prepareCompaction(sqlite3 *db, const std::string &code, const std::vector<std::pair<int, std::string>> &rows,
+                       CompactedTranslation &compacted)
+{
+    // What was compacted before, kept to count changed verses and to reuse
+    // the blocks of unchanged chapters
+    SymbolTable previous;
+    std::vector<std::pair<int, std::string>> stored;
+    std::vector<int> counts;
+    std::vector<std::string> oldTexts;
+    std::map<int, size_t> storedBytes; // Block size by first id
+
+    bool compactedBefore = loadStoredBlocks(db, code, previous, stored, counts);
+    if (compactedBefore)
+    {
+        for (size_t i = 0; i < stored.size(); i++)
+        {
+            std::vector<std::string> blockTexts;
+            decodeBlockTexts(previous, stored[i].second, counts[i], blockTexts);
+            storedBytes[stored[i].first] = stored[i].second.length();
+
+            for (int v = 0; v < counts[i]; v++)
+            {
+                int id = stored[i].first + v;
+                if (id >= static_cast<int>(oldTexts.size()))
+                    oldTexts.resize(id + 1);
+                oldTexts[id] = blockTexts[v];
+            }
+        }
+    }
+
+    // The new text is the pending raw rows and the newly parsed rows only, so
+    // a verse missing from the new import is dropped, not carried over
+    std::vector<std::string> texts;
+    if (!loadRawTexts(db, code, false, texts))
+        return false;
+
+    bool hasRawRows = false;
+    for (const auto &text : texts)
+        hasRawRows = hasRawRows || !text.empty();
+
+    for (const auto &row : rows)
+    {
+        if (row.first < 0)
+            continue;
+        if (row.first >= static_cast<int>(texts.size()))
+            texts.resize(row.first + 1);
+        texts[row.first] = row.second;
+    }
+
+    // With nothing new at all, recompacting re-encodes the stored text
+    if (!hasRawRows && rows.empty())
+        texts = oldTexts;
+
+    compacted.code = code;
+    compacted.blocks.clear();
+    compacted.counts.clear();
+    compacted.hashes.clear();
+    compacted.changedChapters = 0;
+    compacted.changedVerses = 0;
+
+    compacted.rawBytes = 0;
+    for (const auto &text : texts)
+        compacted.rawBytes += text.length();
+
+    for (size_t id = 0; id < std::max(texts.size(), oldTexts.size()); id++)
+    {
+        const std::string &before = id < oldTexts.size() ? oldTexts[id] : std::string();
+        const std::string &after = id < texts.size() ? texts[id] : std::string();
+        if (before != after)
+            compacted.changedVerses++;
+    }
+
+    // Hash every chapter and find the ones that differ from the last import
+    std::vector<std::pair<int, int>> ranges = chapterRanges(db);
+    std::map<int, uint64_t> storedHashes = loadChapterHashes(db, code);
+    std::vector<std::string> payloads(ranges.size());
+    std::vector<size_t> lengthBytes(ranges.size());
+    std::vector<bool> changed(ranges.size());
+
+    compacted.chapters = ranges.size();
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        std::string lengths;
+        std::string joined;
+        chapterPayload(texts, ranges[i], lengths, joined);
+        lengthBytes[i] = lengths.length();
+        payloads[i] = lengths + joined;
+
+        uint64_t hash = contentHash(payloads[i]);
+        auto found = storedHashes.find(ranges[i].first);
+        changed[i] = found == storedHashes.end() || found->second != hash;
+        compacted.hashes.push_back({ranges[i].first, hash});
+        if (changed[i])
+            compacted.changedChapters++;
+    }
+
+    // A small revision keeps the trained dictionary and re-encodes only the
+    // chapters that changed; a large one is worth retraining for
+    compacted.incremental = compactedBefore && !hasRawRows && !storedHashes.empty() &&
+                            compacted.changedChapters * 2 <= ranges.size();
+
+    if (compacted.incremental)
+    {
+        compacted.symbols.clear();
+        compacted.compressedBytes = previous.serialize().length();
+        std::vector<std::pair<int, uint64_t>> changedHashes;
+        for (size_t i = 0; i < ranges.size(); i++)
+        {
+            if (!changed[i])
+            {
+                compacted.compressedBytes += storedBytes[ranges[i].first];
+                continue;
+            }
+
+            std::string data = payloads[i].substr(0, lengthBytes[i]) + previous.encode(payloads[i].substr(lengthBytes[i]));
+            compacted.compressedBytes += data.length();
+            compacted.blocks.push_back({ranges[i].first, std::move(data)});
+            compacted.counts.push_back(ranges[i].second - ranges[i].first + 1);
+            changedHashes.push_back(compacted.hashes[i]);
+        }
+        compacted.hashes.swap(changedHashes);
+        return true;
+    }
+
+    SymbolTable table;
+    TranslationStore::buildBlocks(db, texts, table, compacted.blocks);
+    compacted.symbols = table.serialize();
+
+    for (const auto &range : ranges)
+        compacted.counts.push_back(range.second - range.first + 1);
+
+    compacted.compressedBytes = compacted.symbols.length();
+    for (const auto &block : compacted.blocks)
+        compacted.compressedBytes += block.second.length();
+
+    return true;
+}
+
+bool writeCompaction(sqlite3 *db, const CompactedTranslation &compacted)
+{
+    const std::string &code = compacted.code;
+    sqlite3_stmt *deleteRows;
+    sqlite3_stmt *insertDictionary = nullptr;
+    sqlite3_stmt *insertBlock;
+    sqlite3_stmt *insertHash;
+
+    // An incremental write replaces only the changed blocks under the old dictionary
+    std::vector<const char *> deleteSQL = {"DELETE FROM translation_text WHERE translation = ?"};
+    if (!compacted.incremental)
+    {
+        deleteSQL.push_back("DELETE FROM text_blocks WHERE translation = ?");
+        deleteSQL.push_back("DELETE FROM chapter_hashes WHERE translation = ?");
+    }
+
+    for (const char *sql : deleteSQL)
+    {
+        if (sqlite3_prepare_v2(db, sql, -1, &deleteRows, nullptr) == SQLITE_OK)
+        {
+            sqlite3_bind_text(deleteRows, 1, code.c_str(), -1, SQLITE_STATIC);
+            sqlite3_step(deleteRows);
+        }
+        sqlite3_finalize(deleteRows);
+    }
+
+    if ((!compacted.incremental &&
+         sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO codec_dictionaries (translation, symbols) VALUES (?, ?)", -1, &insertDictionary, nullptr) != SQLITE_OK) ||
+        sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO text_blocks (translation, first_id, verse_count, data) VALUES (?, ?, ?, ?)", -1, &insertBlock, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, "INSERT OR REPLACE INTO chapter_hashes (translation, first_id, hash) VALUES (?, ?, ?)", -1, &insertHash, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_finalize(insertDictionary);
+        return false;
+    }
+
+    bool ok = true;
+    if (insertDictionary)
+    {
+        sqlite3_bind_text(insertDictionary, 1, code.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_blob(insertDictionary, 2, compacted.symbols.data(), compacted.symbols.length(), SQLITE_STATIC);
+        ok = sqlite3_step(insertDictionary) == SQLITE_DONE;
+        sqlite3_finalize(insertDictionary);
+    }
+
+    for (size_t i = 0; ok && i < compacted.blocks.size(); i++)
+    {
+        sqlite3_bind_text(insertBlock, 1, code.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(insertBlock, 2, compacted.blocks[i].first);
+        sqlite3_bind_int(insertBlock, 3, compacted.counts[i]);
+        sqlite3_bind_blob(insertBlock, 4, compacted.blocks[i].second.data(), compacted.blocks[i].second.length(), SQLITE_STATIC);
+        ok = sqlite3_step(insertBlock) == SQLITE_DONE;
+        sqlite3_reset(insertBlock);
+    }
+    sqlite3_finalize(insertBlock);
+
+    for (size_t i = 0; ok && i < compacted.hashes.size(); i++)
+    {
+        sqlite3_bind_text(insertHash, 1, code.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(insertHash, 2, compacted.hashes[i].first);
+        sqlite3_bind_int64(insertHash, 3, static_cast<sqlite3_int64>(compacted.hashes[i].second));
+        ok = sqlite3_step(insertHash) == SQLITE_DONE;
+        sqlite3_reset(insertHash);
+    }
+    sqlite3_finalize(insertHash);
+
+    if (!ok)
+        std::cerr << "Error writing compressed text: " << sqlite3_errmsg(db) << std::endl;
+    return ok;
+}
+
+bool compactTranslation(sqlite3 *db, const std::string &code, size_t &rawBytes, size_t &compressedBytes)
+{
+    CompactedTranslation compacted;
+    if (!prepareCompaction(db, code, {}, compacted))
+        return false;
+
+    char *errMsg = nullptr;
+    if (sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, &errMsg) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+
+    if (!writeCompaction(db, compacted))
+    {
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+        return false;
+    }
+
+    if (sqlite3_exec(db, "COMMIT;", nullptr, nullptr, &errMsg) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+
+    rawBytes = compacted.rawBytes;
+    compressedBytes = compacted.compressedBytes;
+    return true;
+}
+
+bool CanonicalResolver::open(sqlite3 *db, const std::string &translationCode)
+{
+    translation = translationCode;
+
+    const char *mappingSQL =
+        "SELECT canonical_book, canonical_chapter, canonical_verse FROM versification "
+        "WHERE translation = ? AND book = ? AND chapter = ? AND verse = ?";
+    const char *verseSQL = "SELECT id FROM bible WHERE book = ? AND chapter = ? AND verse = ?";
+
+    if (sqlite3_prepare_v2(db, mappingSQL, -1, &selectMapping, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, verseSQL, -1, &selectVerse, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+int CanonicalResolver::resolve(const std::string &book, int chapter, int verse)
+{
+    std::string canonicalBook = book;
+    int canonicalChapter = chapter;
+    int canonicalVerse = verse;
+
+    sqlite3_bind_text(selectMapping, 1, translation.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(selectMapping, 2, book.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(selectMapping, 3, chapter);
+    sqlite3_bind_int(selectMapping, 4, verse);
+
+    if (sqlite3_step(selectMapping) == SQLITE_ROW)
+    {
+        canonicalBook = reinterpret_cast<const char *>(sqlite3_column_text(selectMapping, 0));
+        canonicalChapter = sqlite3_column_int(selectMapping, 1);
+        canonicalVerse = sqlite3_column_int(selectMapping, 2);
+    }
+    sqlite3_reset(selectMapping);
+
+    int id = -1;
+    sqlite3_bind_text(selectVerse, 1, canonicalBook.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(selectVerse, 2, canonicalChapter);
+    sqlite3_bind_int(selectVerse, 3, canonicalVerse);
+
+    if (sqlite3_step(selectVerse) == SQLITE_ROW)
+    {
+        id = sqlite3_column_int(selectVerse, 0);
+    }
+    sqlite3_reset(selectVerse);
+
+    return id;
+}
+
+void CanonicalResolver::close()
+{
+    sqlite3_finalize(selectMapping);
+    sqlite3_finalize(selectVerse);
+    selectMapping = nullptr;
+    selectVerse = nullptr;
+}
+
+CanonicalResolver::~CanonicalResolver()
+{
+    close();
+}
@@ -0,0 +1,314 @@
+#include "../include/verse_index.h"
+#include "../include/memory_budget.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+size_t firstNewTestamentBook(size_t bookCount)
+{
+    const size_t oldTestamentBooks = 39;
+    const size_t newTestamentBooks = 27;
+    return bookCount > oldTestamentBooks ? bookCount - newTestamentBooks : bookCount;
+}
+
+bool VerseIndex::load(sqlite3 *db)
+{
+    bookNames.clear();
+    bookChapterStart.clear();
+    chapterStart.clear();
+    chapterBook.clear();
+    verseChapter.clear();
+
+    // Verse numbers are used as offsets, so a chapter spans up to its highest verse
+    const char *query = "SELECT book, chapter, MAX(verse) FROM bible GROUP BY book, chapter ORDER BY MIN(id)";
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    int total = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        std::string book = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+        int chapter = sqlite3_column_int(stmt, 1);
+        int verses = std::max(0, sqlite3_column_int(stmt, 2));
+
+        if (bookNames.empty() || bookNames.back() != book)
+        {
+            bookNames.push_back(book);
+            bookChapterStart.push_back(static_cast<int>(chapterStart.size()));
+        }
+
+        // Missing chapters keep their slot, empty
+        int book_ = static_cast<int>(bookNames.size()) - 1;
+        while (static_cast<int>(chapterStart.size()) - bookChapterStart.back() < chapter)
+        {
+            chapterStart.push_back(total);
+            chapterBook.push_back(book_);
+        }
+
+        int slot = static_cast<int>(chapterStart.size()) - 1;
+        verseChapter.insert(verseChapter.end(), verses, slot);
+        total += verses;
+    }
+
+    sqlite3_finalize(stmt);
+
+    bookChapterStart.push_back(static_cast<int>(chapterStart.size()));
+    chapterStart.push_back(total);
+    return true;
+}
+
+size_t VerseIndex::memoryBytes() const
+{
+    size_t total = (bookChapterStart.capacity() + chapterStart.capacity() + chapterBook.capacity() +
+                    verseChapter.capacity()) * sizeof(int);
+    for (const auto &name : bookNames)
+        total += sizeof(name) + heapBytes(name);
+    return total;
+}
+
+int VerseIndex::verseCount(int book, int chapter) const
+{
+    if (book < 0 || book >= static_cast<int>(bookNames.size()) || chapter < 1 || chapter > chapterCount(book))
+        return 0;
+
+    int slot = bookChapterStart[book] + chapter - 1;
+    return chapterStart[slot + 1] - chapterStart[slot];
+}
+
+int VerseIndex::absolute(const VersePosition &position) const
+{
+    if (position.verse < 1 || position.verse > verseCount(position.book, position.chapter))
+        return -1;
+
+    return chapterStart[bookChapterStart[position.book] + position.chapter - 1] + position.verse - 1;
+}
+
+VersePosition VerseIndex::position(int absolute) const
+{
+    VersePosition result;
+    if (verseChapter.empty())
+        return result;
+
+    absolute = std::max(0, std::min(absolute, static_cast<int>(verseChapter.size()) - 1));
+    int slot = verseChapter[absolute];
+    result.book = chapterBook[slot];
+    result.chapter = slot - bookChapterStart[result.book] + 1;
+    result.verse = absolute - chapterStart[slot] + 1;
+    return result;
+}
+
+bool VerseIndex::adjacentChapter(const VersePosition &from, int step, VersePosition &to) const
+{
+    if (from.book < 0 || from.book >= static_cast<int>(bookNames.size()))
+        return false;
+
+    // Skip over empty chapter slots
+    int slot = bookChapterStart[from.book] + from.chapter - 1;
+    for (slot += step; slot >= 0 && slot + 1 < static_cast<int>(chapterStart.size()); slot += step)
+    {
+        if (chapterStart[slot + 1] > chapterStart[slot])
+        {
+            to = position(chapterStart[slot]);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::string VerseIndex::reference(const VersePosition &position) const
+{
+    return bookNames[position.book] + " " + std::to_string(position.chapter) + ":" + std::to_string(position.verse);
+}
+
+double VerseIndex::percent(const VersePosition &position) const
+{
+    int index = absolute(position);
+    if (index < 0 || totalVerses() == 0)
+        return 0.0;
+
+    return 100.0 * index / totalVerses();
+}
+
+// Lower-case letters and digits only, so "1 Cor." and "1cor" compare equal
+static std::string normalizeName(const std::string &name)
+{
+    std::string normalized;
+    for (unsigned char c : name)
+    {
+        if (std::isalnum(c))
+            normalized += static_cast<char>(std::tolower(c));
+    }
+    return normalized;
+}
+
+int VerseIndex::findBook(const std::string &name) const
+{
+    std::string wanted = normalizeName(name);
+    if (wanted.empty())
+        return -1;
+
+    // Common abbreviations that are not prefixes of the full name
+    static const char *const aliases[][2] = {
+        {"jn", "john"}, {"jhn", "john"}, {"mt", "matthew"}, {"mk", "mark"}, {"mrk", "mark"},
+        {"lk", "luke"}, {"jdg", "judges"}, {"jg", "judges"}, {"php", "philippians"},
+        {"phm", "philemon"}, {"ss", "songofsolomon"}, {"sos", "songofsolomon"},
+        {"canticles", "songofsolomon"}, {"qoh", "ecclesiastes"}, {"ezk", "ezekiel"},
+        {"jas", "james"}, {"jm", "james"}, {"jnh", "jonah"}, {"nam", "nahum"},
+        {"zph", "zephaniah"}, {"hg", "haggai"}, {"rv", "revelation"}, {"apoc", "revelation"},
+        {"pss", "psalms"}, {"psa", "psalms"}, {"ps", "psalms"}, {"prv", "proverbs"}, {"dt", "deuteronomy"}};
+
+    std::string prefix = wanted;
+    for (const auto &alias : aliases)
+    {
+        // Keep a leading book number: "1jn" becomes "1john"
+        size_t digits = prefix.find_first_not_of("0123456789");
+        if (digits != std::string::npos && prefix.substr(digits) == alias[0])
+        {
+            prefix = prefix.substr(0, digits) + alias[1];
+            break;
+        }
+    }
+
+    // An exact name wins; otherwise the first book in canonical order it abbreviates
+    int first = -1;
+    for (size_t i = 0; i < bookNames.size(); i++)
+    {
+        std::string candidate = normalizeName(bookNames[i]);
+        if (candidate == prefix)
+            return static_cast<int>(i);
+        if (first < 0 && candidate.compare(0, prefix.length(), prefix) == 0)
+            first = static_cast<int>(i);
+    }
+
+    return first;
+}
+
+bool VerseIndex::parseParts(const std::string &text, std::string &book, int &chapter, int &verse, Precision &precision) const
+{
+    std::istringstream stream(text);
+    std::vector<std::string> tokens;
+    std::string token;
+    while (stream >> token)
+        tokens.push_back(token);
+
+    if (tokens.empty())
+        return false;
+
+    // A trailing "C", "C:V" or "C.V" is the chapter and verse; the rest names the
+    // book. A lone number is only numbers, as in the end of "John 3:16-18".
+    precision = BookOnly;
+    chapter = 1;
+    verse = 1;
+    const std::string &last = tokens.back();
+    if (std::isdigit(static_cast<unsigned char>(last[0])) && (tokens.size() > 1 || last.find_first_not_of("0123456789:.") == std::string::npos))
+    {
+        char *end = nullptr;
+        chapter = static_cast<int>(std::strtol(last.c_str(), &end, 10));
+        precision = ChapterOnly;
+        if (*end == ':' || *end == '.')
+        {
+            verse = static_cast<int>(std::strtol(end + 1, &end, 10));
+            precision = FullVerse;
+        }
+        if (*end != '\0')
+            return false;
+
+        tokens.pop_back();
+    }
+
+    book.clear();
+    for (const auto &part : tokens)
+        book += (book.empty() ? "" : " ") + part;
+
+    return true;
+}
+
+bool VerseIndex::resolve(int book, int chapter, int verse, Precision precision, bool toEnd, VersePosition &position) const
+{
+    if (book < 0 || book >= static_cast<int>(bookNames.size()))
+        return false;
+
+    // "Jude 5" means verse 5 of a book with a single chapter
+    if (precision == ChapterOnly && chapterCount(book) == 1 && chapter > 1)
+    {
+        verse = chapter;
+        chapter = 1;
+        precision = FullVerse;
+    }
+
+    if (precision == BookOnly)
+        chapter = toEnd ? chapterCount(book) : 1;
+    if (precision != FullVerse)
+        verse = toEnd ? verseCount(book, chapter) : 1;
+
+    VersePosition candidate;
+    candidate.book = book;
+    candidate.chapter = chapter;
+    candidate.verse = verse;
+    if (absolute(candidate) < 0)
+        return false;
+
+    position = candidate;
+    return true;
+}
+
+bool VerseIndex::parseReference(const std::string &text, VersePosition &position) const
+{
+    std::string name;
+    int chapter, verse;
+    Precision precision;
+    if (!parseParts(text, name, chapter, verse, precision) || name.empty())
+        return false;
+
+    return resolve(findBook(name), chapter, verse, precision, false, position);
+}
+
+bool VerseIndex::parseRange(const std::string &text, VersePosition &first, VersePosition &last) const
+{
+    size_t dash = text.find('-');
+    std::string name;
+    int chapter, verse;
+    Precision precision;
+    if (!parseParts(text.substr(0, dash), name, chapter, verse, precision) || name.empty())
+        return false;
+
+    int book = findBook(name);
+    if (!resolve(book, chapter, verse, precision, false, first))
+        return false;
+
+    // A single reference covers everything it names
+    if (dash == std::string::npos)
+        return resolve(book, chapter, verse, precision, true, last);
+
+    std::string endName;
+    int endChapter, endVerse;
+    Precision endPrecision;
+    if (!parseParts(text.substr(dash + 1), endName, endChapter, endVerse, endPrecision))
+        return false;
+
+    int endBook = book;
+    if (!endName.empty())
+    {
+        endBook = findBook(endName);
+    }
+    else if (precision == FullVerse && endPrecision == ChapterOnly)
+    {
+        // "John 3:16-18" ends at a verse of the same chapter
+        endVerse = endChapter;
+        endChapter = first.chapter;
+        endPrecision = FullVerse;
+    }
+
+    if (!resolve(endBook, endChapter, endVerse, endPrecision, true, last))
+        return false;
+
+    return absolute(first) <= absolute(last);
+}
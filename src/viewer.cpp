@@ -0,0 +1,1484 @@
+// Bible Terminal Viewer with SQLite Database
+
+#include "../include/viewer.h"
+#include "../include/corpus.h"
+#include "../include/regex_search.h"
+#include "../include/aho_corasick.h"
+#include "../include/schema.h"
+#include "../include/text_fold.h"
+#include "../include/stem_index.h"
+#include "../include/tokenizer.h"
+#include "../include/bm25.h"
+#include "../include/minhash.h"
+#include "../include/translation_store.h"
+#include "../include/memory_budget.h"
+#include "../include/list_view.h"
+#include "../include/grid_layout.h"
+#include "../include/session_state.h"
+#include "../include/verse_index.h"
+#include "../include/annotation_store.h"
+#include "../include/arena.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <ncurses.h>
+#include <set>
+#include <sqlite3.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Structure to hold Bible books
+struct Book
+{
+    std::string name;
+    int chapters;
+};
+
+// Verses of the chapter on screen, with their wrap layout and highlight spans.
+// Rebuilt only when the chapter, terminal width or highlight terms change;
+// the vectors keep their capacity, so moving around allocates nothing.
+struct ChapterLayout
+{
+    int book = -1;
+    int chapter = 0;
+    int width = 0;
+    int highlightGeneration = -1;
+    const std::vector<Verse> *verses = nullptr; // Borrowed from the chapter cache for one frame
+    std::vector<int> lineCounts;                // Wrapped lines per verse
+    std::vector<HitSpan> hits;                  // Highlight spans of every verse, in verse order
+    std::vector<size_t> hitStarts;              // First span of each verse, plus an end marker
+};
+
+class BibleViewer
+{
+private:
+    sqlite3 *db;
+    std::string dbPath;
+    StoreBackend storeBackend = StoreBackend::Sqlite;
+    std::unique_ptr<CorpusStore> store; // Where verses are read and searched
+    std::vector<Book> books;
+    VerseIndex verseIndex;      // Absolute verse numbers for jumps and navigation
+    GridLayout bookGrid;        // Shape of the book menu per terminal size
+    ListView bookList;
+    MemoryBudget memoryBudget;   // Shared byte cap over the caches below
+    LruCache<std::pair<int, int>, std::vector<Verse>> chapterCache; // Keyed by (book index, chapter)
+    LruCache<int, std::vector<Verse>> corpusCache; // Whole text, loaded on first regex search
+    int currentBook = 0;
+    int currentChapter = 1;
+    int currentVerse = 1;
+    int screenRows = 0;
+    int screenCols = 0;
+    FoldOptions foldOptions;      // How the database's shadow text was folded
+    std::unique_ptr<Stemmer> stemmer; // Rules the stem index was built with
+    Bm25Ranker ranker;
+    AhoCorasick highlighter;      // Folded terms of the last search
+    RegexSearch highlightPattern; // Pattern of the last /regex/ search, used instead of the terms
+    bool highlightRegex = false;
+    int highlightGeneration = 0;  // Bumped whenever the highlighter changes
+    ChapterLayout layout;
+    bool showRelated = false;            // Related-verses pane under the chapter
+    int relatedFor = -1;                 // Verse id the cached related list belongs to
+    std::vector<Verse> relatedVerses;
+    std::vector<double> relatedScores;
+    TranslationStore translations;
+    AnnotationStore annotations;         // Bookmarks, highlights and notes
+    int parallelCount = 1;               // Translations shown side by side
+    std::vector<std::unique_ptr<MemoryGauge>> gauges; // Memory the budget counts but cannot evict
+    std::string statePath;             // Session state file, empty to disable
+    bool restoreSession = true;
+    std::string startReference;        // Opens here instead of the saved position
+    std::function<void()> firstPaint;  // Told when the first frame is on screen
+    Arena frameArena;                  // Text formatted for the frame being drawn
+    Verse resultVerse;                 // Reused by each row of the search results
+    std::vector<HitSpan> resultHits;
+    std::function<int()> keySource;    // Replaces the keyboard in the main loop when set
+
+    // Initialize ncurses
+    void initNcurses()
+    {
+        initscr();
+        cbreak();
+        noecho();
+        keypad(stdscr, TRUE);
+        start_color();
+        init_pair(1, COLOR_WHITE, COLOR_BLUE);   // Title
+        init_pair(2, COLOR_YELLOW, COLOR_BLACK); // Highlights
+        init_pair(3, COLOR_GREEN, COLOR_BLACK);  // Verse numbers
+        init_pair(4, COLOR_BLACK, COLOR_YELLOW); // Search hits
+        curs_set(0);                             // Hide cursor
+    }
+
+    // Menu label of a book
+    std::string bookLabel(size_t index) const
+    {
+        return books[index].name + " (" + std::to_string(books[index].chapters) + " chapters)";
+    }
+
+    // Load books from the database, along with the verse offset table
+    void loadBooks()
+    {
+        books.clear();
+
+        if (!verseIndex.load(db))
+        {
+            return;
+        }
+
+        for (size_t i = 0; i < verseIndex.bookCount(); i++)
+        {
+            Book book;
+            book.name = verseIndex.bookName(static_cast<int>(i));
+            book.chapters = verseIndex.chapterCount(static_cast<int>(i));
+            books.push_back(book);
+        }
+
+        // Label width plus its left margin
+        bookGrid.measure(books.size(), [this](size_t i)
+                         { return 2 + displayWidth(bookLabel(i)); });
+        bookList.setDrawItem([this](WINDOW *, size_t index, int y, int x, int width, bool selected)
+                             {
+            if (selected)
+                attron(COLOR_PAIR(2));
+            mvprintw(y, x + 2, "%.*s", std::max(0, width - 2), bookLabel(index).c_str());
+            if (selected)
+                attroff(COLOR_PAIR(2)); });
+    }
+
+    // Get verses for a specific chapter
+    std::vector<Verse> getChapterVerses(const std::string &book, int chapter)
+    {
+        return store->chapter(book, chapter);
+    }
+
+    // Ids of verses containing a specific term, ignoring case and accents.
+    // Only ids are collected; the result list reads the verses it shows.
+    std::vector<int> searchVerses(const std::string &term)
+    {
+        return store->search(foldText(term, foldOptions));
+    }
+
+    // Get a single verse by id
+    bool getVerseById(int id, Verse &verse)
+    {
+        return store->verse(id, verse);
+    }
+
+    // Search for verses containing every query word in any inflected form,
+    // using the stem index built at import. Fills forms with the surface
+    // forms found so they can be highlighted.
+    std::vector<int> stemSearchVerses(const std::string &term, std::vector<std::string> &forms)
+    {
+        std::vector<int> ids;
+        bool first = true;
+
+        for (const auto &word : tokenize(foldText(term, foldOptions)))
+        {
+            std::vector<int> postings = lookupStem(db, *stemmer, word);
+
+            // Keep only verses that contain every word
+            if (first)
+            {
+                ids = postings;
+                first = false;
+            }
+            else
+            {
+                std::vector<int> both;
+                std::set_intersection(ids.begin(), ids.end(), postings.begin(), postings.end(), std::back_inserter(both));
+                ids.swap(both);
+            }
+
+            std::vector<std::string> wordForms = stemForms(db, *stemmer, word);
+            forms.insert(forms.end(), wordForms.begin(), wordForms.end());
+        }
+
+        return ids;
+    }
+
+    // Rank verses by BM25 relevance to the query, best first
+    std::vector<int> rankedSearchVerses(const std::string &term, std::vector<std::string> &forms)
+    {
+        std::vector<int> results;
+        std::string folded = foldText(term, foldOptions);
+
+        for (const auto &scored : ranker.search(db, *stemmer, folded, 50))
+        {
+            results.push_back(scored.verseId);
+        }
+
+        for (const auto &word : tokenize(folded))
+        {
+            std::vector<std::string> wordForms = stemForms(db, *stemmer, word);
+            forms.insert(forms.end(), wordForms.begin(), wordForms.end());
+        }
+
+        return results;
+    }
+
+    // Search for verses matching a compiled regular expression across the whole corpus
+    std::vector<int> regexSearchVerses(const RegexSearch &search, std::string &error)
+    {
+        std::vector<int> results;
+
+        std::vector<Verse> *corpus = corpusCache.find(0);
+        if (!corpus)
+        {
+            std::vector<Verse> verses;
+            if (!store->allVerses(verses))
+            {
+                error = "could not load the text";
+                return results;
+            }
+            corpus = &corpusCache.insert(0, std::move(verses));
+        }
+
+        for (size_t index : search.search(*corpus))
+        {
+            results.push_back((*corpus)[index].id);
+        }
+
+        return results;
+    }
+
+    // Replace the highlighted terms with those of a new query
+    void setHighlightTerms(const std::vector<std::string> &terms)
+    {
+        std::vector<std::string> folded;
+        for (const auto &term : terms)
+        {
+            folded.push_back(foldText(term, foldOptions));
+        }
+
+        highlighter.build(folded);
+        highlightRegex = false;
+        highlightGeneration++;
+    }
+
+    // Highlight what a compiled pattern matches; takes ownership of it
+    void setHighlightPattern(RegexSearch &&search)
+    {
+        highlightPattern = std::move(search);
+        highlightRegex = true;
+        highlightGeneration++;
+    }
+
+    // Append the highlighted terms or pattern matches found in a verse's folded text, mapped back to its original text
+    void appendVerseHits(const Verse &verse, std::vector<HitSpan> &hits) const
+    {
+        size_t first = hits.size();
+        if (highlightRegex)
+            highlightPattern.matchSpans(verse.folded, hits);
+        else
+            highlighter.scan(verse.folded, hits);
+
+        for (size_t i = first; i < hits.size(); i++)
+        {
+            mapFoldedRange(verse.foldMap, hits[i].begin, hits[i].end);
+        }
+    }
+
+    // Format text into the frame arena; it stays valid until the next frame starts
+    const char *frameText(const char *format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        int length = std::max(0, vsnprintf(nullptr, 0, format, args));
+        va_end(args);
+
+        char *text = static_cast<char *>(frameArena.allocate(length + 1, 1));
+        va_start(args, format);
+        vsnprintf(text, length + 1, format, args);
+        va_end(args);
+        return text;
+    }
+
+    // Draw text at (y, x), at most length bytes, with search hits highlighted
+    void drawHighlighted(int y, int x, const std::string &text, size_t length, const HitSpan *hits, size_t hitCount)
+    {
+        size_t span = 0;
+        for (size_t i = 0; i < length && i < text.length(); i++)
+        {
+            while (span < hitCount && hits[span].end <= i)
+                span++;
+
+            chtype ch = static_cast<unsigned char>(text[i]);
+            if (span < hitCount && hits[span].begin <= i)
+            {
+                ch |= COLOR_PAIR(4) | A_BOLD;
+            }
+            mvaddch(y, x + static_cast<int>(i), ch);
+        }
+    }
+
+    // Bookmark and note markers left of a verse number
+    void drawAnnotationMarkers(int y, int verseId)
+    {
+        if (annotations.has(AnnotationKind::Bookmark, verseId))
+            mvaddch(y, 0, '*' | COLOR_PAIR(2) | A_BOLD);
+        if (annotations.has(AnnotationKind::Note, verseId))
+            mvaddch(y, 1, '+' | COLOR_PAIR(3));
+    }
+
+    // Make sure the cached layout matches the current chapter and screen
+    void updateChapterLayout()
+    {
+        int width = std::max(1, screenCols - 8);
+
+        // The verses stay in the chapter cache. Look them up every frame, as
+        // the budget may have evicted them since the last one.
+        std::pair<int, int> key(currentBook, currentChapter);
+        const std::vector<Verse> *verses = chapterCache.find(key);
+        if (!verses)
+        {
+            verses = &chapterCache.insert(key, getChapterVerses(books[currentBook].name, currentChapter));
+        }
+
+        bool sameChapter = layout.verses == verses && layout.book == currentBook && layout.chapter == currentChapter;
+        if (sameChapter && layout.width == width && layout.highlightGeneration == highlightGeneration)
+            return;
+
+        layout.book = currentBook;
+        layout.chapter = currentChapter;
+        layout.verses = verses;
+        layout.width = width;
+        layout.highlightGeneration = highlightGeneration;
+
+        layout.lineCounts.clear();
+        layout.hits.clear();
+        layout.hitStarts.clear();
+        for (const auto &verse : *verses)
+        {
+            layout.lineCounts.push_back(std::max<int>(1, (verse.text.length() + width - 1) / width));
+            layout.hitStarts.push_back(layout.hits.size());
+            appendVerseHits(verse, layout.hits);
+        }
+        layout.hitStarts.push_back(layout.hits.size());
+    }
+
+    // Draw the verses most similar to the current one at the bottom of the screen.
+    // Similarity is measured on the base text only; translations are not indexed.
+    // Returns the first row the pane occupies.
+    int displayRelatedPane()
+    {
+        const int paneSize = 5;
+        int top = screenRows - 3 - paneSize - 1;
+
+        const Verse *current = nullptr;
+        for (const auto &verse : *layout.verses)
+        {
+            if (verse.verse == currentVerse)
+                current = &verse;
+        }
+
+        if (current && current->id != relatedFor)
+        {
+            relatedFor = current->id;
+            relatedVerses.clear();
+            relatedScores.clear();
+
+            for (const auto &related : findRelatedVerses(db, current->id, paneSize))
+            {
+                Verse verse;
+                if (getVerseById(related.verseId, verse))
+                {
+                    relatedVerses.push_back(verse);
+                    relatedScores.push_back(related.similarity);
+                }
+            }
+        }
+
+        move(top, 0);
+        clrtobot();
+
+        attron(COLOR_PAIR(1));
+        mvhline(top, 0, ACS_HLINE, screenCols);
+        mvprintw(top, 2, " Related verses (base text) ");
+        attroff(COLOR_PAIR(1));
+
+        if (relatedVerses.empty())
+        {
+            mvprintw(top + 1, 2, "No similar verses found in the base text.");
+        }
+
+        for (size_t i = 0; i < relatedVerses.size(); i++)
+        {
+            const Verse &verse = relatedVerses[i];
+            std::string reference = verse.book + " " + std::to_string(verse.chapter) + ":" + std::to_string(verse.verse);
+
+            attron(COLOR_PAIR(3));
+            mvprintw(top + 1 + i, 2, "%3.0f%% %s", relatedScores[i] * 100, reference.c_str());
+            attroff(COLOR_PAIR(3));
+
+            int x = 4 + 5 + reference.length();
+            if (x < screenCols - 4)
+            {
+                std::string text = verse.text.substr(0, screenCols - x - 1);
+                mvprintw(top + 1 + i, x, "%s", text.c_str());
+            }
+        }
+
+        return top;
+    }
+
+    // Display the current chapter with 2-4 translations in aligned columns
+    void displayParallelChapter()
+    {
+        int columnWidth = (screenCols - 6) / parallelCount;
+
+        attron(COLOR_PAIR(3));
+        for (int c = 0; c < parallelCount; c++)
+        {
+            mvprintw(2, 6 + c * columnWidth, "%s", translations.code(c).c_str());
+        }
+        attroff(COLOR_PAIR(3));
+
+        // Each verse takes as many rows as its longest translation needs
+        const std::vector<Verse> &verses = *layout.verses;
+        int textWidth = std::max(1, columnWidth - 2);
+        std::vector<int> heights;
+        for (const auto &verse : verses)
+        {
+            size_t longest = 1;
+            for (int c = 0; c < parallelCount; c++)
+            {
+                longest = std::max(longest, translations.text(c, verse.id).length());
+            }
+            heights.push_back((longest + textWidth - 1) / textWidth);
+        }
+
+        int scrollOffset = 0;
+        for (size_t i = 0; i < verses.size() && i < static_cast<size_t>(currentVerse - 1); i++)
+        {
+            scrollOffset += heights[i] + 1;
+        }
+        scrollOffset = std::max(0, scrollOffset - screenRows + 10);
+
+        int row = 4;
+        for (size_t v = 0; v < verses.size(); v++)
+        {
+            const Verse &verse = verses[v];
+
+            if (verse.verse == currentVerse)
+                attron(COLOR_PAIR(2));
+
+            for (int line = 0; line < heights[v]; line++)
+            {
+                int y = row + line - scrollOffset;
+                if (y < 3 || y >= screenRows - 2)
+                    continue;
+
+                if (line == 0)
+                {
+                    attron(COLOR_PAIR(3));
+                    mvprintw(y, 2, "%d", verse.verse);
+                    attroff(COLOR_PAIR(3));
+                    drawAnnotationMarkers(y, verse.id);
+                }
+
+                for (int c = 0; c < parallelCount; c++)
+                {
+                    std::string text = translations.text(c, verse.id);
+                    size_t start = static_cast<size_t>(line) * textWidth;
+                    if (start < text.length())
+                    {
+                        mvprintw(y, 6 + c * columnWidth, "%s", text.substr(start, textWidth).c_str());
+                    }
+                }
+            }
+
+            if (verse.verse == currentVerse)
+                attroff(COLOR_PAIR(2));
+
+            row += heights[v] + 1;
+        }
+    }
+
+    // Display the current chapter
+    void displayChapter()
+    {
+        clear();
+        getmaxyx(stdscr, screenRows, screenCols);
+        frameArena.reset();
+
+        // Display title
+        attron(COLOR_PAIR(1));
+        const char *title = frameText("%s Chapter %d", books[currentBook].name.c_str(), currentChapter);
+        mvprintw(0, (screenCols - static_cast<int>(strlen(title))) / 2, "%s", title);
+        mvhline(1, 0, ACS_HLINE, screenCols);
+        attroff(COLOR_PAIR(1));
+
+        // How far through the Bible the current verse is
+        char progress[16];
+        snprintf(progress, sizeof(progress), "%.1f%%", verseIndex.percent(currentPosition()));
+        mvprintw(0, std::max(0, screenCols - static_cast<int>(strlen(progress)) - 1), "%s", progress);
+
+        // Get and display verses
+        updateChapterLayout();
+        const std::vector<Verse> &verses = *layout.verses;
+
+        if (parallelCount > 1)
+        {
+            displayParallelChapter();
+
+            attron(COLOR_PAIR(1));
+            mvhline(screenRows - 2, 0, ACS_HLINE, screenCols);
+            mvprintw(screenRows - 1, 0, "↑/↓: Navigate verses | ←/→: Chapters | g: Go to | b: Book list | s: Search | t: Translations | q: Quit");
+            attroff(COLOR_PAIR(1));
+
+            refresh();
+            return;
+        }
+
+        int row = 3;
+        int scrollOffset = 0;
+
+        // Calculate scroll offset to keep current verse visible
+        if (currentVerse > 1)
+        {
+            for (size_t i = 0; i < verses.size() && i < static_cast<size_t>(currentVerse - 1); i++)
+            {
+                scrollOffset += layout.lineCounts[i] + 1;
+            }
+            scrollOffset = std::max(0, scrollOffset - screenRows + 10);
+        }
+
+        // Display verses with word wrapping
+        for (size_t v = 0; v < verses.size(); v++)
+        {
+            const Verse &verse = verses[v];
+            const std::string &verseText = verse.text;
+            const HitSpan *hits = layout.hits.data() + layout.hitStarts[v];
+            size_t hitCount = layout.hitStarts[v + 1] - layout.hitStarts[v];
+            size_t span = 0;
+            chtype highlight = annotations.has(AnnotationKind::Highlight, verse.id) ? A_UNDERLINE : 0;
+
+            // Highlight the current verse
+            if (verse.verse == currentVerse)
+            {
+                attron(COLOR_PAIR(2));
+            }
+
+            // Display verse number
+            attron(COLOR_PAIR(3));
+            mvprintw(row - scrollOffset, 2, "%d", verse.verse);
+            attroff(COLOR_PAIR(3));
+            drawAnnotationMarkers(row - scrollOffset, verse.id);
+
+            // Word wrap verse text
+            int col = 6;
+            for (size_t i = 0; i < verseText.length(); i++)
+            {
+                if (col >= screenCols - 2)
+                {
+                    row++;
+                    col = 6;
+                }
+
+                if (row - scrollOffset >= 2 && row - scrollOffset < screenRows - 2)
+                {
+                    while (span < hitCount && hits[span].end <= i)
+                        span++;
+
+                    chtype ch = static_cast<unsigned char>(verseText[i]) | highlight;
+                    if (span < hitCount && hits[span].begin <= i)
+                    {
+                        ch |= COLOR_PAIR(4) | A_BOLD;
+                    }
+                    mvaddch(row - scrollOffset, col, ch);
+                }
+                col++;
+            }
+
+            if (verse.verse == currentVerse)
+            {
+                attroff(COLOR_PAIR(2));
+            }
+
+            row += 2;
+        }
+
+        if (showRelated)
+        {
+            displayRelatedPane();
+        }
+
+        // Display navigation help, with the current verse's note on the rule above it
+        attron(COLOR_PAIR(1));
+        mvhline(screenRows - 2, 0, ACS_HLINE, screenCols);
+        const std::string &note = annotations.note(currentVerseId());
+        if (!note.empty())
+        {
+            mvprintw(screenRows - 2, 2, " Note: %.*s ", std::max(0, screenCols - 12), note.c_str());
+        }
+        mvprintw(screenRows - 1, 0, "↑/↓: Navigate verses | ←/→: Chapters | g: Go to | b: Book list | s: Search | c: Clear highlights | r: Related | t: Translations | k/h/n: Bookmark/Highlight/Note | a: Annotations | m: Memory | q: Quit");
+        attroff(COLOR_PAIR(1));
+
+        refresh();
+    }
+
+    // Debug screen listing the bytes each cache holds against the budget
+    void displayMemoryScreen()
+    {
+        clear();
+        getmaxyx(stdscr, screenRows, screenCols);
+
+        attron(COLOR_PAIR(1));
+        std::string title = "Memory Usage";
+        mvprintw(0, (screenCols - title.length()) / 2, "%s", title.c_str());
+        mvhline(1, 0, ACS_HLINE, screenCols);
+        attroff(COLOR_PAIR(1));
+
+        int row = 3;
+        attron(COLOR_PAIR(3));
+        mvprintw(row++, 2, "%-24s %10s %12s", "Subsystem", "Entries", "Bytes");
+        attroff(COLOR_PAIR(3));
+
+        for (const BudgetedCache *cache : memoryBudget.members())
+        {
+            std::string entries = cache->evictable() ? std::to_string(cache->entryCount()) : "pinned";
+            mvprintw(row++, 2, "%-24s %10s %12s", cache->cacheName(), entries.c_str(), formatBytes(cache->bytesUsed()).c_str());
+        }
+
+        size_t limit = memoryBudget.getLimit();
+        row++;
+        mvprintw(row++, 2, "%-24s %10s %12s", "Total", "", formatBytes(memoryBudget.bytesUsed()).c_str());
+        mvprintw(row++, 2, "%-24s %10s %12s", "Budget", "", limit ? formatBytes(limit).c_str() : "unlimited");
+        mvprintw(row++, 2, "%-24s %10zu", "Evictions", memoryBudget.evictionCount());
+
+        attron(COLOR_PAIR(1));
+        mvhline(screenRows - 2, 0, ACS_HLINE, screenCols);
+        mvprintw(screenRows - 1, 0, "Press any key to return");
+        attroff(COLOR_PAIR(1));
+
+        refresh();
+        getch();
+    }
+
+    // Display the book selection menu
+    void displayBookMenu()
+    {
+        clear();
+        getmaxyx(stdscr, screenRows, screenCols);
+
+        attron(COLOR_PAIR(1));
+        std::string title = "Bible Book Selection";
+        mvprintw(0, (screenCols - title.length()) / 2, "%s", title.c_str());
+        mvhline(1, 0, ACS_HLINE, screenCols);
+        attroff(COLOR_PAIR(1));
+
+        // Columns follow the terminal width and the longest book name
+        int gridRows = std::max(1, screenRows - 6);
+        bookList.setArea(stdscr, 3, 0, gridRows, screenCols);
+        bookGrid.apply(bookList, screenCols, gridRows);
+        bookList.select(currentBook);
+        bookList.draw();
+
+        attron(COLOR_PAIR(1));
+        mvhline(screenRows - 2, 0, ACS_HLINE, screenCols);
+        mvprintw(screenRows - 1, 0, "↑/↓/←/→: Navigate | Enter: Select | q: Quit");
+        attroff(COLOR_PAIR(1));
+
+        refresh();
+    }
+
+    // Display search interface
+    void displaySearchInterface()
+    {
+        clear();
+        getmaxyx(stdscr, screenRows, screenCols);
+
+        attron(COLOR_PAIR(1));
+        std::string title = "Bible Search";
+        mvprintw(0, (screenCols - title.length()) / 2, "%s", title.c_str());
+        mvhline(1, 0, ACS_HLINE, screenCols);
+        attroff(COLOR_PAIR(1));
+
+        mvprintw(3, 2, "Enter search term (/regex/ for a pattern, ~word for all its forms, ?words for most relevant): ");
+        echo();
+        curs_set(1);
+
+        char searchTerm[100];
+        getstr(searchTerm);
+
+        noecho();
+        curs_set(0);
+
+        // If search term is empty, return to chapter view
+        if (strlen(searchTerm) == 0)
+        {
+            displayChapter();
+            return;
+        }
+
+        // Search for verses, either as a /regex/ or a plain substring
+        std::vector<int> results;
+        std::string pattern;
+        std::string error;
+
+        if (parseRegexQuery(searchTerm, pattern))
+        {
+            // Compiled once, then used both to search and to highlight the matches
+            RegexSearch search;
+            if (search.compile(pattern, foldOptions, error))
+            {
+                results = regexSearchVerses(search, error);
+                setHighlightPattern(std::move(search));
+            }
+        }
+        else if (searchTerm[0] == '?')
+        {
+            std::vector<std::string> forms;
+            results = rankedSearchVerses(searchTerm + 1, forms);
+            setHighlightTerms(forms);
+        }
+        else if (searchTerm[0] == '~')
+        {
+            std::vector<std::string> forms;
+            results = stemSearchVerses(searchTerm + 1, forms);
+            setHighlightTerms(forms);
+        }
+        else
+        {
+            results = searchVerses(searchTerm);
+            setHighlightTerms(splitQueryTerms(searchTerm));
+        }
+
+        // Only the hits on screen are read from the database, so even
+        // tens of thousands of results page instantly
+        ListView list;
+        list.setItemHeight(3);
+        list.setItemCount(results.size());
+        list.setDrawItem([this, &results](WINDOW *, size_t index, int y, int x, int width, bool selected)
+                         {
+            Verse &verse = resultVerse;
+            if (!getVerseById(results[index], verse))
+                return;
+
+            if (selected)
+                attron(A_REVERSE);
+            attron(COLOR_PAIR(3));
+            mvprintw(y, x + 2, "%s %d:%d", verse.book.c_str(), verse.chapter, verse.verse);
+            attroff(COLOR_PAIR(3));
+            if (selected)
+                attroff(A_REVERSE);
+
+            // Truncate verse text if too long for display
+            size_t length = verse.text.length();
+            if (length > static_cast<size_t>(width - 4))
+            {
+                length = std::max(0, width - 7);
+                mvprintw(y + 1, x + 4 + length, "...");
+            }
+
+            resultHits.clear();
+            appendVerseHits(verse, resultHits);
+            drawHighlighted(y + 1, x + 4, verse.text, length, resultHits.data(), resultHits.size()); });
+
+        while (true)
+        {
+            clear();
+            getmaxyx(stdscr, screenRows, screenCols);
+            frameArena.reset();
+            list.setArea(stdscr, 4, 0, screenRows - 6, screenCols);
+
+            attron(COLOR_PAIR(1));
+            const char *resultTitle = frameText("Search Results for: %s", searchTerm);
+            mvprintw(0, (screenCols - static_cast<int>(strlen(resultTitle))) / 2, "%s", resultTitle);
+            mvhline(1, 0, ACS_HLINE, screenCols);
+            attroff(COLOR_PAIR(1));
+
+            if (!error.empty())
+            {
+                mvprintw(3, 2, "Invalid pattern: %s", error.c_str());
+            }
+            else if (results.empty())
+            {
+                mvprintw(3, 2, "No results found.");
+            }
+            else
+            {
+                mvprintw(2, 2, "Found %zu results (%zu of %zu):", results.size(), list.selection() + 1, results.size());
+                list.draw();
+            }
+
+            attron(COLOR_PAIR(1));
+            mvhline(screenRows - 2, 0, ACS_HLINE, screenCols);
+            mvprintw(screenRows - 1, 0, "↑/↓: Select | PgUp/PgDn/Home/End: Page | Enter: Go to verse | Any other key: Return");
+            attroff(COLOR_PAIR(1));
+
+            refresh();
+
+            int ch = getch();
+
+            if ((ch == '\n' || ch == KEY_ENTER) && !results.empty())
+            {
+                Verse verse;
+                if (getVerseById(results[list.selection()], verse))
+                {
+                    goToVerse(verse);
+                }
+                break;
+            }
+            else if (ch == KEY_RESIZE)
+            {
+                continue;
+            }
+            else if (!list.handleKey(ch))
+            {
+                break;
+            }
+        }
+
+        displayChapter();
+    }
+
+    VersePosition currentPosition() const
+    {
+        VersePosition position;
+        position.book = currentBook;
+        position.chapter = currentChapter;
+        position.verse = currentVerse;
+        return position;
+    }
+
+    void moveTo(const VersePosition &position)
+    {
+        currentBook = position.book;
+        currentChapter = position.chapter;
+        currentVerse = position.verse;
+    }
+
+    // Prompt for a reference such as "Rev 22:3" on the help line and jump to it
+    void promptGoTo()
+    {
+        attron(COLOR_PAIR(1));
+        mvhline(screenRows - 1, 0, ' ', screenCols);
+        mvprintw(screenRows - 1, 0, "Go to: ");
+        echo();
+        curs_set(1);
+
+        char reference[64];
+        getnstr(reference, sizeof(reference) - 1);
+
+        noecho();
+        curs_set(0);
+        attroff(COLOR_PAIR(1));
+
+        VersePosition position;
+        if (verseIndex.parseReference(reference, position))
+        {
+            moveTo(position);
+            displayChapter();
+        }
+        else if (strlen(reference) > 0)
+        {
+            displayChapter();
+            attron(COLOR_PAIR(1));
+            mvhline(screenRows - 1, 0, ' ', screenCols);
+            mvprintw(screenRows - 1, 0, "Unknown reference: %s (e.g. John 3:16, Ps 119:105) - press any key", reference);
+            attroff(COLOR_PAIR(1));
+            refresh();
+            getch();
+            displayChapter();
+        }
+        else
+        {
+            displayChapter();
+        }
+    }
+
+    // Id of the verse under the cursor, or -1 if the chapter lacks it
+    int currentVerseId()
+    {
+        updateChapterLayout();
+        for (const auto &verse : *layout.verses)
+        {
+            if (verse.verse == currentVerse)
+                return verse.id;
+        }
+        return -1;
+    }
+
+    // Ask for a note on the current verse; an empty note removes it
+    void promptNote()
+    {
+        int verseId = currentVerseId();
+        if (verseId < 0)
+            return;
+
+        attron(COLOR_PAIR(1));
+        mvhline(screenRows - 1, 0, ' ', screenCols);
+        mvprintw(screenRows - 1, 0, annotations.note(verseId).empty() ? "Note: " : "Note (empty to remove): ");
+        echo();
+        curs_set(1);
+
+        char text[256];
+        getnstr(text, sizeof(text) - 1);
+
+        noecho();
+        curs_set(0);
+        attroff(COLOR_PAIR(1));
+
+        if (strlen(text) > 0 || !annotations.note(verseId).empty())
+        {
+            annotations.setNote(verseId, text);
+        }
+        displayChapter();
+    }
+
+    // List every annotated verse; Enter jumps to the selected one
+    void displayAnnotationList()
+    {
+        std::vector<int> ids = annotations.annotatedVerses();
+
+        ListView list;
+        list.setItemHeight(3);
+        list.setItemCount(ids.size());
+        list.setDrawItem([this, &ids](WINDOW *, size_t index, int y, int x, int width, bool selected)
+                         {
+            Verse &verse = resultVerse;
+            if (!getVerseById(ids[index], verse))
+                return;
+
+            if (selected)
+                attron(A_REVERSE);
+            attron(COLOR_PAIR(3));
+            mvprintw(y, x + 2, "%c%c%c %s %d:%d",
+                     annotations.has(AnnotationKind::Bookmark, verse.id) ? '*' : ' ',
+                     annotations.has(AnnotationKind::Highlight, verse.id) ? '_' : ' ',
+                     annotations.has(AnnotationKind::Note, verse.id) ? '+' : ' ',
+                     verse.book.c_str(), verse.chapter, verse.verse);
+            attroff(COLOR_PAIR(3));
+            if (selected)
+                attroff(A_REVERSE);
+
+            // The note when there is one, otherwise the verse
+            const std::string &note = annotations.note(verse.id);
+            mvprintw(y + 1, x + 8, "%.*s", std::max(0, width - 8), (note.empty() ? verse.text : note).c_str()); });
+
+        while (true)
+        {
+            clear();
+            getmaxyx(stdscr, screenRows, screenCols);
+            list.setArea(stdscr, 4, 0, screenRows - 6, screenCols);
+
+            attron(COLOR_PAIR(1));
+            const char *title = "Annotations";
+            mvprintw(0, (screenCols - static_cast<int>(strlen(title))) / 2, "%s", title);
+            mvhline(1, 0, ACS_HLINE, screenCols);
+            attroff(COLOR_PAIR(1));
+
+            if (ids.empty())
+            {
+                mvprintw(3, 2, "No bookmarks, highlights or notes yet.");
+            }
+            else
+            {
+                mvprintw(2, 2, "%zu bookmarks, %zu highlights, %zu notes (%zu of %zu):", annotations.count(AnnotationKind::Bookmark),
+                         annotations.count(AnnotationKind::Highlight), annotations.count(AnnotationKind::Note),
+                         list.selection() + 1, ids.size());
+                list.draw();
+            }
+
+            attron(COLOR_PAIR(1));
+            mvhline(screenRows - 2, 0, ACS_HLINE, screenCols);
+            mvprintw(screenRows - 1, 0, "↑/↓: Select | PgUp/PgDn/Home/End: Page | Enter: Go to verse | Any other key: Return");
+            attroff(COLOR_PAIR(1));
+
+            refresh();
+
+            int ch = getch();
+
+            if ((ch == '\n' || ch == KEY_ENTER) && !ids.empty())
+            {
+                Verse verse;
+                if (getVerseById(ids[list.selection()], verse))
+                {
+                    goToVerse(verse);
+                }
+                break;
+            }
+            else if (ch == KEY_RESIZE)
+            {
+                continue;
+            }
+            else if (!list.handleKey(ch))
+            {
+                break;
+            }
+        }
+
+        displayChapter();
+    }
+
+    // Move the view to a verse, e.g. one picked from the search results
+    void goToVerse(const Verse &verse)
+    {
+        for (size_t i = 0; i < books.size(); i++)
+        {
+            if (books[i].name == verse.book)
+            {
+                currentBook = static_cast<int>(i);
+                currentChapter = verse.chapter;
+                currentVerse = verse.verse;
+                return;
+            }
+        }
+    }
+
+public:
+    // Rebuild costs are rough microseconds: a chapter query versus reloading the whole text
+    BibleViewer() : db(nullptr), chapterCache("chapters", 500.0, verseVectorBytes),
+                    corpusCache("regex corpus", 1500000.0, verseVectorBytes, 1)
+    {
+        chapterCache.attach(&memoryBudget);
+        corpusCache.attach(&memoryBudget);
+        translations.attach(&memoryBudget);
+
+        gauges.emplace_back(new MemoryGauge("chapter layout", [this]()
+                                            {
+            return layout.lineCounts.capacity() * sizeof(int) + layout.hits.capacity() * sizeof(HitSpan) +
+                   layout.hitStarts.capacity() * sizeof(size_t) + frameArena.bytesReserved() +
+                   verseBytes(resultVerse) + resultHits.capacity() * sizeof(HitSpan); }));
+        gauges.emplace_back(new MemoryGauge("related verses", [this]()
+                                            { return verseVectorBytes(relatedVerses) + relatedScores.capacity() * sizeof(double); }));
+        gauges.emplace_back(new MemoryGauge("ranking index", [this]()
+                                            { return ranker.memoryBytes(); }));
+        gauges.emplace_back(new MemoryGauge("book list", [this]()
+                                            {
+            size_t total = books.capacity() * sizeof(Book);
+            for (const auto &book : books)
+                total += heapBytes(book.name);
+            return total; }));
+        gauges.emplace_back(new MemoryGauge("verse index", [this]()
+                                            { return verseIndex.memoryBytes(); }));
+        gauges.emplace_back(new MemoryGauge("annotations", [this]()
+                                            { return annotations.memoryBytes(); }));
+        gauges.emplace_back(new MemoryGauge("corpus store", [this]()
+                                            { return store ? store->memoryBytes() : 0; }));
+
+        for (const auto &gauge : gauges)
+        {
+            memoryBudget.attach(gauge.get());
+        }
+    }
+
+    // Cap the bytes held by the caches; zero leaves them unbounded
+    void setMemoryBudget(size_t bytes)
+    {
+        memoryBudget.setLimit(bytes);
+    }
+
+    ~BibleViewer()
+    {
+        store.reset(); // Finalizes its statements before the connection closes
+        if (db)
+        {
+            sqlite3_close(db);
+        }
+        endwin(); // Clean up ncurses
+    }
+
+    // Initialize the database
+    bool initDatabase(const std::string &path)
+    {
+        dbPath = path;
+        if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK)
+        {
+            std::cerr << "Error opening database: " << sqlite3_errmsg(db) << std::endl;
+            return false;
+        }
+
+        // Wait out an import's brief checkpoint locks instead of failing
+        sqlite3_busy_timeout(db, 2000);
+
+        // Check if the database has the required table
+        sqlite3_stmt *stmt;
+        const char *checkTableSQL = "SELECT name FROM sqlite_master WHERE type='table' AND name='bible'";
+
+        if (sqlite3_prepare_v2(db, checkTableSQL, -1, &stmt, nullptr) != SQLITE_OK)
+        {
+            std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
+            return false;
+        }
+
+        bool tableExists = (sqlite3_step(stmt) == SQLITE_ROW);
+        sqlite3_finalize(stmt);
+
+        if (!tableExists)
+        {
+            std::cerr << "Database does not have a 'bible' table. Please use a properly formatted database." << std::endl;
+            return false;
+        }
+
+        statePath = sessionStatePath(dbPath);
+        return true;
+    }
+
+    // Options for the view command
+    void setRestoreSession(bool enabled) { restoreSession = enabled; }
+    void setStartReference(const std::string &reference) { startReference = reference; }
+
+    void setKeySource(const std::function<int()> &source) { keySource = source; }
+    void setStoreBackend(StoreBackend backend) { storeBackend = backend; }
+    void setFirstPaintHandler(const std::function<void()> &handler) { firstPaint = handler; }
+
+private:
+    // Everything the viewer needs beyond the first frame. Runs on a background
+    // thread while a saved frame is on screen, so it must not touch curses.
+    bool loadDatabase()
+    {
+        // Older databases lack the folded shadow text searches rely on
+        if (!ensureSchema(db))
+        {
+            return false;
+        }
+        foldOptions = loadFoldOptions(db);
+
+        store = openCorpusStore(storeBackend, db, dbPath);
+        if (!store)
+        {
+            std::cerr << "Could not open the corpus store." << std::endl;
+            return false;
+        }
+
+        stemmer = loadStemmer(db);
+        if (!stemmer)
+        {
+            std::cerr << "Database uses an unknown stemmer: " << getMeta(db, "stemmer") << std::endl;
+            return false;
+        }
+
+        if (!ranker.load(db) || !translations.open(db) || !annotations.open(db, dbPath))
+        {
+            return false;
+        }
+
+        loadBooks();
+
+        if (books.empty())
+        {
+            std::cerr << "No books found in the database." << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    // Next key for the main loop
+    int readKey()
+    {
+        return keySource ? keySource() : getch();
+    }
+
+    void notifyFirstPaint()
+    {
+        if (firstPaint)
+            firstPaint();
+    }
+
+    // Resume where the last session left off, once the books are known
+    void applySessionState(const SessionState &state)
+    {
+        for (size_t i = 0; i < books.size(); i++)
+        {
+            if (books[i].name == state.book)
+            {
+                currentBook = static_cast<int>(i);
+                currentChapter = std::max(1, std::min(state.chapter, books[i].chapters));
+                currentVerse = std::max(1, std::min(state.verse, verseIndex.verseCount(currentBook, currentChapter)));
+                break;
+            }
+        }
+
+        showRelated = state.showRelated;
+        parallelCount = std::max(1, std::min<int>(state.parallelCount, std::min<int>(4, translations.count())));
+        for (int c = 0; parallelCount > 1 && c < parallelCount; c++)
+        {
+            translations.load(c);
+        }
+    }
+
+    // Save the position and the chapter frame for the next start
+    void saveSession()
+    {
+        if (statePath.empty() || books.empty())
+            return;
+
+        displayChapter();
+
+        SessionState state;
+        state.book = books[currentBook].name;
+        state.chapter = currentChapter;
+        state.verse = currentVerse;
+        state.parallelCount = parallelCount;
+        state.showRelated = showRelated;
+        state.rows = screenRows;
+        state.cols = screenCols;
+        saveSessionState(statePath, state, stdscr);
+    }
+
+public:
+    // Run the main interface
+    void run()
+    {
+        if (!db)
+        {
+            std::cerr << "Database not initialized correctly." << std::endl;
+            return;
+        }
+
+        initNcurses();
+
+        SessionState state;
+        WINDOW *frame = nullptr;
+        bool restored = restoreSession && !statePath.empty() && loadSessionState(statePath, state, &frame);
+
+        // Paint the frame saved at the last exit straight away and open the
+        // database behind it; without one (or after a resize, or when asked
+        // to open somewhere else) load first
+        bool painted = false;
+        if (frame && state.rows == LINES && state.cols == COLS && startReference.empty())
+        {
+            touchwin(frame);
+            wrefresh(frame);
+            notifyFirstPaint();
+            painted = true;
+        }
+        if (frame)
+        {
+            delwin(frame);
+        }
+
+        bool loaded = false;
+        int pending = ERR;
+        if (painted)
+        {
+            std::atomic<bool> done(false);
+            std::thread loader([this, &loaded, &done]()
+                               {
+                loaded = loadDatabase();
+                done = true; });
+
+            // Keep the saved frame up until the database is ready or a key arrives
+            timeout(5);
+            while (!done && (pending = getch()) == ERR)
+            {
+                napms(1); // getch returns at once when input is closed
+            }
+            timeout(-1);
+            loader.join();
+        }
+        else
+        {
+            loaded = loadDatabase();
+        }
+
+        if (!loaded)
+        {
+            endwin();
+            std::cerr << "Database not initialized correctly." << std::endl;
+            return;
+        }
+
+        if (restored)
+        {
+            applySessionState(state);
+        }
+
+        VersePosition start;
+        if (!startReference.empty() && verseIndex.parseReference(startReference, start))
+        {
+            moveTo(start);
+        }
+
+        displayChapter();
+        if (!painted)
+        {
+            notifyFirstPaint();
+        }
+
+        bool quitRequested = false;
+
+        while (!quitRequested)
+        {
+            int ch = pending != ERR ? pending : readKey();
+            pending = ERR;
+
+            switch (ch)
+            {
+            case 'q':
+            case 'Q':
+                quitRequested = true;
+                break;
+
+            // Verse and chapter steps carry on into the next chapter or book
+            case KEY_UP:
+            case KEY_DOWN:
+            {
+                int index = verseIndex.absolute(currentPosition()) + (ch == KEY_DOWN ? 1 : -1);
+                if (index >= 0 && index < verseIndex.totalVerses())
+                {
+                    moveTo(verseIndex.position(index));
+                    displayChapter();
+                }
+                break;
+            }
+
+            case KEY_LEFT:
+            case KEY_RIGHT:
+            {
+                VersePosition next;
+                if (verseIndex.adjacentChapter(currentPosition(), ch == KEY_RIGHT ? 1 : -1, next))
+                {
+                    moveTo(next);
+                    displayChapter();
+                }
+                break;
+            }
+
+            case 'g':
+            case 'G':
+                promptGoTo();
+                break;
+
+            case 'b':
+            case 'B':
+            {
+                bool bookMenuActive = true;
+                displayBookMenu();
+
+                while (bookMenuActive)
+                {
+                    int bookCh = getch();
+
+                    switch (bookCh)
+                    {
+                    case 'q':
+                    case 'Q':
+                        bookMenuActive = false;
+                        quitRequested = true;
+                        break;
+
+                    case KEY_RESIZE:
+                        displayBookMenu();
+                        break;
+
+                    case '\n':
+                    case KEY_ENTER:
+                        bookMenuActive = false;
+                        currentChapter = 1;
+                        currentVerse = 1;
+                        displayChapter();
+                        break;
+
+                    default:
+                        // Arrows and paging move through the book grid
+                        if (bookList.handleKey(bookCh))
+                        {
+                            currentBook = static_cast<int>(bookList.selection());
+                            displayBookMenu();
+                        }
+                        break;
+                    }
+                }
+                break;
+            }
+
+            case KEY_RESIZE:
+                displayChapter();
+                break;
+
+            case 's':
+            case 'S':
+                displaySearchInterface();
+                break;
+
+            case 'c':
+            case 'C':
+                setHighlightTerms({});
+                displayChapter();
+                break;
+
+            case 'r':
+            case 'R':
+                showRelated = !showRelated;
+                displayChapter();
+                break;
+
+            case 't':
+            case 'T':
+            {
+                // Cycle through 1-4 side-by-side translations
+                int available = std::min<int>(4, translations.count());
+                parallelCount = parallelCount % available + 1;
+                for (int c = 0; c < parallelCount; c++)
+                {
+                    translations.load(c);
+                }
+                displayChapter();
+                break;
+            }
+
+            case 'm':
+            case 'M':
+                displayMemoryScreen();
+                displayChapter();
+                break;
+
+            case 'k':
+            case 'K':
+            case 'h':
+            case 'H':
+            {
+                int verseId = currentVerseId();
+                if (verseId >= 0)
+                {
+                    annotations.toggle(tolower(ch) == 'k' ? AnnotationKind::Bookmark : AnnotationKind::Highlight, verseId);
+                    displayChapter();
+                }
+                break;
+            }
+
+            case 'n':
+            case 'N':
+                promptNote();
+                break;
+
+            case 'a':
+            case 'A':
+                displayAnnotationList();
+                break;
+            }
+
+            memoryBudget.enforce();
+        }
+
+        saveSession();
+    }
+};
+
+bool runViewer(const std::string &dbPath, const ViewerOptions &options)
+{
+    BibleViewer viewer;
+    viewer.setMemoryBudget(options.memoryBudget);
+    viewer.setStoreBackend(options.storeBackend);
+    viewer.setRestoreSession(options.restoreSession);
+    viewer.setStartReference(options.startReference);
+    viewer.setFirstPaintHandler(options.firstPaint);
+    viewer.setKeySource(options.keySource);
+
+    bool opened = viewer.initDatabase(dbPath);
+    if (opened)
+    {
+        viewer.run();
+    }
+
+    return opened;
+}
@@ -0,0 +1,50 @@
+#include "../include/command_options.h"
+#include "test_check.h"
+#include <string>
+#include <vector>
+
+// Parse a command line given as words, after the command's fixed arguments
+static bool parseWords(CommandOptions &parser, std::vector<std::string> words)
+{
+    std::vector<char *> argv;
+    for (std::string &word : words)
+        argv.push_back(&word[0]);
+    return parser.parse(static_cast<int>(argv.size()), argv.data(), 0);
+}
+
+int main()
+{
+    std::string format = "csv";
+    bool open = false;
+    CommandOptions parser;
+    parser.value("--format", [&](const std::string &value)
+                 { format = value; return value == "csv" || value == "json"; });
+    parser.flag("--open", [&]
+                { open = true; });
+
+    CHECK(parseWords(parser, {"--format", "json", "--open"}));
+    CHECK_EQUAL(format, std::string("json"));
+    CHECK(open);
+
+    // Unknown options, missing or rejected values and stray arguments all fail
+    CHECK(!parseWords(parser, {"--fromat", "json"}));
+    CHECK(!parseWords(parser, {"--format"}));
+    CHECK(!parseWords(parser, {"--format", "--open"}));
+    CHECK(!parseWords(parser, {"--format", "xml"}));
+    CHECK(!parseWords(parser, {"extra"}));
+
+    CommandOptions positional;
+    positional.acceptPositional();
+    CHECK(parseWords(positional, {"kjv.csv", "web=web.csv"}));
+    CHECK_EQUAL(positional.arguments().size(), size_t(2));
+    CHECK(!parseWords(positional, {"--jobs", "4"}));
+
+    size_t count = 0;
+    CHECK(parseCount("42", count));
+    CHECK_EQUAL(count, size_t(42));
+    CHECK(!parseCount("4x", count));
+    CHECK(!parseCount("-1", count));
+    CHECK(!parseCount("", count));
+
+    return checkFailures;
+}
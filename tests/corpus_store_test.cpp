@@ -0,0 +1,162 @@
+#include "../include/corpus_store.h"
+#include "../include/import_commands.h"
+#include "../include/text_fold.h"
+#include "test_check.h"
+#include <sqlite3.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+static bool sameVerse(const Verse &a, const Verse &b)
+{
+    return a.id == b.id && a.book == b.book && a.chapter == b.chapter && a.verse == b.verse &&
+           a.text == b.text && a.folded == b.folded && encodeFoldMap(a.foldMap) == encodeFoldMap(b.foldMap);
+}
+
+static bool sameVerses(const std::vector<Verse> &a, const std::vector<Verse> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++)
+        if (!sameVerse(a[i], b[i]))
+            return false;
+    return true;
+}
+
+// Every query of the interface must answer as the SQLite backend does
+static void checkSameAnswers(CorpusStore &expected, CorpusStore &actual, int maxId, const std::vector<std::string> &terms)
+{
+    std::vector<std::string> books = expected.books();
+    CHECK(actual.books() == books);
+
+    for (const auto &book : books)
+    {
+        int chapters = expected.chapterCount(book);
+        CHECK_EQUAL(actual.chapterCount(book), chapters);
+        for (int chapter = 0; chapter <= chapters + 1; chapter++)
+            CHECK(sameVerses(actual.chapter(book, chapter), expected.chapter(book, chapter)));
+    }
+    CHECK_EQUAL(actual.chapterCount("Revelation"), expected.chapterCount("Revelation"));
+
+    // Ids on either side of the table's range must miss on every backend
+    for (int id = -1; id <= maxId + 1; id++)
+    {
+        Verse a, b;
+        bool found = expected.verse(id, a);
+        CHECK_EQUAL(actual.verse(id, b), found);
+        CHECK(!found || sameVerse(a, b));
+    }
+
+    std::vector<Verse> all, actualAll;
+    CHECK(expected.allVerses(all));
+    CHECK(actual.allVerses(actualAll));
+    CHECK_EQUAL(all.size(), size_t(maxId));
+    CHECK(sameVerses(actualAll, all));
+
+    for (const auto &term : terms)
+        CHECK(actual.search(term) == expected.search(term));
+}
+
+static void overwrite(const std::string &path, std::streamoff offset, const void *bytes, size_t length)
+{
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offset);
+    file.write(static_cast<const char *>(bytes), length);
+}
+
+int main()
+{
+    char directory[] = "/tmp/corpus_store_XXXXXX";
+    if (!mkdtemp(directory))
+        return 1;
+    std::string dbPath = std::string(directory) + "/bible.db";
+    std::string csvPath = std::string(directory) + "/bible.csv";
+
+    // Accented and multi-byte text, so fold maps differ from the identity
+    {
+        std::ofstream csv(csvPath);
+        csv << "\"book\", \"chapter\", \"verse\", \"text\"\n";
+        for (const char *book : {"Genesis", "Exodus", "Psalms"})
+            for (int chapter = 1; chapter <= 3; chapter++)
+                for (int verse = 1; verse <= 5; verse++)
+                    csv << "\"" << book << "\", " << chapter << ", " << verse << ", \"In the beginning the ÉGLISE of "
+                        << book << " sang Straße " << verse << " ﬁnally, " << chapter << ".\"\n";
+    }
+
+    CHECK(createDatabase(dbPath, FoldOptions(), "archaic-english"));
+    CHECK(importBibleFromCSV(dbPath, csvPath));
+
+    sqlite3 *db;
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK)
+        return 1;
+
+    const int maxId = 3 * 3 * 5;
+    std::vector<std::string> terms;
+    for (const char *term : {"the", "église", "STRASSE", "fin", "exodus sang", "qqq", "e", "", "5 finally, 3."})
+        terms.push_back(foldText(term, FoldOptions()));
+
+    SqliteCorpusStore reference(db);
+
+    ArenaCorpusStore arena;
+    CHECK(arena.load(db));
+    checkSameAnswers(reference, arena, maxId, terms);
+
+    std::string corpusPath = corpusFilePath(dbPath);
+    CHECK(writeCorpusFile(db, corpusPath));
+    {
+        MappedCorpusStore mapped;
+        CHECK(mapped.open(corpusPath));
+        checkSameAnswers(reference, mapped, maxId, terms);
+    }
+
+    // A record whose text runs past the string pool
+    {
+        std::ifstream file(corpusPath, std::ios::binary);
+        uint64_t recordsOffset = 0;
+        file.seekg(24); // magic, two counts, then the books and records offsets
+        file.read(reinterpret_cast<char *>(&recordsOffset), sizeof(recordsOffset));
+        file.close();
+
+        uint32_t textLength = 0xffffff00;
+        overwrite(corpusPath, recordsOffset + sizeof(FlatVerse) + offsetof(FlatVerse, textLength), &textLength, sizeof(textLength));
+        MappedCorpusStore damaged;
+        CHECK(!damaged.open(corpusPath));
+    }
+
+    std::unique_ptr<CorpusStore> rebuilt = openCorpusStore(StoreBackend::Mapped, db, dbPath);
+    CHECK(rebuilt != nullptr);
+    if (rebuilt)
+        checkSameAnswers(reference, *rebuilt, maxId, terms);
+    rebuilt.reset();
+
+    // A file cut off inside the records, then one too short for its header
+    for (uintmax_t size : {std::filesystem::file_size(corpusPath) / 2, uintmax_t(12)})
+    {
+        std::filesystem::resize_file(corpusPath, size);
+        MappedCorpusStore truncated;
+        CHECK(!truncated.open(corpusPath));
+
+        rebuilt = openCorpusStore(StoreBackend::Mapped, db, dbPath);
+        CHECK(rebuilt != nullptr);
+        if (rebuilt)
+            checkSameAnswers(reference, *rebuilt, maxId, terms);
+        rebuilt.reset();
+    }
+
+    // From another format altogether
+    overwrite(corpusPath, 0, "NOTCORPS", 8);
+    MappedCorpusStore foreign;
+    CHECK(!foreign.open(corpusPath));
+    rebuilt = openCorpusStore(StoreBackend::Mapped, db, dbPath);
+    CHECK(rebuilt != nullptr);
+    rebuilt.reset();
+
+    sqlite3_close(db);
+    std::filesystem::remove_all(directory);
+    return checkFailures;
+}
@@ -0,0 +1,138 @@
+#include "../include/csv_reader.h"
+#include "test_check.h"
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef std::vector<std::vector<std::string>> Records;
+
+// Quote a CSV field the way the exporter does
+static std::string quoteCsvField(const std::string &text)
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        quoted += c;
+        if (c == '"')
+            quoted += '"';
+    }
+    return quoted + "\"";
+}
+
+// Read every record of an in-memory CSV with a reader of the given buffer
+// size. The reader must consume exactly the input and never produce a field
+// longer than it.
+static bool readCsvFully(const std::string &input, size_t bufferBytes, Records *records)
+{
+    FILE *stream = fmemopen(const_cast<char *>(input.data()), input.size(), "rb");
+    if (!stream)
+        return input.empty();
+
+    CsvReader csv(bufferBytes);
+    csv.attach(stream);
+
+    bool sane = true;
+    while (csv.next())
+    {
+        std::vector<std::string> record;
+        for (size_t i = 0; i < csv.fieldCount(); i++)
+        {
+            sane = sane && csv.field(i).size() <= input.size();
+            if (records)
+                record.push_back(csv.field(i));
+        }
+        if (records)
+            records->push_back(std::move(record));
+    }
+
+    sane = sane && csv.bytesRead() == input.size();
+    csv.close();
+    fclose(stream);
+    return sane;
+}
+
+static Records parse(const std::string &input)
+{
+    Records records;
+    CHECK(readCsvFully(input, 16, &records));
+    return records;
+}
+
+int main()
+{
+    // Fixed seed so a failure can be reproduced
+    std::mt19937 random(20240611);
+
+    // Padding, quoting and the end of the file
+    CHECK(parse("a, b ,c\n") == (Records{{"a", "b", "c"}}));
+    CHECK(parse("\"say \"\"yea\"\"\", \"one, two\"\r\n\"line\nbreak\"") == (Records{{"say \"yea\"", "one, two"}, {"line\nbreak"}}));
+    CHECK(parse("\"Genesis\", 1, 1, \"unterminated") == (Records{{"Genesis", "1", "1", "unterminated"}}));
+    CHECK(parse("").empty());
+
+    CsvReader numbers;
+    FILE *stream = fmemopen(const_cast<char *>("12, x1, -3, 99999999999\n"), 24, "rb");
+    numbers.attach(stream);
+    int value = 0;
+    CHECK(numbers.next());
+    CHECK(numbers.integer(0, value) && value == 12);
+    CHECK(!numbers.integer(1, value));
+    CHECK(numbers.integer(2, value) && value == -3);
+    CHECK(!numbers.integer(3, value));
+    numbers.close();
+    fclose(stream);
+
+    // Generated records with quotes, separators, line breaks and UTF-8 in
+    // every field must come back exactly, whatever the buffer size
+    const char alphabet[] = "ab ,\"\"\n\r\t;'xyz\xC3\xA9\xE2\x80\x94 0123456789";
+    std::string csv;
+    Records expected;
+    for (int r = 0; r < 20000; r++)
+    {
+        std::vector<std::string> fields(1 + random() % 6);
+        for (size_t f = 0; f < fields.size(); f++)
+        {
+            for (size_t length = random() % 40; length > 0; length--)
+                fields[f] += alphabet[random() % (sizeof(alphabet) - 1)];
+            csv += (f ? "," : "") + std::string(random() % 3, ' ') + quoteCsvField(fields[f]) + std::string(random() % 2, ' ');
+        }
+        csv += random() % 4 ? "\n" : "\r\n";
+        expected.push_back(fields);
+    }
+
+    for (size_t bufferBytes : {size_t(7), size_t(64), size_t(4096), size_t(1) << 20})
+    {
+        Records parsed;
+        CHECK(readCsvFully(csv, bufferBytes, &parsed));
+        CHECK_EQUAL(parsed.size(), expected.size());
+        CHECK(parsed == expected);
+    }
+
+    // Damaged copies of an import file: flipped bytes, stray quotes and
+    // separators, cut-off ends. Parsing must stay within the input and end.
+    std::string sample = "\"book\", \"chapter\", \"verse\", \"text\"\n";
+    for (int chapter = 1; sample.size() < 64 * 1024; chapter++)
+        for (int verse = 1; verse <= 30; verse++)
+            sample += "\"Genesis\", " + std::to_string(chapter) + ", " + std::to_string(verse) +
+                      ", \"And God said, \"\"Let there be light\"\": and there was light.\"\n";
+
+    const char damage[] = {'"', ',', '\n', '\r', ' ', '\0', '\xFF', '\xC3'};
+    size_t failures = 0;
+    for (int c = 0; c < 2000; c++)
+    {
+        std::string damaged = sample;
+        for (int edits = 1 + random() % 16; edits > 0 && !damaged.empty(); edits--)
+        {
+            size_t at = random() % damaged.size();
+            damaged[at] = random() % 2 ? damage[random() % sizeof(damage)] : static_cast<char>(random());
+        }
+        if (!damaged.empty() && random() % 2)
+            damaged.resize(random() % damaged.size());
+
+        if (!readCsvFully(damaged, 1 + random() % 512, nullptr))
+            failures++;
+    }
+    CHECK_EQUAL(failures, size_t(0));
+
+    return checkFailures;
+}
@@ -0,0 +1,92 @@
+#include "../include/import_commands.h"
+#include "test_check.h"
+#include <sqlite3.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Write a base text CSV of Genesis 1-2 with the given verses of chapter 2
+static void writeCsv(const std::string &path, int lastVerse, const std::string &extra = "")
+{
+    std::ofstream csv(path);
+    csv << "\"book\", \"chapter\", \"verse\", \"text\"\n";
+    for (int verse = 1; verse <= 3; verse++)
+        csv << "\"Genesis\", 1, " << verse << ", \"In the beginning " << verse << ".\"\n";
+    for (int verse = 1; verse <= lastVerse; verse++)
+        csv << "\"Genesis\", 2, " << verse << ", \"Thus the heavens " << verse << ".\"\n";
+    csv << extra;
+}
+
+static int queryInt(const std::string &dbPath, const char *sql)
+{
+    sqlite3 *db;
+    int value = -1;
+    sqlite3_stmt *stmt;
+    if (sqlite3_open(dbPath.c_str(), &db) == SQLITE_OK && sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK)
+    {
+        if (sqlite3_step(stmt) == SQLITE_ROW)
+            value = sqlite3_column_int(stmt, 0);
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+    return value;
+}
+
+static bool execute(const std::string &dbPath, const char *sql)
+{
+    sqlite3 *db;
+    bool ok = sqlite3_open(dbPath.c_str(), &db) == SQLITE_OK && sqlite3_exec(db, sql, nullptr, nullptr, nullptr) == SQLITE_OK;
+    sqlite3_close(db);
+    return ok;
+}
+
+int main()
+{
+    char directory[] = "/tmp/import_commands_XXXXXX";
+    if (!mkdtemp(directory))
+        return 1;
+    std::string dbPath = std::string(directory) + "/bible.db";
+    std::string csvPath = std::string(directory) + "/bible.csv";
+
+    CHECK(createDatabase(dbPath, FoldOptions(), "archaic-english"));
+    writeCsv(csvPath, 3);
+    CHECK(importBibleFromCSV(dbPath, csvPath));
+    CHECK_EQUAL(queryInt(dbPath, "SELECT COUNT(*) FROM bible"), 6);
+
+    // Genesis 2:3 (id 6) carries a bookmark and a note, Genesis 1:1 a highlight
+    CHECK(execute(dbPath, "INSERT INTO annotations (verse_id, kind, note) VALUES (6, 0, NULL), (6, 2, 'seventh day'), (1, 1, NULL)"));
+
+    // A verse the delete refuses fails the import and leaves verse and annotations in place
+    CHECK(execute(dbPath, "CREATE TRIGGER keep_verses BEFORE DELETE ON bible BEGIN SELECT RAISE(ABORT, 'kept'); END"));
+    writeCsv(csvPath, 2);
+    CHECK(!importBibleFromCSV(dbPath, csvPath));
+    CHECK_EQUAL(queryInt(dbPath, "SELECT COUNT(*) FROM bible"), 6);
+    CHECK_EQUAL(queryInt(dbPath, "SELECT COUNT(*) FROM annotations WHERE verse_id = 6"), 2);
+    CHECK(execute(dbPath, "DROP TRIGGER keep_verses"));
+
+    // Dropping the verse drops its annotations and nobody else's
+    CHECK(importBibleFromCSV(dbPath, csvPath));
+    CHECK_EQUAL(queryInt(dbPath, "SELECT COUNT(*) FROM bible"), 5);
+    CHECK_EQUAL(queryInt(dbPath, "SELECT COUNT(*) FROM annotations WHERE verse_id = 6"), 0);
+    CHECK_EQUAL(queryInt(dbPath, "SELECT COUNT(*) FROM annotations WHERE verse_id = 1"), 1);
+
+    // A verse the insert refuses rolls back the whole import, earlier chapters included
+    CHECK(execute(dbPath, "CREATE TRIGGER refuse_verses BEFORE INSERT ON bible WHEN NEW.text LIKE '%refused%' "
+                          "BEGIN SELECT RAISE(ABORT, 'refused'); END"));
+    writeCsv(csvPath, 2,
+             "\"Genesis\", 3, 1, \"Now the serpent.\"\n"
+             "\"Genesis\", 4, 1, \"And Adam knew Eve.\"\n"
+             "\"Genesis\", 4, 2, \"A refused verse.\"\n"
+             "\"Genesis\", 4, 3, \"And in process of time.\"\n");
+    CHECK(!importBibleFromCSV(dbPath, csvPath));
+    CHECK_EQUAL(queryInt(dbPath, "SELECT COUNT(*) FROM bible"), 5);
+    CHECK_EQUAL(queryInt(dbPath, "SELECT COUNT(*) FROM chapter_hashes"), 2);
+    CHECK(execute(dbPath, "DROP TRIGGER refuse_verses"));
+
+    CHECK(importBibleFromCSV(dbPath, csvPath));
+    CHECK_EQUAL(queryInt(dbPath, "SELECT COUNT(*) FROM bible"), 9);
+
+    std::filesystem::remove_all(directory);
+    return checkFailures;
+}
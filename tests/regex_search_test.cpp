@@ -0,0 +1,91 @@
+#include "../include/regex_search.h"
+#include "test_check.h"
+#include <string>
+#include <vector>
+
+// The prefilter literal must occur in every text the pattern matches
+static void checkLiteral(const std::string &pattern, const std::string &matching, const std::string &expectedLiteral)
+{
+    std::string literal = RegexSearch::extractRequiredLiteral(pattern);
+    CHECK_EQUAL(literal, expectedLiteral);
+    CHECK(matching.find(literal) != std::string::npos);
+}
+
+// ...so a search using it finds the text the regex engine alone matches
+static void checkPattern(const std::string &pattern, const std::string &matching, const std::string &expectedLiteral)
+{
+    checkLiteral(pattern, matching, expectedLiteral);
+
+    std::vector<Verse> corpus(2);
+    corpus[0].folded = "nothing to see here";
+    corpus[1].folded = matching;
+
+    RegexSearch search;
+    std::string error;
+    FoldOptions options;
+    CHECK(search.compile(pattern, options, error));
+    CHECK(search.search(corpus) == std::vector<size_t>{1});
+}
+
+// Patterns are folded like the text they search: the first text matches, the second does not
+static void checkFolding(const std::string &pattern, const std::string &matching, const std::string &missing)
+{
+    std::vector<Verse> corpus(2);
+    corpus[0].folded = missing;
+    corpus[1].folded = matching;
+
+    RegexSearch search;
+    std::string error;
+    FoldOptions options;
+    CHECK(search.compile(pattern, options, error));
+    CHECK(search.search(corpus) == std::vector<size_t>{1});
+}
+
+int main()
+{
+    // Escapes whose tail is not literal text
+    checkPattern("\\x6Cove", "god is love", "ove");
+    checkPattern("\\u006Cove", "god is love", "ove");
+    checkLiteral("line\\cJbreak", "line\nbreak", "break"); // libstdc++ does not match \cX itself
+    checkPattern("(th)e \\1ings", "the things", "ings");
+    checkPattern("lo\\x76e", "love", "lo");
+
+    // One-character escapes: classes and anchors end a run, punctuation extends it
+    checkPattern("\\bgrace\\b", "by grace are ye", "grace");
+    checkPattern("chapter \\d+", "chapter 12", "chapter ");
+    checkPattern("amen\\.", "amen.", "amen.");
+
+    // Escapes inside a character class are skipped with the class
+    checkPattern("[\\x41-\\x5A\\]]*word", "the word", "word");
+
+    // A quantifier repeats the whole expansion of a character, not its last byte
+    CHECK_EQUAL(foldPattern("Gruß?e", FoldOptions()), std::string("gru(?:ss)?e"));
+    checkFolding("^gruß?e$", "grue", "grusse s");
+    checkFolding("^gruß?e$", "grusse", "gruse");
+    checkFolding("^ﬁ+$", "fifi", "fii");
+
+    // Class members are folded one by one: [À-Ö] is not [a-o]
+    CHECK_EQUAL(foldPattern("[À-Ö]", FoldOptions()), std::string("(?:[ac-eino]|ae)"));
+    checkFolding("^[À-Ö]ve$", "ave", "bve");
+    checkFolding("^[À-Ö]ve$", "aeve", "mve");
+    checkFolding("^[^À-Ö]ve$", "bve", "ove");
+    checkFolding("^[A-Z]+$", "word", "WORD");
+
+    // Characters written as escapes are folded like the ones written out
+    checkFolding("\\x41men", "amen", "bmen");
+    checkFolding("\\u00C9glise", "eglise", "\xc3\x89glise");
+    checkFolding("[\\u00C0-\\u00C5]men", "amen", "omen");
+    CHECK_EQUAL(foldPattern("\\x2E\\x6C", FoldOptions()), std::string("\\x2E\\x6C"));
+
+    // Highlight spans are the matches themselves, not the prefilter literal
+    RegexSearch search;
+    std::string error;
+    FoldOptions options;
+    CHECK(search.compile("l[oi]ves?", options, error));
+    std::vector<HitSpan> spans;
+    search.matchSpans("he loves to live", spans);
+    CHECK_EQUAL(spans.size(), size_t(2));
+    CHECK(spans.size() == 2 && spans[0].begin == 3 && spans[0].end == 8 && spans[1].begin == 12 && spans[1].end == 16);
+
+    return checkFailures;
+}
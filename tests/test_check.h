@@ -0,0 +1,32 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Minimal checks for the test executables: a failed check is reported with
+// its location and counted, and main returns the count
+static int checkFailures = 0;
+
+static void reportFailure(const char *file, int line, const std::string &message)
+{
+    std::cerr << file << ":" << line << ": " << message << std::endl;
+    checkFailures++;
+}
+
+template <typename Actual, typename Expected>
+static void checkEqual(const Actual &actual, const Expected &expected, const char *text, const char *file, int line)
+{
+    if (!(actual == expected))
+    {
+        std::ostringstream message;
+        message << text << " is " << actual << ", expected " << expected;
+        reportFailure(file, line, message.str());
+    }
+}
+
+#define CHECK(condition) ((condition) ? (void)0 : reportFailure(__FILE__, __LINE__, "check failed: " #condition))
+#define CHECK_EQUAL(actual, expected) checkEqual((actual), (expected), #actual, __FILE__, __LINE__)
+
+#endif
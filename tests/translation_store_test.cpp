@@ -0,0 +1,61 @@
+#include "../include/translation_store.h"
+#include "../include/schema.h"
+#include "test_check.h"
+#include <sqlite3.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<int, std::string>> Rows;
+
+// Prepare a re-import of the translation and write it, as a bulk import does
+static bool reimport(sqlite3 *db, const Rows &rows, CompactedTranslation &compacted)
+{
+    return prepareCompaction(db, "web", rows, compacted) && writeCompaction(db, compacted);
+}
+
+int main()
+{
+    sqlite3 *db;
+    sqlite3_open(":memory:", &db);
+    CHECK(ensureSchema(db));
+
+    // Four chapters: Genesis 1 is ids 1-3, the others one or two verses each
+    sqlite3_exec(db,
+                 "INSERT INTO bible (id, book, chapter, verse, text) VALUES "
+                 "(1, 'Genesis', 1, 1, 'a'), (2, 'Genesis', 1, 2, 'b'), (3, 'Genesis', 1, 3, 'c'),"
+                 "(4, 'Genesis', 2, 1, 'd'), (5, 'Genesis', 2, 2, 'e'), (6, 'Genesis', 3, 1, 'f'),"
+                 "(7, 'Genesis', 4, 1, 'g');"
+                 "INSERT INTO translations (code, name) VALUES ('web', 'web');",
+                 nullptr, nullptr, nullptr);
+
+    Rows rows;
+    for (int id = 1; id <= 7; id++)
+        rows.push_back({id, "verse " + std::to_string(id) + " of the world english bible"});
+
+    CompactedTranslation first;
+    CHECK(reimport(db, rows, first));
+    CHECK_EQUAL(first.changedChapters, size_t(4));
+
+    CompactedTranslation same;
+    CHECK(reimport(db, rows, same));
+    CHECK_EQUAL(same.changedChapters, size_t(0));
+
+    // Genesis 1:3 is gone from the new import: its chapter changed and the verse is dropped
+    Rows withoutVerse = rows;
+    withoutVerse.erase(withoutVerse.begin() + 2);
+    CompactedTranslation removed;
+    CHECK(reimport(db, withoutVerse, removed));
+    CHECK_EQUAL(removed.changedChapters, size_t(1));
+    CHECK_EQUAL(removed.changedVerses, size_t(1));
+
+    TranslationStore store;
+    CHECK(store.open(db));
+    CHECK_EQUAL(store.count(), size_t(2));
+    CHECK_EQUAL(store.text(1, 3), std::string());
+    CHECK_EQUAL(store.text(1, 2), rows[1].second);
+    CHECK_EQUAL(store.text(1, 7), rows[6].second);
+
+    sqlite3_close(db);
+    return checkFailures;
+}
@@ -0,0 +1,51 @@
+#include "../include/import_commands.h"
+#include "../include/viewer.h"
+#include "../bench/navigation_walk.h"
+#include "test_check.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Steady-state navigation must not touch the heap: replay the bench's walk
+// on a small database and count the allocations of its second pass
+int main()
+{
+    char directory[] = "/tmp/viewer_alloc_XXXXXX";
+    if (!mkdtemp(directory))
+        return 1;
+    std::string dbPath = std::string(directory) + "/bible.db";
+    std::string csvPath = std::string(directory) + "/bible.csv";
+
+    // Three books of short chapters, so the walk crosses chapters and books
+    {
+        std::ofstream csv(csvPath);
+        csv << "\"book\", \"chapter\", \"verse\", \"text\"\n";
+        for (const char *book : {"Genesis", "Exodus", "Leviticus"})
+            for (int chapter = 1; chapter <= 6; chapter++)
+                for (int verse = 1; verse <= 9; verse++)
+                    csv << "\"" << book << "\", " << chapter << ", " << verse << ", \"And the Lord spake unto Moses, saying "
+                        << verse << " of " << chapter << ".\"\n";
+    }
+
+    // Curses draws into /dev/null at a fixed size
+    setenv("TERM", "xterm", 1);
+    setenv("LINES", "40", 1);
+    setenv("COLUMNS", "120", 1);
+    FILE *screen = freopen("/dev/null", "w", stdout);
+
+    CHECK(screen != nullptr);
+    CHECK(createDatabase(dbPath, FoldOptions(), "archaic-english"));
+    CHECK(importBibleFromCSV(dbPath, csvPath));
+
+    NavigationWalk walk;
+    ViewerOptions options;
+    CHECK(walk.prepare(dbPath, options));
+    CHECK(runViewer(dbPath, options));
+    CHECK_EQUAL(walk.passKeys(), size_t(136));
+    CHECK_EQUAL(walk.countedAllocations(), size_t(0));
+
+    std::filesystem::remove_all(directory);
+    return checkFailures;
+}